@@ -0,0 +1,87 @@
+#include "AllocationTracking.h"
+
+#ifdef ORDERBOOK_ALLOCATION_TRACKING
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace
+{
+    // 都是平凡类型，线程局部变量不需要动态初始化，在分配器内部访问是安全的
+    thread_local AllocationCounts counts;
+    thread_local std::uint32_t forbidden{ };
+}
+
+AllocationCounts GetThreadAllocationCounts()
+{
+    return counts;
+}
+
+NoAllocationScope::NoAllocationScope()
+{
+    ++forbidden;
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+    --forbidden;
+}
+
+#ifdef ORDERBOOK_ALLOCATION_TRACKING
+namespace
+{
+    void* Allocate(std::size_t size, std::size_t alignment, bool nothrow)
+    {
+        if (forbidden > 0)
+        {
+            // 不能再分配内存，直接用 C 的标准错误输出
+            std::fprintf(stderr, "Unexpected allocation of %zu bytes inside NoAllocationScope.\n", size);
+            std::abort();
+        }
+
+        ++counts.allocations_;
+        counts.bytes_ += size;
+
+        if (size == 0)
+            size = 1;
+        void* memory = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+            ? std::malloc(size)
+            : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (memory == nullptr && !nothrow)
+            throw std::bad_alloc{ };
+        return memory;
+    }
+
+    void Deallocate(void* memory)
+    {
+        if (memory == nullptr)
+            return;
+        ++counts.deallocations_;
+        std::free(memory);
+    }
+}
+
+// 替换全部可替换的全局分配函数，aligned_alloc 分配的内存同样用 free 释放
+void* operator new(std::size_t size) { return Allocate(size, 0, false); }
+void* operator new[](std::size_t size) { return Allocate(size, 0, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0, true); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment), false); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment), false); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<std::size_t>(alignment), true); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<std::size_t>(alignment), true); }
+
+void operator delete(void* memory) noexcept { Deallocate(memory); }
+void operator delete[](void* memory) noexcept { Deallocate(memory); }
+void operator delete(void* memory, std::size_t) noexcept { Deallocate(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { Deallocate(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { Deallocate(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { Deallocate(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { Deallocate(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { Deallocate(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { Deallocate(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { Deallocate(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { Deallocate(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { Deallocate(memory); }
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// 分配计数：以 ORDERBOOK_ALLOCATION_TRACKING 编译时替换全局 operator new / delete，按线程统计分配次数和字节数
+//
+// 计数保存在线程局部变量中，更新不需要原子操作；每个线程只能读取自己的计数。
+// 未编译时不替换分配器，所有计数都为 0。
+#ifdef ORDERBOOK_ALLOCATION_TRACKING
+constexpr bool AllocationTrackingEnabled = true;
+#else
+constexpr bool AllocationTrackingEnabled = false;
+#endif
+
+struct AllocationCounts
+{
+    std::uint64_t allocations_{ };     // operator new 的调用次数
+    std::uint64_t deallocations_{ };   // operator delete 的调用次数（不含空指针）
+    std::uint64_t bytes_{ };           // 申请的总字节数
+
+    AllocationCounts operator-(const AllocationCounts& other) const
+    {
+        return { allocations_ - other.allocations_, deallocations_ - other.deallocations_, bytes_ - other.bytes_ };
+    }
+};
+
+// 当前线程自启动以来的累计计数
+AllocationCounts GetThreadAllocationCounts();
+
+// 禁止分配的作用域：存在期间当前线程的任何 operator new 都会把申请的字节数写到标准错误并调用 std::abort，
+// 便于在调试器中定位稳定状态下仍然分配的位置。可以嵌套；未编译分配计数时不起作用。
+class NoAllocationScope
+{
+public:
+    NoAllocationScope();
+    NoAllocationScope(const NoAllocationScope&) = delete;
+    void operator=(const NoAllocationScope&) = delete;
+    ~NoAllocationScope();
+};
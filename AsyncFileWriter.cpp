@@ -0,0 +1,466 @@
+#include "AsyncFileWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// 直接基于系统调用的最小 io_uring 封装，只提供本写入器需要的功能
+class AsyncFileWriter::IoUring
+{
+public:
+    explicit IoUring(unsigned entries)
+    {
+        io_uring_params params{ };
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0)
+            throw std::runtime_error("io_uring_setup failed.");
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap)
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        cqRing_ = singleMap ? sqRing_
+            : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED)
+        {
+            Unmap();
+            throw std::runtime_error("io_uring mmap failed.");
+        }
+
+        auto* sq = static_cast<char*>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+
+        auto* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~IoUring()
+    {
+        Unmap();
+    }
+
+    // 注册固定缓冲区，供 WRITE_FIXED 使用
+    void RegisterBuffers(const std::vector<iovec>& buffers)
+    {
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size())) < 0)
+            throw std::runtime_error("io_uring buffer registration failed.");
+    }
+
+    // 取得下一个提交项，提交队列已满时返回空指针
+    io_uring_sqe* NextSqe()
+    {
+        const auto head = std::atomic_ref<unsigned>{ *sqHead_ }.load(std::memory_order_acquire);
+        if (localTail_ - head >= sqEntries_)
+            return nullptr;
+
+        const auto index = localTail_ & sqMask_;
+        auto* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        ++localTail_;
+        ++pending_;
+        return sqe;
+    }
+
+    // 提交已准备好的提交项，并可选地等待至少 waitFor 个完成事件
+    void Submit(unsigned waitFor)
+    {
+        std::atomic_ref<unsigned>{ *sqTail_ }.store(localTail_, std::memory_order_release);
+
+        while (pending_ > 0 || waitFor > 0)
+        {
+            const auto result = syscall(__NR_io_uring_enter, fd_, pending_, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("io_uring_enter failed.");
+            }
+            pending_ -= static_cast<unsigned>(result);
+            waitFor = 0;
+        }
+    }
+
+    // 处理所有已完成的事件
+    template<typename Handler>
+    std::size_t Reap(Handler&& handler)
+    {
+        std::atomic_ref<unsigned> head{ *cqHead_ };
+        const auto tail = std::atomic_ref<unsigned>{ *cqTail_ }.load(std::memory_order_acquire);
+        auto current = head.load(std::memory_order_relaxed);
+
+        std::size_t reaped{ };
+        for (; current != tail; ++current, ++reaped)
+        {
+            const auto& cqe = cqes_[current & cqMask_];
+            handler(cqe.user_data, cqe.res);
+        }
+
+        head.store(current, std::memory_order_release);
+        return reaped;
+    }
+
+private:
+    void Unmap()
+    {
+        if (sqes_ != nullptr && sqes_ != MAP_FAILED)
+            munmap(sqes_, sqesSize_);
+        if (cqRing_ != nullptr && cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+            munmap(cqRing_, cqRingSize_);
+        if (sqRing_ != nullptr && sqRing_ != MAP_FAILED)
+            munmap(sqRing_, sqRingSize_);
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    int fd_{ -1 };
+    void* sqRing_{ };
+    void* cqRing_{ };
+    io_uring_sqe* sqes_{ };
+    std::size_t sqRingSize_{ };
+    std::size_t cqRingSize_{ };
+    std::size_t sqesSize_{ };
+
+    unsigned* sqHead_{ };
+    unsigned* sqTail_{ };
+    unsigned* sqArray_{ };
+    unsigned sqMask_{ };
+    unsigned sqEntries_{ };
+    unsigned localTail_{ };
+    unsigned pending_{ };
+
+    unsigned* cqHead_{ };
+    unsigned* cqTail_{ };
+    unsigned cqMask_{ };
+    io_uring_cqe* cqes_{ };
+};
+#else
+class AsyncFileWriter::IoUring { };
+#endif
+
+namespace
+{
+    // io_uring user_data 中用于区分写入完成和 fsync 完成的标志位
+    constexpr std::uint64_t WriteCompletion = 1ull << 63;
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::filesystem::path& path, AsyncFileWriterOptions options, std::uint64_t offset)
+    : options_{ options }
+    , submitted_{ options.bufferCount_ }
+    , free_{ options.bufferCount_ }
+    , nextOffset_{ offset }
+{
+    if (options_.bufferSize_ == 0 || options_.bufferCount_ == 0)
+        throw std::logic_error("AsyncFileWriter needs at least one non-empty buffer.");
+
+#ifndef _WIN32
+    // 不使用 O_TRUNC：续写时保留 offset 之前的内容
+    descriptor_ = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (descriptor_ < 0)
+        throw std::runtime_error("Unable to open file for asynchronous writing.");
+    if (ftruncate(descriptor_, static_cast<off_t>(offset)) != 0)
+    {
+        close(descriptor_);
+        throw std::runtime_error("Unable to truncate file for asynchronous writing.");
+    }
+#else
+    file_ = _wfopen(path.c_str(), offset == 0 ? L"wb" : L"r+b");
+    if (file_ == nullptr)
+        throw std::runtime_error("Unable to open file for asynchronous writing.");
+    if (offset != 0 && (_chsize_s(_fileno(file_), static_cast<long long>(offset)) != 0 || _fseeki64(file_, static_cast<long long>(offset), SEEK_SET) != 0))
+    {
+        std::fclose(file_);
+        throw std::runtime_error("Unable to truncate file for asynchronous writing.");
+    }
+#endif
+
+    // 所有缓冲区来自一块连续内存，并全部放入空闲队列
+    memory_ = std::make_unique<char[]>(options_.bufferSize_ * options_.bufferCount_);
+    buffers_.resize(options_.bufferCount_);
+    for (std::size_t i = 0; i < buffers_.size(); ++i)
+    {
+        buffers_[i].data_ = memory_.get() + i * options_.bufferSize_;
+        free_.TryPush(i);
+    }
+
+#ifdef __linux__
+    // 优先使用 io_uring，不可用时（如内核禁用）退化为顺序写入
+    try
+    {
+        ring_ = std::make_unique<IoUring>(static_cast<unsigned>(2 * options_.bufferCount_));
+
+        std::vector<iovec> iovecs;
+        for (const auto& buffer : buffers_)
+            iovecs.push_back(iovec{ buffer.data_, options_.bufferSize_ });
+        ring_->RegisterBuffers(iovecs);
+    }
+    catch (const std::runtime_error&)
+    {
+        ring_.reset();
+    }
+#endif
+
+    ioThread_ = std::thread{ [this] { RunIoThread(); } };
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    try
+    {
+        Sync();
+    }
+    catch (const std::exception&)
+    {
+        // 析构时无法再报告写入错误
+    }
+
+    stop_.store(true, std::memory_order_release);
+    handedOff_.fetch_add(1, std::memory_order_release);
+    handedOff_.notify_one();
+    ioThread_.join();
+
+#ifndef _WIN32
+    close(descriptor_);
+#else
+    std::fclose(file_);
+#endif
+}
+
+void AsyncFileWriter::Write(const char* data, std::size_t size)
+{
+    if (size > options_.bufferSize_)
+        throw std::logic_error("Write is larger than the AsyncFileWriter buffer size.");
+    if (failed_.load(std::memory_order_relaxed))
+        throw std::runtime_error("AsyncFileWriter failed to write to disk.");
+
+    // 当前缓冲区放不下时先交出，保证单次写入不会跨越两个缓冲区
+    if (hasCurrent_ && buffers_[current_].size_ + size > options_.bufferSize_)
+        Flush();
+    if (!hasCurrent_)
+        AcquireBuffer();
+
+    auto& buffer = buffers_[current_];
+    std::memcpy(buffer.data_ + buffer.size_, data, size);
+    buffer.size_ += size;
+}
+
+void AsyncFileWriter::Flush()
+{
+    if (!hasCurrent_ || buffers_[current_].size_ == 0)
+        return;
+
+    auto& buffer = buffers_[current_];
+    buffer.offset_ = nextOffset_;
+    nextOffset_ += buffer.size_;
+
+    // 队列容量不小于缓冲区数量，因此一定能放下
+    submitted_.TryPush(current_);
+    hasCurrent_ = false;
+
+    handedOff_.fetch_add(1, std::memory_order_release);
+    handedOff_.notify_one();
+}
+
+void AsyncFileWriter::Sync()
+{
+    Flush();
+
+    const auto target = handedOff_.load(std::memory_order_acquire);
+    while (true)
+    {
+        const auto completed = completed_.load(std::memory_order_acquire);
+        if (completed >= target)
+            break;
+        completed_.wait(completed, std::memory_order_acquire);
+    }
+
+    if (failed_.load(std::memory_order_relaxed))
+        throw std::runtime_error("AsyncFileWriter failed to write to disk.");
+}
+
+void AsyncFileWriter::AcquireBuffer()
+{
+    // 所有缓冲区都在途时只能等待 I/O 线程归还
+    std::size_t index;
+    if (!free_.TryPop(index))
+    {
+        ++stalls_;
+        do
+            std::this_thread::yield();
+        while (!free_.TryPop(index));
+    }
+
+    current_ = index;
+    buffers_[current_].size_ = 0;
+    hasCurrent_ = true;
+}
+
+void AsyncFileWriter::ReleaseBuffer(std::size_t index)
+{
+    free_.TryPush(index);
+    completed_.fetch_add(1, std::memory_order_release);
+    completed_.notify_all();
+}
+
+void AsyncFileWriter::RunIoThread()
+{
+    if (ring_)
+        RunIoUring();
+    else
+        RunSequential();
+}
+
+void AsyncFileWriter::RunIoUring()
+{
+#ifdef __linux__
+    std::size_t inFlight{ };
+
+    while (true)
+    {
+        const auto seen = handedOff_.load(std::memory_order_acquire);
+
+        // 提交新交来的缓冲区，最多保持 bufferCount_ 个写入在途
+        std::size_t index;
+        std::size_t prepared{ };
+        while (inFlight < options_.bufferCount_ && submitted_.TryPop(index))
+        {
+            const auto& buffer = buffers_[index];
+
+            auto* write = ring_->NextSqe();
+            write->opcode = IORING_OP_WRITE_FIXED;
+            write->fd = descriptor_;
+            write->addr = reinterpret_cast<std::uint64_t>(buffer.data_);
+            write->len = static_cast<std::uint32_t>(buffer.size_);
+            write->off = buffer.offset_;
+            write->buf_index = static_cast<std::uint16_t>(index);
+            write->user_data = WriteCompletion | index;
+
+            // 需要落盘时在写入后链接一个 fdatasync，缓冲区在 fsync 完成后才归还
+            if (options_.syncEachWrite_)
+            {
+                write->flags = IOSQE_IO_LINK;
+                auto* fsync = ring_->NextSqe();
+                fsync->opcode = IORING_OP_FSYNC;
+                fsync->fd = descriptor_;
+                fsync->fsync_flags = IORING_FSYNC_DATASYNC;
+                fsync->user_data = index;
+            }
+
+            ++inFlight;
+            ++prepared;
+        }
+
+        // 没有新提交但仍有写入在途时，等待至少一个完成事件
+        ring_->Submit(prepared == 0 && inFlight > 0 ? 1 : 0);
+
+        ring_->Reap([this, &inFlight](std::uint64_t userData, std::int32_t result)
+        {
+            const auto index = static_cast<std::size_t>(userData & ~WriteCompletion);
+            const bool isWrite = (userData & WriteCompletion) != 0;
+            // 短写补写完成后被取消的链接 fsync
+            const bool cancelledAfterCompletion = !isWrite && result == -ECANCELED && buffers_[index].completed_;
+
+            if (isWrite && result >= 0 && static_cast<std::size_t>(result) < buffers_[index].size_)
+            {
+                // 短写：剩余部分在 I/O 线程中同步补写，需要落盘时 WriteSequential 随后同步 fdatasync。
+                // 短写会中断链接，链接的 fsync 以 -ECANCELED 完成，此时不算失败
+                auto remainder = buffers_[index];
+                remainder.data_ += result;
+                remainder.size_ -= static_cast<std::size_t>(result);
+                remainder.offset_ += static_cast<std::uint64_t>(result);
+                WriteSequential(remainder);
+                buffers_[index].completed_ = options_.syncEachWrite_;
+            }
+            else if (result < 0 && !cancelledAfterCompletion)
+                failed_.store(true, std::memory_order_relaxed);
+
+            // 写入（不需要落盘时）或链接的 fsync 完成后归还缓冲区
+            if (isWrite == !options_.syncEachWrite_)
+            {
+                buffers_[index].completed_ = false;
+                --inFlight;
+                ReleaseBuffer(index);
+            }
+        });
+
+        if (inFlight == 0 && submitted_.Size() == 0)
+        {
+            if (stop_.load(std::memory_order_acquire))
+                return;
+            handedOff_.wait(seen, std::memory_order_acquire);
+        }
+    }
+#endif
+}
+
+void AsyncFileWriter::RunSequential()
+{
+    while (true)
+    {
+        const auto seen = handedOff_.load(std::memory_order_acquire);
+
+        std::size_t index;
+        if (submitted_.TryPop(index))
+        {
+            WriteSequential(buffers_[index]);
+            ReleaseBuffer(index);
+            continue;
+        }
+
+        if (stop_.load(std::memory_order_acquire))
+            return;
+        handedOff_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void AsyncFileWriter::WriteSequential(const Buffer& buffer)
+{
+#ifndef _WIN32
+    std::size_t written{ };
+    while (written < buffer.size_)
+    {
+        const auto result = pwrite(descriptor_, buffer.data_ + written, buffer.size_ - written, static_cast<off_t>(buffer.offset_ + written));
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            failed_.store(true, std::memory_order_relaxed);
+            return;
+        }
+        written += static_cast<std::size_t>(result);
+    }
+
+    if (options_.syncEachWrite_ && fdatasync(descriptor_) < 0)
+        failed_.store(true, std::memory_order_relaxed);
+#else
+    // 缓冲区按交出顺序依次写入，因此顺序追加即可
+    if (std::fwrite(buffer.data_, 1, buffer.size_, file_) != buffer.size_ || std::fflush(file_) != 0)
+        failed_.store(true, std::memory_order_relaxed);
+#endif
+}
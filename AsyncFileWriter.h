@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "SpscQueue.h"   // 包含缓冲区交接使用的无锁队列
+
+// 异步文件写入器的配置
+struct AsyncFileWriterOptions
+{
+    std::size_t bufferSize_{ 1 << 20 };   // 单个缓冲区的大小
+    std::size_t bufferCount_{ 8 };        // 缓冲区数量，也是同时在途的写入数上限
+    bool syncEachWrite_{ false };         // 每次写入后追加一次（与写入链接的）fdatasync
+};
+
+// 异步追加写文件
+//
+// 调用线程（撮合线程）只把数据拷贝进预分配的缓冲区，缓冲区写满或 Flush 时通过无锁队列交给 I/O 线程；
+// I/O 线程负责真正的写入和落盘，写完后把缓冲区还回空闲队列。调用线程从不执行写入或 fsync。
+//
+// 在 Linux 上 I/O 线程使用 io_uring：缓冲区预先注册（WRITE_FIXED），需要落盘时 fsync 与写入链接提交，
+// 最多保持 bufferCount_ 个写入同时在途。内核不支持 io_uring 或在其他平台上时退化为顺序写入。
+//
+// 单次 Write 的数据不会被拆分到两个缓冲区中，因此即使写入乱序完成，文件中也只会在 Write 边界处出现空洞。
+class AsyncFileWriter
+{
+public:
+    // 从文件的 offset 处开始写：offset 之前的内容保留，之后的内容被截掉；默认 0，即清空文件
+    explicit AsyncFileWriter(const std::filesystem::path& path, AsyncFileWriterOptions options = { }, std::uint64_t offset = 0);
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    void operator=(const AsyncFileWriter&) = delete;
+    // 析构时写出所有数据并等待完成
+    ~AsyncFileWriter();
+
+    // 追加数据，size 不能超过单个缓冲区的大小
+    void Write(const char* data, std::size_t size);
+    // 把当前缓冲区中的数据交给 I/O 线程，不等待写入完成
+    void Flush();
+    // 交出当前缓冲区并等待所有数据写入完成（会阻塞，用于关闭和测试）
+    void Sync();
+
+    // 是否使用 io_uring 后端
+    bool UsesIoUring() const { return ring_ != nullptr; }
+    // 由于所有缓冲区都在途而不得不等待的次数，非零说明 I/O 跟不上写入速度
+    std::uint64_t GetStalls() const { return stalls_; }
+
+private:
+    struct Buffer
+    {
+        char* data_{ };              // 缓冲区起始地址
+        std::size_t size_{ };        // 已写入的字节数
+        std::uint64_t offset_{ };    // 在文件中的偏移
+        bool completed_{ };          // io_uring 短写的剩余部分已同步补写并落盘，链接的 fsync 会被取消（仅 I/O 线程使用）
+    };
+
+    class IoUring;
+
+    void AcquireBuffer();
+    void RunIoThread();
+    void RunIoUring();
+    void RunSequential();
+    void WriteSequential(const Buffer& buffer);
+    void ReleaseBuffer(std::size_t index);
+
+    AsyncFileWriterOptions options_;
+    int descriptor_{ -1 };                      // POSIX 文件描述符
+    std::FILE* file_{ };                        // 其他平台使用的文件句柄
+    std::unique_ptr<char[]> memory_;            // 所有缓冲区的连续内存
+    std::vector<Buffer> buffers_;               // 缓冲区描述
+    std::unique_ptr<IoUring> ring_;             // io_uring 实例（不可用时为空）
+
+    SpscQueue<std::size_t> submitted_;          // 撮合线程 -> I/O 线程：待写入的缓冲区
+    SpscQueue<std::size_t> free_;               // I/O 线程 -> 撮合线程：空闲的缓冲区
+    std::atomic<std::uint64_t> handedOff_{ };   // 已交给 I/O 线程的缓冲区数量，用于唤醒 I/O 线程
+    std::atomic<std::uint64_t> completed_{ };   // 已写入完成的缓冲区数量，用于 Sync 等待
+    std::atomic<bool> stop_{ false };           // 通知 I/O 线程退出
+    std::atomic<bool> failed_{ false };         // I/O 线程遇到写入错误
+
+    std::size_t current_{ };                    // 撮合线程正在填充的缓冲区
+    bool hasCurrent_{ false };                  // 是否持有正在填充的缓冲区
+    std::uint64_t nextOffset_{ };               // 下一个缓冲区的文件偏移
+    std::uint64_t stalls_{ };                   // 等待空闲缓冲区的次数
+
+    std::thread ioThread_;                      // I/O 线程，必须最后构造
+};
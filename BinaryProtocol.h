@@ -0,0 +1,332 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "Orderbook.h"   // 包含 Orderbook 类的定义，解码后直接分发到订单簿
+
+// 二进制订单录入协议
+//
+// 所有消息都是定长、紧凑排列（无填充）的小端结构体，以 MessageHeader 开头。
+// 解码时直接把接收缓冲区中的字节解释为消息结构体，不做拷贝、不构造中间对象。
+static_assert(std::endian::native == std::endian::little, "The binary protocol is little-endian.");
+
+// 消息类型
+enum class MessageType : std::uint8_t
+{
+    AddOrder = 'A',      // 添加限价订单
+    CancelOrder = 'C',   // 取消订单
+    ModifyOrder = 'M',   // 修改订单
+    MarketOrder = 'R',   // 添加市价订单
+    ExecutionReport = 'E', // 执行回报（服务端 -> 客户端）
+};
+
+// 执行回报的类型
+enum class ExecutionType : std::uint8_t
+{
+    Accepted = 'A',      // 添加或修改已被接受
+    Rejected = 'J',      // 请求被拒绝（订单 ID 重复或不属于本会话）
+    Filled = 'F',        // 成交（部分或全部）
+    Cancelled = 'C',     // 已取消（包括 FillAndKill / FillOrKill 未成交的部分）
+};
+
+#pragma pack(push, 1)
+
+// 消息头：length_ 为包括消息头在内的整个消息长度
+struct MessageHeader
+{
+    std::uint16_t length_;
+    MessageType type_;
+};
+
+struct AddOrderMessage
+{
+    MessageHeader header_;
+    OrderId orderId_;
+    std::uint8_t side_;         // Side 的取值
+    std::uint8_t orderType_;    // OrderType 的取值
+    Price price_;
+    Quantity quantity_;
+};
+
+struct CancelOrderMessage
+{
+    MessageHeader header_;
+    OrderId orderId_;
+};
+
+struct ModifyOrderMessage
+{
+    MessageHeader header_;
+    OrderId orderId_;
+    std::uint8_t side_;
+    Price price_;
+    Quantity quantity_;
+};
+
+struct MarketOrderMessage
+{
+    MessageHeader header_;
+    OrderId orderId_;
+    std::uint8_t side_;
+    Quantity quantity_;
+};
+
+// 执行回报：price_ / quantity_ 为本次成交（或被接受）的价格和数量，leavesQuantity_ 为订单剩余数量
+struct ExecutionReportMessage
+{
+    MessageHeader header_;
+    OrderId orderId_;
+    ExecutionType executionType_;
+    Price price_;
+    Quantity quantity_;
+    Quantity leavesQuantity_;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(AddOrderMessage) == 21);
+static_assert(sizeof(CancelOrderMessage) == 11);
+static_assert(sizeof(ModifyOrderMessage) == 20);
+static_assert(sizeof(MarketOrderMessage) == 16);
+static_assert(sizeof(ExecutionReportMessage) == 24);
+
+// 将消息编码到 out 中，返回消息长度（用于客户端和测试）
+inline std::size_t EncodeAddOrder(char* out, OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity)
+{
+    const AddOrderMessage message{ { sizeof(AddOrderMessage), MessageType::AddOrder }, orderId,
+        static_cast<std::uint8_t>(side), static_cast<std::uint8_t>(orderType), price, quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeCancelOrder(char* out, OrderId orderId)
+{
+    const CancelOrderMessage message{ { sizeof(CancelOrderMessage), MessageType::CancelOrder }, orderId };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeModifyOrder(char* out, OrderId orderId, Side side, Price price, Quantity quantity)
+{
+    const ModifyOrderMessage message{ { sizeof(ModifyOrderMessage), MessageType::ModifyOrder }, orderId, static_cast<std::uint8_t>(side), price, quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeMarketOrder(char* out, OrderId orderId, Side side, Quantity quantity)
+{
+    const MarketOrderMessage message{ { sizeof(MarketOrderMessage), MessageType::MarketOrder }, orderId, static_cast<std::uint8_t>(side), quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeExecutionReport(char* out, OrderId orderId, ExecutionType executionType, Price price, Quantity quantity, Quantity leavesQuantity)
+{
+    const ExecutionReportMessage message{ { sizeof(ExecutionReportMessage), MessageType::ExecutionReport }, orderId, executionType, price, quantity, leavesQuantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+// 校验并转换线上的枚举字段
+inline Side ToSide(std::uint8_t value)
+{
+    if (value > static_cast<std::uint8_t>(Side::Sell))
+        throw std::runtime_error("Binary message has an invalid side.");
+    return static_cast<Side>(value);
+}
+
+inline OrderType ToOrderType(std::uint8_t value)
+{
+    if (value > static_cast<std::uint8_t>(OrderType::Market))
+        throw std::runtime_error("Binary message has an invalid order type.");
+    return static_cast<OrderType>(value);
+}
+
+// 检查消息长度是否与消息类型一致
+template<typename Message>
+const Message& CastMessage(const MessageHeader& header)
+{
+    if (header.length_ != sizeof(Message))
+        throw std::runtime_error("Binary message has an invalid length.");
+    return reinterpret_cast<const Message&>(header);
+}
+
+// 订单录入消息类型对应的消息长度，未知类型（包括执行回报）返回 0
+constexpr std::size_t GetOrderEntryMessageSize(MessageType type)
+{
+    switch (type)
+    {
+        case MessageType::AddOrder: return sizeof(AddOrderMessage);
+        case MessageType::CancelOrder: return sizeof(CancelOrderMessage);
+        case MessageType::ModifyOrder: return sizeof(ModifyOrderMessage);
+        case MessageType::MarketOrder: return sizeof(MarketOrderMessage);
+        default: return 0;
+    }
+}
+
+// 检查订单录入消息的长度和枚举字段，合法时返回空指针，否则返回错误说明
+template<typename Message>
+const char* ValidateMessage(const MessageHeader& header)
+{
+    if (header.length_ != sizeof(Message))
+        return "Binary message has an invalid length.";
+
+    const auto& message = reinterpret_cast<const Message&>(header);
+    if (message.side_ > static_cast<std::uint8_t>(Side::Sell))
+        return "Binary message has an invalid side.";
+    if constexpr (requires(const Message& value) { value.orderType_; })
+    {
+        if (message.orderType_ > static_cast<std::uint8_t>(OrderType::Market))
+            return "Binary message has an invalid order type.";
+    }
+    return nullptr;
+}
+
+template<>
+inline const char* ValidateMessage<CancelOrderMessage>(const MessageHeader& header)
+{
+    return header.length_ == sizeof(CancelOrderMessage) ? nullptr : "Binary message has an invalid length.";
+}
+
+// 解码的结果：consumed_ 为已交给 handler 的完整消息的字节数；error_ 非空时表示在 consumed_ 处遇到了协议错误，
+// 此前的消息已经分发，调用方可以据此断开连接或跳过
+struct BinaryDecodeResult
+{
+    std::size_t consumed_{ };
+    const char* error_{ nullptr };   // 错误说明，没有错误时为空
+};
+
+// 解码缓冲区中所有完整的消息并交给 handler（末尾不完整的消息留待下次解码）
+//
+// handler 需要提供 OnAddOrder / OnCancelOrder / OnModifyOrder / OnMarketOrder 四个重载，参数为消息结构体的常量引用。
+// 消息在交给 handler 之前已经校验过长度和枚举字段；遇到非法消息时停止解码，不抛出异常。
+// 消息头一到就检查类型和长度是否一致，不会为一个声明了错误长度的消息等待更多的数据。
+template<typename Handler>
+BinaryDecodeResult DecodeBinaryMessages(const char* data, std::size_t size, Handler&& handler)
+{
+    BinaryDecodeResult result;
+    auto& consumed = result.consumed_;
+    while (size - consumed >= sizeof(MessageHeader))
+    {
+        const auto& header = *reinterpret_cast<const MessageHeader*>(data + consumed);
+        const std::size_t length = header.length_;
+        const auto expected = GetOrderEntryMessageSize(header.type_);
+        if (expected == 0)
+        {
+            result.error_ = "Unknown binary message type.";
+            break;
+        }
+        if (length != expected)
+        {
+            result.error_ = "Binary message has an invalid length.";
+            break;
+        }
+        if (size - consumed < length)
+            break;
+
+        switch (header.type_)
+        {
+            case MessageType::AddOrder:
+                if (!(result.error_ = ValidateMessage<AddOrderMessage>(header)))
+                    handler.OnAddOrder(reinterpret_cast<const AddOrderMessage&>(header));
+                break;
+            case MessageType::CancelOrder:
+                if (!(result.error_ = ValidateMessage<CancelOrderMessage>(header)))
+                    handler.OnCancelOrder(reinterpret_cast<const CancelOrderMessage&>(header));
+                break;
+            case MessageType::ModifyOrder:
+                if (!(result.error_ = ValidateMessage<ModifyOrderMessage>(header)))
+                    handler.OnModifyOrder(reinterpret_cast<const ModifyOrderMessage&>(header));
+                break;
+            case MessageType::MarketOrder:
+                if (!(result.error_ = ValidateMessage<MarketOrderMessage>(header)))
+                    handler.OnMarketOrder(reinterpret_cast<const MarketOrderMessage&>(header));
+                break;
+            default:
+                result.error_ = "Unknown binary message type.";
+                break;
+        }
+        if (result.error_ != nullptr)
+            break;
+
+        consumed += length;
+    }
+    return result;
+}
+
+// 客户端使用：解码缓冲区中所有完整的执行回报并交给 onReport，返回已消费的字节数
+template<typename OnReport>
+std::size_t DecodeExecutionReports(const char* data, std::size_t size, OnReport&& onReport)
+{
+    std::size_t consumed{ };
+    while (size - consumed >= sizeof(ExecutionReportMessage))
+    {
+        const auto& header = *reinterpret_cast<const MessageHeader*>(data + consumed);
+        if (header.type_ != MessageType::ExecutionReport)
+            throw std::runtime_error("Expected an execution report.");
+
+        onReport(CastMessage<ExecutionReportMessage>(header));
+        consumed += sizeof(ExecutionReportMessage);
+    }
+    return consumed;
+}
+
+// 把解码出的消息直接分发到订单簿，每次调用产生的成交交给 onTrades
+template<typename OnTrades>
+class BinaryMessageDispatcher
+{
+public:
+    BinaryMessageDispatcher(Orderbook& orderbook, OnTrades onTrades)
+        : orderbook_{ orderbook }
+        , onTrades_{ std::move(onTrades) }
+    { }
+
+    // 消息是紧凑排列的，字段可能不对齐，先复制到局部变量再传给按引用接收参数的函数
+    void OnAddOrder(const AddOrderMessage& message)
+    {
+        const OrderId orderId = message.orderId_;
+        const Price price = message.price_;
+        const Quantity quantity = message.quantity_;
+        onTrades_(orderId, orderbook_.AddOrder(std::make_shared<Order>(ToOrderType(message.orderType_), orderId, ToSide(message.side_), price, quantity)));
+    }
+
+    void OnCancelOrder(const CancelOrderMessage& message)
+    {
+        orderbook_.CancelOrder(message.orderId_);
+    }
+
+    void OnModifyOrder(const ModifyOrderMessage& message)
+    {
+        const OrderId orderId = message.orderId_;
+        const Price price = message.price_;
+        const Quantity quantity = message.quantity_;
+        onTrades_(orderId, orderbook_.ModifyOrder(OrderModify{ orderId, ToSide(message.side_), price, quantity }));
+    }
+
+    void OnMarketOrder(const MarketOrderMessage& message)
+    {
+        const OrderId orderId = message.orderId_;
+        const Quantity quantity = message.quantity_;
+        onTrades_(orderId, orderbook_.AddOrder(std::make_shared<Order>(orderId, ToSide(message.side_), quantity)));
+    }
+
+private:
+    Orderbook& orderbook_;
+    OnTrades onTrades_;
+};
+
+// 解码并分发缓冲区中的所有完整消息
+template<typename OnTrades>
+BinaryDecodeResult DispatchBinaryMessages(Orderbook& orderbook, const char* data, std::size_t size, OnTrades&& onTrades)
+{
+    return DecodeBinaryMessages(data, size, BinaryMessageDispatcher<std::decay_t<OnTrades>>{ orderbook, std::forward<OnTrades>(onTrades) });
+}
+
+// 不关心成交时使用
+inline BinaryDecodeResult DispatchBinaryMessages(Orderbook& orderbook, const char* data, std::size_t size)
+{
+    return DispatchBinaryMessages(orderbook, data, size, [](OrderId, const Trades&) { });
+}
@@ -0,0 +1,331 @@
+#include "ColumnarExport.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::array<std::size_t, 6> TradeElementSizes{ sizeof(std::uint64_t), sizeof(OrderId), sizeof(OrderId), sizeof(Price), sizeof(Price), sizeof(Quantity) };
+    constexpr std::array<std::size_t, 5> LevelElementSizes{ sizeof(std::uint64_t), sizeof(std::uint8_t), sizeof(Price), sizeof(Quantity), sizeof(Quantity) };
+
+    static_assert(sizeof(ColumnarFileHeader) <= ColumnarFormat::Alignment);
+    static_assert(sizeof(ColumnarRowGroupHeader) <= ColumnarFormat::Alignment);
+
+    constexpr std::uint64_t AlignColumn(std::uint64_t size)
+    {
+        return (size + ColumnarFormat::Alignment - 1) / ColumnarFormat::Alignment * ColumnarFormat::Alignment;
+    }
+
+    constexpr char Padding[ColumnarFormat::Alignment]{ };
+}
+
+std::span<const std::size_t> GetColumnarElementSizes(ColumnarSchema schema)
+{
+    switch (schema)
+    {
+        case ColumnarSchema::Trades: return TradeElementSizes;
+        case ColumnarSchema::LevelDeltas: return LevelElementSizes;
+        default: throw std::runtime_error("Unknown columnar schema.");
+    }
+}
+
+ColumnarFileWriter::ColumnarFileWriter(const std::filesystem::path& path, ColumnarSchema schema, AsyncFileWriterOptions options)
+    : schema_{ schema }
+    , chunkSize_{ options.bufferSize_ / ColumnarFormat::Alignment * ColumnarFormat::Alignment }
+    , file_{ path, options }
+{
+    if (chunkSize_ == 0)
+        throw std::logic_error("Columnar export buffers must hold at least one aligned block.");
+
+    char header[ColumnarFormat::Alignment]{ };
+    const ColumnarFileHeader fileHeader{ ColumnarFormat::Magic, ColumnarFormat::Version, schema, static_cast<std::uint32_t>(GetColumnarElementSizes(schema).size()) };
+    std::memcpy(header, &fileHeader, sizeof(fileHeader));
+    file_.Write(header, sizeof(header));
+}
+
+void ColumnarFileWriter::WriteRowGroup(std::uint64_t rowCount, std::span<const void* const> columns)
+{
+    const auto elementSizes = GetColumnarElementSizes(schema_);
+    if (columns.size() != elementSizes.size())
+        throw std::logic_error("Row group does not match the columnar schema.");
+
+    ColumnarRowGroupHeader groupHeader{ rowCount, ColumnarFormat::Alignment };
+    for (const auto elementSize : elementSizes)
+        groupHeader.size_ += AlignColumn(rowCount * elementSize);
+
+    char header[ColumnarFormat::Alignment]{ };
+    std::memcpy(header, &groupHeader, sizeof(groupHeader));
+    file_.Write(header, sizeof(header));
+
+    for (std::size_t column = 0; column < columns.size(); ++column)
+    {
+        const auto size = rowCount * elementSizes[column];
+        Write(static_cast<const char*>(columns[column]), size);
+        file_.Write(Padding, AlignColumn(size) - size);
+    }
+    ++rowGroups_;
+}
+
+// 单次 AsyncFileWriter::Write 不能超过一个缓冲区，较大的列分块写入
+void ColumnarFileWriter::Write(const char* data, std::size_t size)
+{
+    for (std::size_t offset = 0; offset < size; offset += chunkSize_)
+        file_.Write(data + offset, std::min(chunkSize_, size - offset));
+}
+
+ColumnarTradeWriter::ColumnarTradeWriter(const std::filesystem::path& path, std::size_t rowGroupSize, AsyncFileWriterOptions options)
+    : rowGroupSize_{ rowGroupSize }
+    , file_{ path, ColumnarSchema::Trades, options }
+{
+    if (rowGroupSize == 0)
+        throw std::logic_error("Row group size must be positive.");
+
+    // 预留整个行组，追加时不再分配
+    timestamps_.reserve(rowGroupSize);
+    bidOrderIds_.reserve(rowGroupSize);
+    askOrderIds_.reserve(rowGroupSize);
+    bidPrices_.reserve(rowGroupSize);
+    askPrices_.reserve(rowGroupSize);
+    quantities_.reserve(rowGroupSize);
+}
+
+ColumnarTradeWriter::~ColumnarTradeWriter()
+{
+    WriteRowGroup();
+}
+
+void ColumnarTradeWriter::Append(const Trade& trade, std::uint64_t timestamp)
+{
+    timestamps_.push_back(timestamp);
+    bidOrderIds_.push_back(trade.GetBidTrade().orderId_);
+    askOrderIds_.push_back(trade.GetAskTrade().orderId_);
+    bidPrices_.push_back(trade.GetBidTrade().price_);
+    askPrices_.push_back(trade.GetAskTrade().price_);
+    quantities_.push_back(trade.GetBidTrade().quantity_);
+    ++rows_;
+
+    if (timestamps_.size() == rowGroupSize_)
+        WriteRowGroup();
+}
+
+void ColumnarTradeWriter::Append(const Trades& trades, std::uint64_t timestamp)
+{
+    for (const auto& trade : trades)
+        Append(trade, timestamp);
+}
+
+void ColumnarTradeWriter::Flush()
+{
+    WriteRowGroup();
+    file_.Flush();
+}
+
+void ColumnarTradeWriter::Sync()
+{
+    WriteRowGroup();
+    file_.Sync();
+}
+
+void ColumnarTradeWriter::WriteRowGroup()
+{
+    if (timestamps_.empty())
+        return;
+
+    const void* const columns[]{ timestamps_.data(), bidOrderIds_.data(), askOrderIds_.data(), bidPrices_.data(), askPrices_.data(), quantities_.data() };
+    file_.WriteRowGroup(timestamps_.size(), columns);
+
+    timestamps_.clear();
+    bidOrderIds_.clear();
+    askOrderIds_.clear();
+    bidPrices_.clear();
+    askPrices_.clear();
+    quantities_.clear();
+}
+
+ColumnarLevelWriter::ColumnarLevelWriter(const std::filesystem::path& path, std::size_t rowGroupSize, AsyncFileWriterOptions options)
+    : rowGroupSize_{ rowGroupSize }
+    , file_{ path, ColumnarSchema::LevelDeltas, options }
+{
+    if (rowGroupSize == 0)
+        throw std::logic_error("Row group size must be positive.");
+
+    timestamps_.reserve(rowGroupSize);
+    sides_.reserve(rowGroupSize);
+    prices_.reserve(rowGroupSize);
+    quantities_.reserve(rowGroupSize);
+    counts_.reserve(rowGroupSize);
+}
+
+ColumnarLevelWriter::~ColumnarLevelWriter()
+{
+    WriteRowGroup();
+}
+
+void ColumnarLevelWriter::Append(Side side, Price price, Quantity quantity, Quantity count, std::uint64_t timestamp)
+{
+    timestamps_.push_back(timestamp);
+    sides_.push_back(static_cast<std::uint8_t>(side));
+    prices_.push_back(price);
+    quantities_.push_back(quantity);
+    counts_.push_back(count);
+    ++rows_;
+
+    if (timestamps_.size() == rowGroupSize_)
+        WriteRowGroup();
+}
+
+void ColumnarLevelWriter::Flush()
+{
+    WriteRowGroup();
+    file_.Flush();
+}
+
+void ColumnarLevelWriter::Sync()
+{
+    WriteRowGroup();
+    file_.Sync();
+}
+
+void ColumnarLevelWriter::WriteRowGroup()
+{
+    if (timestamps_.empty())
+        return;
+
+    const void* const columns[]{ timestamps_.data(), sides_.data(), prices_.data(), quantities_.data(), counts_.data() };
+    file_.WriteRowGroup(timestamps_.size(), columns);
+
+    timestamps_.clear();
+    sides_.clear();
+    prices_.clear();
+    quantities_.clear();
+    counts_.clear();
+}
+
+ColumnarExporter::ColumnarExporter(const std::filesystem::path& tradesPath, const std::filesystem::path& levelsPath, std::size_t rowGroupSize)
+    : trades_{ tradesPath, rowGroupSize }
+    , levels_{ levelsPath, rowGroupSize }
+{ }
+
+void ColumnarExporter::OnLevelChanged(Side side, Price price, Quantity quantity, Quantity count)
+{
+    levels_.Append(side, price, quantity, count, timestamp_);
+}
+
+void ColumnarExporter::OnTrade(const Trade& trade)
+{
+    trades_.Append(trade, timestamp_);
+}
+
+void ColumnarExporter::Flush()
+{
+    trades_.Flush();
+    levels_.Flush();
+}
+
+void ColumnarExporter::Sync()
+{
+    trades_.Sync();
+    levels_.Sync();
+}
+
+ColumnarReader::ColumnarReader(const std::filesystem::path& path)
+{
+    std::uint64_t size{ };
+#ifndef _WIN32
+    const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        throw std::runtime_error("Unable to open columnar file.");
+
+    struct stat status{ };
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapping_ = static_cast<char*>(mapping);
+            mappingSize_ = size = static_cast<std::uint64_t>(status.st_size);
+            data_ = mapping_;
+        }
+    }
+    close(descriptor);  // 映射建立后不再需要文件描述符
+#endif
+
+    if (data_ == nullptr)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        if (!file)
+            throw std::runtime_error("Unable to open columnar file.");
+        size = std::filesystem::file_size(path);
+        buffer_ = std::make_unique<char[]>(static_cast<std::size_t>(size));
+        file.read(buffer_.get(), static_cast<std::streamsize>(size));
+        size = static_cast<std::uint64_t>(file.gcount());
+        data_ = buffer_.get();
+    }
+
+    Index(size);
+}
+
+ColumnarReader::~ColumnarReader()
+{
+#ifndef _WIN32
+    if (mapping_ != nullptr)
+        munmap(mapping_, static_cast<std::size_t>(mappingSize_));
+#endif
+}
+
+// 依次读取行组头，计算每一列的偏移；末尾不完整的行组被忽略
+void ColumnarReader::Index(std::uint64_t size)
+{
+    ColumnarFileHeader header{ };
+    if (size < ColumnarFormat::Alignment)
+        throw std::runtime_error("Columnar file is too short.");
+    std::memcpy(&header, data_, sizeof(header));
+    if (header.magic_ != ColumnarFormat::Magic || header.version_ != ColumnarFormat::Version)
+        throw std::runtime_error("Not a columnar export file.");
+
+    schema_ = header.schema_;
+    const auto elementSizes = GetColumnarElementSizes(schema_);
+    if (header.columnCount_ != elementSizes.size())
+        throw std::runtime_error("Columnar file does not match its schema.");
+
+    std::uint64_t offset = ColumnarFormat::Alignment;
+    while (size - offset >= ColumnarFormat::Alignment)
+    {
+        ColumnarRowGroupHeader groupHeader{ };
+        std::memcpy(&groupHeader, data_ + offset, sizeof(groupHeader));
+        if (groupHeader.size_ > size - offset)
+            break;
+
+        RowGroup group{ groupHeader.rowCount_, { } };
+        auto columnOffset = offset + ColumnarFormat::Alignment;
+        for (const auto elementSize : elementSizes)
+        {
+            group.columnOffsets_.push_back(columnOffset);
+            columnOffset += AlignColumn(groupHeader.rowCount_ * elementSize);
+        }
+        if (columnOffset - offset != groupHeader.size_)
+            throw std::runtime_error("Columnar row group has an invalid size.");
+
+        rows_ += group.rowCount_;
+        rowGroups_.push_back(std::move(group));
+        offset += groupHeader.size_;
+    }
+    tornBytes_ = size - offset;
+}
+
+void ColumnarReader::CheckColumn(std::size_t index, std::size_t elementSize) const
+{
+    const auto elementSizes = GetColumnarElementSizes(schema_);
+    if (index >= elementSizes.size() || elementSizes[index] != elementSize)
+        throw std::logic_error("Column type does not match the columnar schema.");
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "AsyncFileWriter.h"     // 包含异步文件写入器
+#include "OrderbookListener.h"   // 包含订单簿事件监听接口
+
+// 列式导出文件：供离线分析直接 mmap 后按列扫描
+//
+// 文件由一个文件头和若干行组组成。每个行组先是行组头，随后按表结构的顺序依次存放每一列的定长数组，
+// 每列的起始位置都按 64 字节对齐，数值使用本机字节序（小端），因此读者可以把映射后的列直接当作数组使用。
+// 行组只追加不修改，进程崩溃时末尾不完整的行组会被读者忽略。
+struct ColumnarFormat
+{
+    static constexpr std::uint32_t Magic = 0x4643424F;   // "OBCF"
+    static constexpr std::uint32_t Version = 1;
+    static constexpr std::size_t Alignment = 64;         // 文件头、行组头和每一列的对齐
+};
+
+// 表结构
+enum class ColumnarSchema : std::uint32_t
+{
+    Trades = 1,        // 成交
+    LevelDeltas = 2,   // 价格级别变化
+};
+
+// 成交表的列
+enum class TradeColumn
+{
+    Timestamp,    // std::uint64_t，纳秒
+    BidOrderId,   // OrderId
+    AskOrderId,   // OrderId
+    BidPrice,     // Price
+    AskPrice,     // Price
+    Quantity,     // Quantity
+};
+
+// 价格级别变化表的列，数量与订单数为变化后的值，订单数为 0 表示该级别被删除
+enum class LevelColumn
+{
+    Timestamp,    // std::uint64_t，纳秒
+    Side,         // std::uint8_t，Side 的取值
+    Price,        // Price
+    Quantity,     // Quantity
+    Count,        // Quantity
+};
+
+// 文件头，占一个对齐单位
+struct ColumnarFileHeader
+{
+    std::uint32_t magic_;
+    std::uint32_t version_;
+    ColumnarSchema schema_;
+    std::uint32_t columnCount_;
+};
+
+// 行组头，占一个对齐单位；size_ 包括行组头本身和所有列的填充
+struct ColumnarRowGroupHeader
+{
+    std::uint64_t rowCount_;
+    std::uint64_t size_;
+};
+
+// 某个表结构中各列元素的字节数
+std::span<const std::size_t> GetColumnarElementSizes(ColumnarSchema schema);
+
+// 行组写入器：由各表的写入器共用，负责文件头、对齐和按块交给 AsyncFileWriter
+class ColumnarFileWriter
+{
+public:
+    ColumnarFileWriter(const std::filesystem::path& path, ColumnarSchema schema, AsyncFileWriterOptions options);
+
+    // 写出一个行组，columns 按表结构的顺序给出每一列的数据
+    void WriteRowGroup(std::uint64_t rowCount, std::span<const void* const> columns);
+    void Flush() { file_.Flush(); }
+    void Sync() { file_.Sync(); }
+
+    std::uint64_t GetRowGroupCount() const { return rowGroups_; }
+
+private:
+    void Write(const char* data, std::size_t size);
+
+    ColumnarSchema schema_;
+    std::size_t chunkSize_;      // 单次交给 AsyncFileWriter 的最大字节数
+    AsyncFileWriter file_;
+    std::uint64_t rowGroups_{ };
+};
+
+// 成交导出：成交先追加到各列的内存数组中，攒满一个行组后整组写出
+class ColumnarTradeWriter
+{
+public:
+    explicit ColumnarTradeWriter(const std::filesystem::path& path, std::size_t rowGroupSize = 1 << 16, AsyncFileWriterOptions options = { });
+    // 析构时写出不完整的行组
+    ~ColumnarTradeWriter();
+
+    void Append(const Trade& trade, std::uint64_t timestamp);
+    // 追加一批成交，使用同一个时间戳
+    void Append(const Trades& trades, std::uint64_t timestamp);
+    // 把不完整的行组也写出，并交给 I/O 线程
+    void Flush();
+    // 写出所有数据并等待完成
+    void Sync();
+
+    std::uint64_t GetRowCount() const { return rows_; }
+
+private:
+    void WriteRowGroup();
+
+    std::size_t rowGroupSize_;
+    ColumnarFileWriter file_;
+    std::vector<std::uint64_t> timestamps_;
+    std::vector<OrderId> bidOrderIds_;
+    std::vector<OrderId> askOrderIds_;
+    std::vector<Price> bidPrices_;
+    std::vector<Price> askPrices_;
+    std::vector<Quantity> quantities_;
+    std::uint64_t rows_{ };
+};
+
+// 价格级别变化导出，行组的组织方式与 ColumnarTradeWriter 相同
+class ColumnarLevelWriter
+{
+public:
+    explicit ColumnarLevelWriter(const std::filesystem::path& path, std::size_t rowGroupSize = 1 << 16, AsyncFileWriterOptions options = { });
+    ~ColumnarLevelWriter();
+
+    void Append(Side side, Price price, Quantity quantity, Quantity count, std::uint64_t timestamp);
+    void Flush();
+    void Sync();
+
+    std::uint64_t GetRowCount() const { return rows_; }
+
+private:
+    void WriteRowGroup();
+
+    std::size_t rowGroupSize_;
+    ColumnarFileWriter file_;
+    std::vector<std::uint64_t> timestamps_;
+    std::vector<std::uint8_t> sides_;
+    std::vector<Price> prices_;
+    std::vector<Quantity> quantities_;
+    std::vector<Quantity> counts_;
+    std::uint64_t rows_{ };
+};
+
+// 订单簿导出监听者：把成交和价格级别变化分别写入两个列式文件
+//
+// 回调在持有订单簿锁时调用，这里只追加到内存中的列数组，行组写满时才把数据拷贝给 AsyncFileWriter。
+// 事件的时间戳为最近一次 SetTimestamp 的值，调用方通常在提交每条消息或每批命令之前设置。
+class ColumnarExporter : public OrderbookListener
+{
+public:
+    ColumnarExporter(const std::filesystem::path& tradesPath, const std::filesystem::path& levelsPath, std::size_t rowGroupSize = 1 << 16);
+
+    void SetTimestamp(std::uint64_t timestamp) { timestamp_ = timestamp; }
+
+    void OnLevelChanged(Side side, Price price, Quantity quantity, Quantity count) override;
+    void OnTrade(const Trade& trade) override;
+
+    void Flush();
+    void Sync();
+
+    const ColumnarTradeWriter& GetTrades() const { return trades_; }
+    const ColumnarLevelWriter& GetLevels() const { return levels_; }
+
+private:
+    ColumnarTradeWriter trades_;
+    ColumnarLevelWriter levels_;
+    std::uint64_t timestamp_{ };
+};
+
+// 列式文件的读者：映射整个文件（无法映射时读入内存），按行组和列返回类型化的数组
+//
+// 文件格式或表结构不符时抛出 std::runtime_error；列的元素类型与表结构不符时抛出 std::logic_error。
+class ColumnarReader
+{
+public:
+    explicit ColumnarReader(const std::filesystem::path& path);
+    ColumnarReader(const ColumnarReader&) = delete;
+    void operator=(const ColumnarReader&) = delete;
+    ~ColumnarReader();
+
+    ColumnarSchema GetSchema() const { return schema_; }
+    std::size_t GetRowGroupCount() const { return rowGroups_.size(); }
+    std::uint64_t GetRowCount() const { return rows_; }
+    std::uint64_t GetRowCount(std::size_t rowGroup) const { return rowGroups_[rowGroup].rowCount_; }
+    // 末尾被忽略的不完整行组的字节数
+    std::uint64_t GetTornBytes() const { return tornBytes_; }
+    bool IsMemoryMapped() const { return mapping_ != nullptr; }
+
+    // 某个行组中的某一列
+    template<typename T, typename Column>
+    std::span<const T> GetColumn(std::size_t rowGroup, Column column) const
+    {
+        const auto index = static_cast<std::size_t>(column);
+        CheckColumn(index, sizeof(T));
+        const auto& group = rowGroups_[rowGroup];
+        return { reinterpret_cast<const T*>(data_ + group.columnOffsets_[index]), static_cast<std::size_t>(group.rowCount_) };
+    }
+
+private:
+    struct RowGroup
+    {
+        std::uint64_t rowCount_;
+        std::vector<std::uint64_t> columnOffsets_;   // 每一列在文件中的偏移
+    };
+
+    void Index(std::uint64_t size);
+    void CheckColumn(std::size_t index, std::size_t elementSize) const;
+
+    char* mapping_{ };                   // POSIX 上映射的文件
+    std::uint64_t mappingSize_{ };
+    std::unique_ptr<char[]> buffer_;     // 无法映射时读入的整个文件
+    const char* data_{ };
+    ColumnarSchema schema_{ };
+    std::vector<RowGroup> rowGroups_;
+    std::uint64_t rows_{ };
+    std::uint64_t tornBytes_{ };
+};
@@ -0,0 +1,153 @@
+#include "FixProtocol.h"
+
+#include <charconv>
+
+namespace
+{
+    // 输出位置：只向调用方预留的缓冲区中追加，不做任何分配
+    class FixWriter
+    {
+    public:
+        explicit FixWriter(char* out)
+            : position_{ out }
+        { }
+
+        char* GetPosition() const { return position_; }
+
+        void Raw(std::string_view value)
+        {
+            std::memcpy(position_, value.data(), value.size());
+            position_ += value.size();
+        }
+
+        void Tag(std::uint32_t tag)
+        {
+            position_ = std::to_chars(position_, position_ + 8, tag).ptr;
+            *position_++ = '=';
+        }
+
+        void Field(std::uint32_t tag, std::string_view value)
+        {
+            Tag(tag);
+            Raw(value);
+            *position_++ = Fix::Separator;
+        }
+
+        void Field(std::uint32_t tag, char value)
+        {
+            Tag(tag);
+            *position_++ = value;
+            *position_++ = Fix::Separator;
+        }
+
+        // 定点小数，最多 6 位小数，去掉末尾的 0
+        void Field(std::uint32_t tag, double value)
+        {
+            Tag(tag);
+            auto* end = std::to_chars(position_, position_ + 32, value, std::chars_format::fixed, 6).ptr;
+            while (end[-1] == '0')
+                --end;
+            if (end[-1] == '.')
+                --end;
+            position_ = end;
+            *position_++ = Fix::Separator;
+        }
+
+        template<typename Integer>
+        void Field(std::uint32_t tag, Integer value)
+        {
+            Tag(tag);
+            position_ = std::to_chars(position_, position_ + 24, value).ptr;
+            *position_++ = Fix::Separator;
+        }
+
+    private:
+        char* position_;
+    };
+
+    void WriteDigits(char* out, unsigned value, int width)
+    {
+        for (int index = width - 1; index >= 0; --index, value /= 10)
+            out[index] = static_cast<char>('0' + value % 10);
+    }
+
+    // 二进制执行回报类型到 ExecType (150) / OrdStatus (39) 的映射
+    std::pair<char, char> ToFixStatus(const ExecutionReportMessage& report)
+    {
+        switch (report.executionType_)
+        {
+            case ExecutionType::Accepted: return { '0', '0' };
+            case ExecutionType::Rejected: return { '8', '8' };
+            case ExecutionType::Filled: return { 'F', report.leavesQuantity_ == 0 ? '2' : '1' };
+            case ExecutionType::Cancelled: return { '4', '4' };
+            default: throw std::logic_error("Unknown execution type.");
+        }
+    }
+}
+
+void FormatFixTimestamp(char* out, std::chrono::system_clock::time_point time)
+{
+    using namespace std::chrono;
+    const auto day = floor<days>(time);
+    const year_month_day date{ day };
+    const hh_mm_ss clock{ floor<milliseconds>(time - day) };
+
+    WriteDigits(out, static_cast<unsigned>(static_cast<int>(date.year())), 4);
+    WriteDigits(out + 4, static_cast<unsigned>(date.month()), 2);
+    WriteDigits(out + 6, static_cast<unsigned>(date.day()), 2);
+    out[8] = '-';
+    WriteDigits(out + 9, static_cast<unsigned>(clock.hours().count()), 2);
+    out[11] = ':';
+    WriteDigits(out + 12, static_cast<unsigned>(clock.minutes().count()), 2);
+    out[14] = ':';
+    WriteDigits(out + 15, static_cast<unsigned>(clock.seconds().count()), 2);
+    out[17] = '.';
+    WriteDigits(out + 18, static_cast<unsigned>(clock.subseconds().count()), 3);
+}
+
+std::size_t EncodeFixExecutionReport(char* out, FixSession& session, const char* sendingTime, std::string_view symbol, const ExecutionReportMessage& report, const FixExecutionFields& fields)
+{
+    // 先把消息体写到预留的消息头空间之后，得到 BodyLength 后再把消息头写在消息体前面
+    constexpr std::size_t HeaderReserve = Fix::BeginString.size() + Fix::MaxBodyLengthDigits + 1;
+    const auto [execType, ordStatus] = ToFixStatus(report);
+    const auto sequence = ++session.outboundSequence_;
+
+    char* body = out + HeaderReserve;
+    FixWriter writer{ body };
+    writer.Field(Fix::Tags::MsgType, '8');
+    writer.Field(Fix::Tags::SenderCompId, session.local_.View());
+    writer.Field(Fix::Tags::TargetCompId, session.remote_.View());
+    writer.Field(Fix::Tags::MsgSeqNum, sequence);
+    writer.Field(Fix::Tags::SendingTime, std::string_view{ sendingTime, Fix::TimestampSize });
+    writer.Field(Fix::Tags::OrderId, report.orderId_);
+    writer.Field(Fix::Tags::ClOrdId, report.orderId_);
+    writer.Field(Fix::Tags::ExecId, sequence);
+    writer.Field(Fix::Tags::ExecType, execType);
+    writer.Field(Fix::Tags::OrdStatus, ordStatus);
+    if (!symbol.empty())
+        writer.Field(Fix::Tags::Symbol, symbol.substr(0, Fix::MaxCompIdSize));
+    writer.Field(Fix::Tags::Side, fields.side_ == Side::Buy ? '1' : '2');
+    writer.Field(Fix::Tags::LastQty, report.quantity_);
+    writer.Field(Fix::Tags::LastPx, report.price_);
+    writer.Field(Fix::Tags::LeavesQty, report.leavesQuantity_);
+    writer.Field(Fix::Tags::CumQty, fields.cumQuantity_);
+    writer.Field(Fix::Tags::AvgPx, fields.averagePrice_);
+    const auto bodyLength = static_cast<std::size_t>(writer.GetPosition() - body);
+
+    char length[Fix::MaxBodyLengthDigits];
+    const auto lengthSize = static_cast<std::size_t>(std::to_chars(length, length + sizeof(length), bodyLength).ptr - length);
+    FixWriter header{ out };
+    header.Raw(Fix::BeginString);
+    header.Raw({ length, lengthSize });
+    header.Raw({ &Fix::Separator, 1 });
+    std::memmove(header.GetPosition(), body, bodyLength);
+
+    char* trailer = header.GetPosition() + bodyLength;
+    unsigned checksum{ };
+    for (const char* position = out; position != trailer; ++position)
+        checksum += static_cast<unsigned char>(*position);
+    std::memcpy(trailer, "10=", 3);
+    WriteDigits(trailer + 3, checksum % 256, 3);
+    trailer[6] = Fix::Separator;
+    return static_cast<std::size_t>(trailer + Fix::TrailerSize - out);
+}
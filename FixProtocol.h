@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "BinaryProtocol.h"   // 包含执行回报消息的定义
+
+// FIX 4.4 订单录入（tag=value 编码）
+//
+// 只处理订单录入需要的三种应用消息：NewOrderSingle (D)、OrderCancelRequest (F)、OrderCancelReplaceRequest (G)，
+// 其他消息（包括 Logon、Heartbeat 等会话层消息）只检查帧和校验和后跳过。
+// 解码时直接在接收缓冲区上扫描 tag=value 字段，字符串字段以 string_view 指向缓冲区，不拷贝、不分配内存。
+// 订单簿使用整数订单 ID 和整数价格，因此 ClOrdID (11) / OrigClOrdID (41) 必须是十进制整数，Price (44) 不能有非零的小数部分。
+// 改单不改变订单在订单簿中的 ID：OrigClOrdID 标识被修改的订单，之后的撤单和改单仍使用该 ID。
+
+namespace Fix
+{
+    constexpr char Separator = '\x01';
+    constexpr std::string_view BeginString = "8=FIX.4.4\x01" "9=";
+    constexpr std::size_t TrailerSize = 7;               // "10=nnn" 加分隔符
+    constexpr std::size_t MaxBodyLengthDigits = 6;
+    constexpr std::size_t MaxCompIdSize = 32;
+    constexpr std::size_t TimestampSize = 21;            // YYYYMMDD-HH:MM:SS.sss
+    constexpr std::size_t MaxExecutionReportSize = 384;  // 一条执行回报的最大长度，用于预留输出缓冲区
+
+    // 字段号
+    namespace Tags
+    {
+        enum : std::uint32_t
+        {
+            AvgPx = 6,
+            ClOrdId = 11,
+            CumQty = 14,
+            ExecId = 17,
+            LastPx = 31,
+            LastQty = 32,
+            MsgSeqNum = 34,
+            MsgType = 35,
+            OrderId = 37,
+            OrderQty = 38,
+            OrdStatus = 39,
+            OrdType = 40,
+            OrigClOrdId = 41,
+            Price = 44,
+            SenderCompId = 49,
+            SendingTime = 52,
+            Side = 54,
+            Symbol = 55,
+            TargetCompId = 56,
+            TimeInForce = 59,
+            ExecType = 150,
+            LeavesQty = 151,
+        };
+    }
+
+    // 由字段值的单个字符查表得到枚举值，-1 表示非法取值
+    using LookupTable = std::array<std::int8_t, 256>;
+
+    // Side (54)：1 = 买，2 = 卖
+    constexpr LookupTable SideTable = []
+    {
+        LookupTable table{ };
+        table.fill(-1);
+        table['1'] = static_cast<std::int8_t>(::Side::Buy);
+        table['2'] = static_cast<std::int8_t>(::Side::Sell);
+        return table;
+    }();
+
+    // TimeInForce (59)：0 = 当日有效，1 = 撤销前有效，3 = 立即成交否则撤销，4 = 全部成交否则撤销
+    constexpr LookupTable TimeInForceTable = []
+    {
+        LookupTable table{ };
+        table.fill(-1);
+        table['0'] = static_cast<std::int8_t>(OrderType::GoodForDay);
+        table['1'] = static_cast<std::int8_t>(OrderType::GoodTillCancel);
+        table['3'] = static_cast<std::int8_t>(OrderType::FillAndKill);
+        table['4'] = static_cast<std::int8_t>(OrderType::FillOrKill);
+        return table;
+    }();
+
+    // OrdType (40)：1 = 市价，2 = 限价；限价单的订单类型由 TimeInForce 决定，这里用 GoodTillCancel 占位
+    constexpr LookupTable OrdTypeTable = []
+    {
+        LookupTable table{ };
+        table.fill(-1);
+        table['1'] = static_cast<std::int8_t>(OrderType::Market);
+        table['2'] = static_cast<std::int8_t>(OrderType::GoodTillCancel);
+        return table;
+    }();
+
+    [[noreturn]] inline void Fail(const char* reason, std::uint32_t tag = 0)
+    {
+        if (tag == 0)
+            throw std::runtime_error(std::format("FIX message {}.", reason));
+        throw std::runtime_error(std::format("FIX message {} (tag {}).", reason, tag));
+    }
+
+    // 解析无符号十进制整数，不允许超过 max
+    inline std::uint64_t ParseUnsigned(std::string_view value, std::uint64_t max, std::uint32_t tag)
+    {
+        if (value.empty() || value.size() > 19)
+            Fail("has an invalid number", tag);
+
+        std::uint64_t result{ };
+        for (const char character : value)
+        {
+            const auto digit = static_cast<unsigned char>(character - '0');
+            if (digit >= 10)
+                Fail("has an invalid number", tag);
+            result = result * 10 + digit;
+        }
+        if (result > max)
+            Fail("has an out-of-range number", tag);
+        return result;
+    }
+
+    // 解析价格：可以带负号和全为 0 的小数部分
+    inline ::Price ParsePrice(std::string_view value)
+    {
+        const bool negative = !value.empty() && value.front() == '-';
+        if (negative)
+            value.remove_prefix(1);
+
+        if (const auto point = value.find('.'); point != std::string_view::npos)
+        {
+            if (value.find_first_not_of('0', point + 1) != std::string_view::npos)
+                Fail("has a fractional price", Tags::Price);
+            value = value.substr(0, point);
+        }
+
+        const auto magnitude = static_cast<::Price>(ParseUnsigned(value, std::numeric_limits<::Price>::max(), Tags::Price));
+        return negative ? -magnitude : magnitude;
+    }
+
+    // 查表转换单字符枚举字段
+    template<typename Enum>
+    Enum Lookup(const LookupTable& table, std::string_view value, std::uint32_t tag)
+    {
+        if (value.size() != 1 || table[static_cast<unsigned char>(value.front())] < 0)
+            Fail("has an invalid enumeration value", tag);
+        return static_cast<Enum>(table[static_cast<unsigned char>(value.front())]);
+    }
+}
+
+// 会话双方的标识（SenderCompID / TargetCompID），保存在定长数组中
+struct FixCompId
+{
+    char data_[Fix::MaxCompIdSize];
+    std::uint8_t size_;
+
+    std::string_view View() const { return { data_, size_ }; }
+};
+
+// 一个 FIX 会话的状态：由第一条收到的消息确定双方标识，之后的消息必须一致
+struct FixSession
+{
+    FixCompId local_{ };             // 本方（收到消息的 TargetCompID）
+    FixCompId remote_{ };            // 对方（收到消息的 SenderCompID）
+    bool established_{ false };
+    std::uint64_t inboundSequence_{ };   // 最后收到的 MsgSeqNum
+    std::uint64_t outboundSequence_{ };  // 最后发出的 MsgSeqNum
+};
+
+// 解码出的订单录入消息
+struct FixOrderMessage
+{
+    char msgType_;                   // 'D' / 'F' / 'G'
+    std::uint64_t msgSeqNum_;
+    OrderId clOrdId_;
+    OrderId origClOrdId_;            // 仅 F / G 有效
+    Side side_;
+    OrderType orderType_;
+    Price price_;                    // 市价单为 Constants::InvalidPrice
+    Quantity quantity_;
+};
+
+// 解码缓冲区中所有完整的 FIX 消息，订单录入消息交给 handler，返回已消费的字节数（末尾不完整的消息留待下次解码）
+//
+// handler 需要提供 OnNewOrderSingle / OnOrderCancelRequest / OnOrderCancelReplaceRequest，参数为 FixOrderMessage 的常量引用。
+// 帧、校验和、会话标识或字段格式错误时抛出 std::runtime_error。
+template<typename Handler>
+std::size_t DecodeFixMessages(const char* data, std::size_t size, FixSession& session, Handler&& handler)
+{
+    std::size_t consumed{ };
+    while (size - consumed >= Fix::BeginString.size())
+    {
+        const char* begin = data + consumed;
+        const char* end = data + size;
+        if (std::memcmp(begin, Fix::BeginString.data(), Fix::BeginString.size()) != 0)
+            Fix::Fail("has an invalid header");
+
+        // BodyLength (9)
+        const char* lengthBegin = begin + Fix::BeginString.size();
+        const auto lengthSearch = std::min<std::size_t>(static_cast<std::size_t>(end - lengthBegin), Fix::MaxBodyLengthDigits + 1);
+        const auto* lengthEnd = static_cast<const char*>(std::memchr(lengthBegin, Fix::Separator, lengthSearch));
+        if (lengthEnd == nullptr)
+        {
+            if (lengthSearch > Fix::MaxBodyLengthDigits)
+                Fix::Fail("has an invalid body length");
+            break;
+        }
+        const auto bodyLength = Fix::ParseUnsigned({ lengthBegin, static_cast<std::size_t>(lengthEnd - lengthBegin) }, 1 << 20, 9);
+        const char* body = lengthEnd + 1;
+        if (static_cast<std::size_t>(end - body) < bodyLength + Fix::TrailerSize)
+            break;
+
+        // CheckSum (10)：校验和之前所有字节之和模 256
+        const char* bodyEnd = body + bodyLength;
+        if (std::memcmp(bodyEnd, "10=", 3) != 0 || bodyEnd[Fix::TrailerSize - 1] != Fix::Separator)
+            Fix::Fail("has an invalid trailer");
+        unsigned checksum{ };
+        for (const char* position = begin; position != bodyEnd; ++position)
+            checksum += static_cast<unsigned char>(*position);
+        if (Fix::ParseUnsigned({ bodyEnd + 3, 3 }, 255, 10) != checksum % 256)
+            Fix::Fail("has an invalid checksum");
+
+        // 在消息体上就地扫描字段
+        FixOrderMessage message{ };
+        message.price_ = Constants::InvalidPrice;
+        std::string_view msgType, senderCompId, targetCompId, timeInForce;
+        bool hasClOrdId{ }, hasOrigClOrdId{ }, hasSide{ }, hasOrdType{ }, hasPrice{ }, hasQuantity{ };
+        for (const char* position = body; position != bodyEnd;)
+        {
+            std::uint32_t tag{ };
+            while (position != bodyEnd && static_cast<unsigned char>(*position - '0') < 10)
+                tag = tag * 10 + static_cast<unsigned char>(*position++ - '0');
+            if (position == bodyEnd || *position != '=' || tag == 0)
+                Fix::Fail("has a malformed field");
+
+            const char* valueBegin = ++position;
+            const auto* valueEnd = static_cast<const char*>(std::memchr(valueBegin, Fix::Separator, static_cast<std::size_t>(bodyEnd - valueBegin)));
+            if (valueEnd == nullptr)
+                Fix::Fail("has an unterminated field", tag);
+            const std::string_view value{ valueBegin, static_cast<std::size_t>(valueEnd - valueBegin) };
+            position = valueEnd + 1;
+
+            switch (tag)
+            {
+                case Fix::Tags::MsgType: msgType = value; break;
+                case Fix::Tags::SenderCompId: senderCompId = value; break;
+                case Fix::Tags::TargetCompId: targetCompId = value; break;
+                case Fix::Tags::MsgSeqNum: message.msgSeqNum_ = Fix::ParseUnsigned(value, std::numeric_limits<std::uint64_t>::max(), tag); break;
+                case Fix::Tags::ClOrdId: message.clOrdId_ = Fix::ParseUnsigned(value, std::numeric_limits<OrderId>::max(), tag); hasClOrdId = true; break;
+                case Fix::Tags::OrigClOrdId: message.origClOrdId_ = Fix::ParseUnsigned(value, std::numeric_limits<OrderId>::max(), tag); hasOrigClOrdId = true; break;
+                case Fix::Tags::Side: message.side_ = Fix::Lookup<Side>(Fix::SideTable, value, tag); hasSide = true; break;
+                case Fix::Tags::OrdType: message.orderType_ = Fix::Lookup<OrderType>(Fix::OrdTypeTable, value, tag); hasOrdType = true; break;
+                case Fix::Tags::TimeInForce: timeInForce = value; break;
+                case Fix::Tags::Price: message.price_ = Fix::ParsePrice(value); hasPrice = true; break;
+                case Fix::Tags::OrderQty: message.quantity_ = static_cast<Quantity>(Fix::ParseUnsigned(value, std::numeric_limits<Quantity>::max(), tag)); hasQuantity = true; break;
+                default: break;
+            }
+        }
+
+        // 会话标识和序号
+        if (msgType.empty() || senderCompId.empty() || targetCompId.empty() || message.msgSeqNum_ == 0)
+            Fix::Fail("is missing a standard header field");
+        if (!session.established_)
+        {
+            if (senderCompId.size() > Fix::MaxCompIdSize || targetCompId.size() > Fix::MaxCompIdSize)
+                Fix::Fail("has a CompID that is too long");
+            std::memcpy(session.remote_.data_, senderCompId.data(), senderCompId.size());
+            session.remote_.size_ = static_cast<std::uint8_t>(senderCompId.size());
+            std::memcpy(session.local_.data_, targetCompId.data(), targetCompId.size());
+            session.local_.size_ = static_cast<std::uint8_t>(targetCompId.size());
+            session.established_ = true;
+        }
+        else if (senderCompId != session.remote_.View() || targetCompId != session.local_.View())
+            Fix::Fail("does not belong to this session");
+        if (message.msgSeqNum_ <= session.inboundSequence_)
+            Fix::Fail("has a sequence number that is too low", Fix::Tags::MsgSeqNum);
+        session.inboundSequence_ = message.msgSeqNum_;
+
+        consumed = static_cast<std::size_t>(bodyEnd + Fix::TrailerSize - data);
+        if (msgType.size() != 1)
+            continue;
+
+        message.msgType_ = msgType.front();
+        switch (message.msgType_)
+        {
+            case 'D':
+            case 'G':
+                if (!hasClOrdId || !hasSide || !hasOrdType || !hasQuantity || (message.msgType_ == 'G' && !hasOrigClOrdId))
+                    Fix::Fail("is missing a required order field");
+                if (message.msgType_ == 'G' && message.orderType_ == OrderType::Market)
+                    Fix::Fail("cannot replace an order with a market order", Fix::Tags::OrdType);
+                if (message.orderType_ != OrderType::Market)
+                {
+                    if (!hasPrice)
+                        Fix::Fail("is missing a limit price", Fix::Tags::Price);
+                    // TimeInForce 缺省为当日有效
+                    message.orderType_ = timeInForce.empty() ? OrderType::GoodForDay : Fix::Lookup<OrderType>(Fix::TimeInForceTable, timeInForce, Fix::Tags::TimeInForce);
+                }
+                if (message.msgType_ == 'D')
+                    handler.OnNewOrderSingle(message);
+                else
+                    handler.OnOrderCancelReplaceRequest(message);
+                break;
+            case 'F':
+                if (!hasClOrdId || !hasOrigClOrdId)
+                    Fix::Fail("is missing a required cancel field");
+                handler.OnOrderCancelRequest(message);
+                break;
+            default:
+                break;
+        }
+    }
+    return consumed;
+}
+
+// 把时间格式化为 UTCTimestamp（YYYYMMDD-HH:MM:SS.sss），写入 Fix::TimestampSize 个字符
+void FormatFixTimestamp(char* out, std::chrono::system_clock::time_point time);
+
+// 二进制执行回报中没有、而 FIX 4.4 的每条 ExecutionReport 都必须带的订单字段
+struct FixExecutionFields
+{
+    Side side_;                      // Side (54)
+    Quantity cumQuantity_;           // CumQty (14)：订单累计成交数量
+    double averagePrice_;            // AvgPx (6)：累计成交的平均价格，没有成交时为 0
+};
+
+// 把一条二进制执行回报编码为 FIX ExecutionReport (8)，写入 out（至少 Fix::MaxExecutionReportSize 字节），返回消息长度
+//
+// OrderID (37) 与 ClOrdID (11) 都是订单簿中的订单 ID；sendingTime 为 FormatFixTimestamp 的结果，可以在一批回报之间复用。
+std::size_t EncodeFixExecutionReport(char* out, FixSession& session, const char* sendingTime, std::string_view symbol, const ExecutionReportMessage& report, const FixExecutionFields& fields);
@@ -0,0 +1,447 @@
+#include "Journal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#include "Orderbook.h"
+
+namespace
+{
+    // zigzag 编码：把有符号差分映射为无符号数，使绝对值小的负数也只占少量字节
+    std::uint64_t ZigZagEncode(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t ZigZagDecode(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // 以 LEB128 格式写入 varint，返回写入的字节数
+    std::size_t PutVarint(char* out, std::uint64_t value)
+    {
+        std::size_t size{ };
+        while (value >= 0x80)
+        {
+            out[size++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out[size++] = static_cast<char>(value);
+        return size;
+    }
+
+    // 读取 varint，越界时抛出异常
+    std::uint64_t GetVarint(const char*& in, const char* end)
+    {
+        std::uint64_t value{ };
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (in == end)
+                throw std::runtime_error("Journal block is truncated.");
+
+            const auto byte = static_cast<std::uint8_t>(*in++);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw std::runtime_error("Journal varint is malformed.");
+    }
+
+    // CRC-32C（Castagnoli）查找表
+    constexpr std::array<std::uint32_t, 256> MakeCrcTable()
+    {
+        std::array<std::uint32_t, 256> table{ };
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+                value = (value >> 1) ^ ((value & 1) ? 0x82F63B78u : 0u);
+            table[i] = value;
+        }
+        return table;
+    }
+
+    constexpr auto CrcTable = MakeCrcTable();
+
+    std::uint32_t Crc32c(std::uint32_t crc, const char* data, std::size_t size)
+    {
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; ++i)
+            crc = CrcTable[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    // 块的 CRC 覆盖块头中 magic 与 CRC 之间的字段以及整个负载
+    std::uint32_t BlockCrc(const char* header, const char* payload, std::size_t payloadSize)
+    {
+        return Crc32c(Crc32c(0, header + 4, 16), payload, payloadSize);
+    }
+
+    // 读取并校验 offset 处的块，块不完整或校验失败时返回空
+    std::optional<JournalBlockHeader> ReadValidBlock(std::ifstream& file, std::uint64_t offset, std::vector<char>& payload)
+    {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+
+        char header[JournalFormat::BlockHeaderSize];
+        if (!file.read(header, sizeof(header)) || GetFixed<std::uint32_t>(header) != JournalFormat::Magic)
+            return std::nullopt;
+
+        const auto blockHeader = DecodeJournalBlockHeader(header);
+        if (blockHeader.payloadSize_ > JournalFormat::BlockPayloadSize)
+            return std::nullopt;
+
+        payload.resize(blockHeader.payloadSize_);
+        if (!file.read(payload.data(), blockHeader.payloadSize_) || !VerifyJournalBlock(header, payload.data()))
+            return std::nullopt;
+
+        return blockHeader;
+    }
+
+    // 记录头字节：低 2 位为动作类型，第 2 位为方向，高位为订单类型
+    char PackRecordHeader(const JournalMessage& message)
+    {
+        return static_cast<char>(static_cast<std::uint8_t>(message.type_)
+            | (static_cast<std::uint8_t>(message.side_) << 2)
+            | (static_cast<std::uint8_t>(message.orderType_) << 3));
+    }
+}
+
+JournalWriter::JournalWriter(const std::filesystem::path& path, AsyncFileWriterOptions options)
+    : JournalWriter{ path, options, JournalRecovery{ } }
+{ }
+
+JournalWriter::JournalWriter(const std::filesystem::path& path, JournalOpenMode mode, AsyncFileWriterOptions options)
+    : JournalWriter{ path, options, mode == JournalOpenMode::Resume && std::filesystem::exists(path) ? TruncateJournal(path) : JournalRecovery{ } }
+{ }
+
+// TruncateJournal 之后索引文件恰好覆盖所有有效块，因此索引也从文件末尾续写
+JournalWriter::JournalWriter(const std::filesystem::path& path, AsyncFileWriterOptions options, const JournalRecovery& recovery)
+    : file_{ path, options, recovery.validBytes_ }
+    , index_{ IndexPath(path), AsyncFileWriterOptions{ 64 * 1024, 4, options.syncEachWrite_ }, recovery.validBytes_ == 0 ? 0 : std::filesystem::file_size(IndexPath(path)) }
+    , fileOffset_{ recovery.validBytes_ }
+    , nextSequence_{ recovery.lastSequence_ + 1 }
+    , blockFirstSequence_{ recovery.lastSequence_ + 1 }
+{ }
+
+JournalWriter::~JournalWriter()
+{
+    WriteBlock();
+}
+
+std::filesystem::path JournalWriter::IndexPath(const std::filesystem::path& path)
+{
+    auto index = path;
+    index += ".idx";
+    return index;
+}
+
+void JournalWriter::ResetBlockState()
+{
+    blockFirstSequence_ = nextSequence_;
+    blockRecordCount_ = 0;
+    blockSize_ = 0;
+    lastOrderId_ = 0;
+    lastTimestamp_ = 0;
+    lastPrice_ = { };
+}
+
+std::uint64_t JournalWriter::Append(const JournalMessage& message)
+{
+    // 剩余空间不足以容纳一条最大长度的记录时，先写出当前块
+    if (JournalFormat::BlockPayloadSize - blockSize_ < JournalFormat::MaxRecordSize)
+        WriteBlock();
+
+    char* out = block_.data() + JournalFormat::BlockHeaderSize + blockSize_;
+    char* const begin = out;
+
+    *out++ = PackRecordHeader(message);
+    out += PutVarint(out, ZigZagEncode(static_cast<std::int64_t>(message.orderId_ - lastOrderId_)));
+    out += PutVarint(out, ZigZagEncode(static_cast<std::int64_t>(message.timestamp_ - lastTimestamp_)));
+    lastOrderId_ = message.orderId_;
+    lastTimestamp_ = message.timestamp_;
+
+    // 取消消息只需要订单 ID，清理消息只需要时间戳
+    if (message.type_ != JournalMessageType::Cancel && message.type_ != JournalMessageType::Prune)
+    {
+        auto& lastPrice = lastPrice_[static_cast<std::size_t>(message.side_)];
+        out += PutVarint(out, ZigZagEncode(static_cast<std::int64_t>(message.price_) - lastPrice));
+        out += PutVarint(out, message.quantity_);
+        lastPrice = message.price_;
+    }
+
+    blockSize_ += static_cast<std::size_t>(out - begin);
+    ++blockRecordCount_;
+    return nextSequence_++;
+}
+
+void JournalWriter::Flush()
+{
+    WriteBlock();
+    file_.Flush();
+    index_.Flush();
+}
+
+void JournalWriter::Sync()
+{
+    WriteBlock();
+    file_.Sync();
+    index_.Sync();
+}
+
+void JournalWriter::WriteBlock()
+{
+    if (blockRecordCount_ == 0)
+        return;
+
+    // 填写块头并整块写出
+    char* header = block_.data();
+    PutFixed<std::uint32_t>(header, JournalFormat::Magic);
+    PutFixed<std::uint32_t>(header + 4, static_cast<std::uint32_t>(blockSize_));
+    PutFixed<std::uint32_t>(header + 8, blockRecordCount_);
+    PutFixed<std::uint64_t>(header + 12, blockFirstSequence_);
+    PutFixed<std::uint32_t>(header + 20, BlockCrc(header, header + JournalFormat::BlockHeaderSize, blockSize_));
+
+    const auto blockBytes = JournalFormat::BlockHeaderSize + blockSize_;
+    file_.Write(block_.data(), blockBytes);
+
+    // 记录块索引
+    char entry[16];
+    PutFixed<std::uint64_t>(entry, blockFirstSequence_);
+    PutFixed<std::uint64_t>(entry + 8, fileOffset_);
+    index_.Write(entry, sizeof(entry));
+
+    fileOffset_ += blockBytes;
+    ResetBlockState();
+}
+
+JournalReader::JournalReader(const std::filesystem::path& path)
+    : file_{ path, std::ios::binary }
+{
+    if (!file_)
+        throw std::runtime_error("Unable to open journal for reading.");
+
+    payload_.resize(JournalFormat::BlockPayloadSize);
+
+    // 索引文件不存在时仍可顺序读取，只是无法快速定位
+    std::ifstream index{ JournalWriter::IndexPath(path), std::ios::binary };
+    char entry[16];
+    while (index.read(entry, sizeof(entry)))
+        index_.push_back(JournalBlockIndexEntry{ GetFixed<std::uint64_t>(entry), GetFixed<std::uint64_t>(entry + 8) });
+}
+
+bool JournalReader::Seek(std::uint64_t sequence)
+{
+    // 二分查找第一条序号不超过目标序号的块
+    auto it = std::upper_bound(index_.begin(), index_.end(), sequence,
+        [](std::uint64_t value, const JournalBlockIndexEntry& entry) { return value < entry.firstSequence_; });
+    if (it == index_.begin())
+        return false;
+    --it;
+
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(it->offset_));
+    offset_ = it->offset_;
+    nextSequence_ = sequence;
+    skip_ = sequence - it->firstSequence_;
+    return true;
+}
+
+std::size_t JournalReader::ReadBlock(JournalMessages& messages)
+{
+    messages.clear();
+
+    while (true)
+    {
+        // 文件末尾只有不完整的块时（写入方尚未写完或进程崩溃），回到块开头等待下一次读取
+        // 异步写入可能乱序完成，尚未写到的块在文件中表现为全零，写到一半的块无法通过 CRC 校验
+        char header[JournalFormat::BlockHeaderSize];
+        const bool hasHeader = file_.read(header, sizeof(header)) && GetFixed<std::uint32_t>(header) == JournalFormat::Magic;
+        const auto payloadSize = hasHeader ? DecodeJournalBlockHeader(header).payloadSize_ : 0;
+        if (!hasHeader || payloadSize > payload_.size()
+            || !file_.read(payload_.data(), payloadSize) || !VerifyJournalBlock(header, payload_.data()))
+        {
+            file_.clear();
+            file_.seekg(static_cast<std::streamoff>(offset_));
+            return 0;
+        }
+
+        offset_ += JournalFormat::BlockHeaderSize + payloadSize;
+        nextSequence_ = DecodeJournalBlock(header, payload_.data(), messages);
+
+        // Seek 之后丢弃目标序号之前的消息
+        if (skip_ > 0)
+        {
+            const auto skipped = std::min<std::uint64_t>(skip_, messages.size());
+            messages.erase(messages.begin(), messages.begin() + static_cast<std::ptrdiff_t>(skipped));
+            nextSequence_ += skipped;
+            skip_ -= skipped;
+        }
+
+        if (!messages.empty())
+        {
+            nextSequence_ += messages.size();
+            return messages.size();
+        }
+    }
+}
+
+JournalBlockHeader DecodeJournalBlockHeader(const char* header)
+{
+    if (GetFixed<std::uint32_t>(header) != JournalFormat::Magic)
+        throw std::runtime_error("Journal block has an invalid magic number.");
+
+    return JournalBlockHeader{
+        GetFixed<std::uint32_t>(header + 4),
+        GetFixed<std::uint32_t>(header + 8),
+        GetFixed<std::uint64_t>(header + 12),
+        GetFixed<std::uint32_t>(header + 20) };
+}
+
+bool VerifyJournalBlock(const char* header, const char* payload)
+{
+    const auto blockHeader = DecodeJournalBlockHeader(header);
+    return BlockCrc(header, payload, blockHeader.payloadSize_) == blockHeader.crc_;
+}
+
+JournalRecovery RecoverJournal(const std::filesystem::path& path)
+{
+    JournalReader reader{ path };
+    const auto& index = reader.GetIndex();
+    const auto fileSize = std::filesystem::file_size(path);
+
+    std::ifstream file{ path, std::ios::binary };
+    std::vector<char> payload;
+    JournalRecovery recovery{ };
+
+    // 从索引末尾向前找到最后一个完整有效的块（索引可能比日志文件写得更快，指向尚未落盘的块）
+    std::uint64_t offset{ };
+    for (auto it = index.rbegin(); it != index.rend(); ++it)
+    {
+        ++recovery.blocksRead_;
+        if (const auto header = ReadValidBlock(file, it->offset_, payload); header && header->firstSequence_ == it->firstSequence_)
+        {
+            offset = it->offset_;
+            break;
+        }
+    }
+
+    // 从该块开始向后确认，日志文件也可能比索引写得更快
+    while (true)
+    {
+        const auto header = ReadValidBlock(file, offset, payload);
+        if (!header)
+            break;
+
+        ++recovery.blocksRead_;
+        recovery.lastSequence_ = header->firstSequence_ + header->recordCount_ - 1;
+        offset += JournalFormat::BlockHeaderSize + header->payloadSize_;
+    }
+
+    recovery.validBytes_ = offset;
+    recovery.tornBytes_ = fileSize - offset;
+    return recovery;
+}
+
+JournalRecovery TruncateJournal(const std::filesystem::path& path)
+{
+    const auto recovery = RecoverJournal(path);
+    std::filesystem::resize_file(path, recovery.validBytes_);
+
+    // 按截断后的日志重建块索引：保留已有的有效条目，补上索引中缺失的块
+    JournalBlockIndex index;
+    {
+        std::ifstream file{ path, std::ios::binary };
+        std::vector<char> payload;
+        std::uint64_t offset{ };
+        while (const auto header = ReadValidBlock(file, offset, payload))
+        {
+            index.push_back(JournalBlockIndexEntry{ header->firstSequence_, offset });
+            offset += JournalFormat::BlockHeaderSize + header->payloadSize_;
+        }
+    }
+
+    std::ofstream indexFile{ JournalWriter::IndexPath(path), std::ios::binary | std::ios::trunc };
+    for (const auto& entry : index)
+    {
+        char bytes[16];
+        PutFixed<std::uint64_t>(bytes, entry.firstSequence_);
+        PutFixed<std::uint64_t>(bytes + 8, entry.offset_);
+        indexFile.write(bytes, sizeof(bytes));
+    }
+
+    return recovery;
+}
+
+std::uint64_t DecodeJournalBlock(const char* header, const char* payload, JournalMessages& messages)
+{
+    const auto blockHeader = DecodeJournalBlockHeader(header);
+
+    messages.clear();
+    messages.reserve(blockHeader.recordCount_);
+
+    const char* in = payload;
+    const char* const end = in + blockHeader.payloadSize_;
+    OrderId lastOrderId{ };
+    std::uint64_t lastTimestamp{ };
+    std::array<Price, 2> lastPrice{ };
+
+    for (std::uint32_t i = 0; i < blockHeader.recordCount_; ++i)
+    {
+        if (in == end)
+            throw std::runtime_error("Journal block is truncated.");
+
+        const auto recordHeader = static_cast<std::uint8_t>(*in++);
+        JournalMessage message{ };
+        message.type_ = static_cast<JournalMessageType>(recordHeader & 0x03);
+        message.side_ = static_cast<Side>((recordHeader >> 2) & 0x01);
+        message.orderType_ = static_cast<OrderType>(recordHeader >> 3);
+        message.orderId_ = lastOrderId + static_cast<OrderId>(ZigZagDecode(GetVarint(in, end)));
+        message.timestamp_ = lastTimestamp + static_cast<std::uint64_t>(ZigZagDecode(GetVarint(in, end)));
+        lastOrderId = message.orderId_;
+        lastTimestamp = message.timestamp_;
+
+        if (message.type_ != JournalMessageType::Cancel && message.type_ != JournalMessageType::Prune)
+        {
+            auto& last = lastPrice[static_cast<std::size_t>(message.side_)];
+            message.price_ = static_cast<Price>(last + ZigZagDecode(GetVarint(in, end)));
+            message.quantity_ = static_cast<Quantity>(GetVarint(in, end));
+            last = message.price_;
+        }
+
+        messages.push_back(message);
+    }
+
+    return blockHeader.firstSequence_;
+}
+
+Trades ApplyJournalMessage(Orderbook& orderbook, const JournalMessage& message)
+{
+    switch (message.type_)
+    {
+        case JournalMessageType::Add:
+            return orderbook.AddOrder(std::make_shared<Order>(
+                    message.orderType_,
+                    message.orderId_,
+                    message.side_,
+                    message.price_,
+                    message.quantity_));
+        case JournalMessageType::Modify:
+            return orderbook.ModifyOrder(OrderModify{ message.orderId_, message.side_, message.price_, message.quantity_ });
+        case JournalMessageType::Cancel:
+            orderbook.CancelOrder(message.orderId_);
+            return { };
+        case JournalMessageType::Prune:
+        {
+            const OrderbookCommand command{ OrderbookCommandType::Prune, OrderType::GoodForDay, Side::Buy, 0, 0, 0 };
+            Trades trades;
+            orderbook.ProcessCommands(std::span{ &command, 1 }, trades);
+            return trades;
+        }
+        default:
+            throw std::logic_error("Unsupported journal message.");
+    }
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "Usings.h"      // 包含 OrderId、Price、Quantity 等类型定义
+#include "OrderType.h"   // 包含订单类型的定义
+#include "Side.h"        // 包含订单方向的定义
+#include "Trade.h"       // 包含 Trades 的定义
+#include "AsyncFileWriter.h" // 包含异步文件写入器
+
+class Orderbook;
+
+// 日志消息的动作类型
+enum class JournalMessageType : std::uint8_t
+{
+    Add,    // 添加订单
+    Cancel, // 取消订单
+    Modify, // 修改订单
+    Prune,  // 每日清理：撤销所有 GoodForDay 订单，只携带时间戳
+};
+
+// 一条日志消息，对应订单簿的一次外部调用
+struct JournalMessage
+{
+    JournalMessageType type_;     // 动作类型
+    OrderType orderType_;         // 订单类型（仅 Add 有效）
+    Side side_;                   // 买卖方向（Add / Modify 有效）
+    Price price_;                 // 价格（Add / Modify 有效）
+    Quantity quantity_;           // 数量（Add / Modify 有效）
+    OrderId orderId_;             // 订单 ID
+    std::uint64_t timestamp_;     // 时间戳（纳秒）
+};
+
+using JournalMessages = std::vector<JournalMessage>;
+
+// 块索引条目：记录每个块的第一条消息序号及其在日志文件中的偏移量
+struct JournalBlockIndexEntry
+{
+    std::uint64_t firstSequence_; // 块内第一条消息的序号（从 1 开始）
+    std::uint64_t offset_;        // 块头在日志文件中的字节偏移
+};
+
+using JournalBlockIndex = std::vector<JournalBlockIndexEntry>;
+
+// 解码后的块头
+struct JournalBlockHeader
+{
+    std::uint32_t payloadSize_;   // 块负载长度
+    std::uint32_t recordCount_;   // 块内记录数
+    std::uint64_t firstSequence_; // 块内第一条消息的序号
+    std::uint32_t crc_;           // 块头（除 magic 和 CRC 外）与负载的 CRC-32C
+};
+
+// 崩溃恢复的结果
+struct JournalRecovery
+{
+    std::uint64_t lastSequence_;  // 最后一条完整有效消息的序号，0 表示没有有效消息
+    std::uint64_t validBytes_;    // 日志文件中有效数据的长度
+    std::uint64_t tornBytes_;     // 末尾不完整或校验失败的字节数
+    std::size_t blocksRead_;      // 恢复过程中读取的块数
+};
+
+// 日志格式常量
+//
+// 文件由若干个块组成，每个块 = 固定长度块头 + 变长记录。
+// 块内记录采用差分 + varint 编码：订单 ID、时间戳相对上一条记录做差分，
+// 价格相对同一方向上一条记录的价格做差分，有符号差分使用 zigzag 编码。
+// 每个块开始时差分状态清零，因此任何一个块都可以独立解码，配合 .idx 索引文件即可随机定位。
+// 每个块带有 CRC-32C，写到一半的块（进程崩溃或写入尚未完成）可以被可靠地识别出来。
+struct JournalFormat
+{
+    static constexpr std::uint32_t Magic = 0x324A424F;              // "OBJ2"
+    static constexpr std::size_t BlockHeaderSize = 4 + 4 + 4 + 8 + 4; // magic、负载长度、记录数、首序号、CRC
+    static constexpr std::size_t BlockPayloadSize = 64 * 1024;      // 单个块的最大负载长度
+    static constexpr std::size_t MaxRecordSize = 1 + 10 + 10 + 5 + 5; // 单条记录编码后的最大长度
+};
+
+// 以小端序写入 / 读取定长整数，日志块头和成交记录磁带共用同一份实现
+template<typename T>
+inline void PutFixed(char* out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        out[i] = static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF);
+}
+
+template<typename T>
+inline T GetFixed(const char* in)
+{
+    std::uint64_t value{ };
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(in[i])) << (8 * i);
+    return static_cast<T>(value);
+}
+
+// 获取日志时间戳（自纪元起的纳秒数）
+inline std::uint64_t JournalTimestamp()
+{
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+// 打开日志写入器的方式
+enum class JournalOpenMode
+{
+    Truncate, // 清空已有的日志，序号从 1 开始
+    Resume,   // 在已有日志的最后一个有效块之后续写，序号接着最后一条有效消息
+};
+
+// 日志写入器：将消息编码进内存中的块缓冲区，块满时整块交给异步写入器
+//
+// 撮合线程只做编码和内存拷贝，真正的写入与落盘由 AsyncFileWriter 的 I/O 线程完成。
+// 主节点重启时以 Resume 方式打开：末尾不完整的数据先按 TruncateJournal 截掉（块索引一并重建），
+// 新的块从有效数据的末尾开始写，日志不存在时与 Truncate 相同。
+class JournalWriter
+{
+public:
+    explicit JournalWriter(const std::filesystem::path& path, AsyncFileWriterOptions options = { });
+    JournalWriter(const std::filesystem::path& path, JournalOpenMode mode, AsyncFileWriterOptions options = { });
+    JournalWriter(const JournalWriter&) = delete;
+    void operator=(const JournalWriter&) = delete;
+    ~JournalWriter();
+
+    // 追加一条消息，返回分配给它的序号
+    std::uint64_t Append(const JournalMessage& message);
+    // 结束当前未写满的块，并把所有已编码的数据交给 I/O 线程（不等待写入完成）
+    void Flush();
+    // Flush 并等待所有数据写入完成（会阻塞，用于关闭和测试）
+    void Sync();
+
+    // 下一条消息将使用的序号
+    std::uint64_t GetNextSequence() const { return nextSequence_; }
+
+    // 日志对应的块索引文件路径
+    static std::filesystem::path IndexPath(const std::filesystem::path& path);
+
+private:
+    // 从 recovery 描述的有效数据末尾开始写
+    JournalWriter(const std::filesystem::path& path, AsyncFileWriterOptions options, const JournalRecovery& recovery);
+
+    // 结束当前块：填写块头并交给异步写入器，同时记录块索引
+    void WriteBlock();
+    void ResetBlockState();
+
+    AsyncFileWriter file_;                                      // 日志文件
+    AsyncFileWriter index_;                                     // 块索引文件
+    std::uint64_t fileOffset_{ };                               // 下一个块在文件中的偏移
+    std::uint64_t nextSequence_{ 1 };                           // 下一条消息的序号
+    std::uint64_t blockFirstSequence_{ 1 };                     // 当前块第一条消息的序号
+    std::uint32_t blockRecordCount_{ };                         // 当前块中的记录数
+    std::size_t blockSize_{ };                                  // 当前块已使用的负载长度
+    std::array<char, JournalFormat::BlockHeaderSize + JournalFormat::BlockPayloadSize> block_{ }; // 块缓冲区
+
+    // 差分编码状态
+    OrderId lastOrderId_{ };
+    std::uint64_t lastTimestamp_{ };
+    std::array<Price, 2> lastPrice_{ };                         // 按 Side 分别记录上一个价格
+};
+
+// 日志读取器：按块读取并解码，支持借助块索引定位到任意序号
+class JournalReader
+{
+public:
+    explicit JournalReader(const std::filesystem::path& path);
+
+    // 读取并解码下一个块（从当前位置开始），返回解码出的消息数量
+    // 返回 0 表示已到文件末尾；末尾不完整或 CRC 不匹配的块不会被消费，写入方补全后可再次读取，因此可用于跟随正在写入的日志
+    std::size_t ReadBlock(JournalMessages& messages);
+    // 定位到指定序号，之后的 ReadBlock 从该序号开始返回消息
+    bool Seek(std::uint64_t sequence);
+
+    // 下一条将被返回的消息的序号
+    std::uint64_t GetNextSequence() const { return nextSequence_; }
+    // 下一个待读取块在文件中的偏移
+    std::uint64_t GetOffset() const { return offset_; }
+    // 已加载的块索引
+    const JournalBlockIndex& GetIndex() const { return index_; }
+
+private:
+    std::ifstream file_;                 // 日志文件
+    JournalBlockIndex index_;            // 块索引
+    std::uint64_t offset_{ };            // 下一个待读取块在文件中的偏移
+    std::uint64_t nextSequence_{ 1 };    // 下一条消息的序号
+    std::uint64_t skip_{ };              // Seek 后需要在块内跳过的消息数
+    std::vector<char> payload_;          // 块负载缓冲区，重复使用以避免分配
+};
+
+// 解码块头，magic 不匹配时抛出异常
+JournalBlockHeader DecodeJournalBlockHeader(const char* header);
+// 校验块的 CRC
+bool VerifyJournalBlock(const char* header, const char* payload);
+// 解码一个完整的块（块头 + 负载），返回块内第一条消息的序号
+std::uint64_t DecodeJournalBlock(const char* header, const char* payload, JournalMessages& messages);
+
+// 查找日志中最后一条有效消息：从块索引的末尾开始向前校验，再向后确认索引之后是否还有完整的块，
+// 因此只需读取少量块，而不必扫描整个文件
+JournalRecovery RecoverJournal(const std::filesystem::path& path);
+// 截掉末尾不完整的数据，并重建与之对应的块索引
+JournalRecovery TruncateJournal(const std::filesystem::path& path);
+
+// 将一条日志消息应用到订单簿上，返回产生的成交
+Trades ApplyJournalMessage(Orderbook& orderbook, const JournalMessage& message);
@@ -0,0 +1,82 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+double GetTimestampCounterTicksPerNanosecond()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    static const double ticksPerNanosecond = []
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto startTime = Clock::now();
+        const auto startTicks = ReadTimestampCounter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto ticks = ReadTimestampCounter() - startTicks;
+        const auto nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count();
+        return static_cast<double>(ticks) / nanoseconds;
+    }();
+    return ticksPerNanosecond;
+#else
+    return 1.0;
+#endif
+}
+
+std::uint64_t LatencyHistogram::BucketUpperBound(std::size_t index)
+{
+    // 前 64 个桶逐个计数；之后每个区间的子桶由 shift 和 [32, 64) 内的高位组成
+    if (index < (2u << SubBucketBits))
+        return index;
+    const auto shift = static_cast<int>(index >> SubBucketBits) - 1;
+    const auto mantissa = static_cast<std::uint64_t>(index - (static_cast<std::size_t>(shift) << SubBucketBits));
+    return ((mantissa + 1) << shift) - 1;
+}
+
+std::uint64_t LatencyHistogram::GetQuantile(double quantile) const
+{
+    // 先取快照，使累计计数与总数一致
+    std::array<std::uint64_t, BucketCount> counts;
+    std::uint64_t total{ };
+    for (std::size_t index = 0; index < BucketCount; ++index)
+        total += counts[index] = counts_[index].load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(total))));
+    std::uint64_t seen{ };
+    for (std::size_t index = 0; index < BucketCount; ++index)
+    {
+        seen += counts[index];
+        if (seen >= rank)
+            return std::min(BucketUpperBound(index), max_.load(std::memory_order_relaxed));
+    }
+    return max_.load(std::memory_order_relaxed);
+}
+
+LatencySummary LatencyHistogram::Summarize() const
+{
+    const auto count = GetCount();
+    if (count == 0)
+        return { };
+
+    const auto ticksPerNanosecond = GetTimestampCounterTicksPerNanosecond();
+    const auto toNanoseconds = [ticksPerNanosecond](std::uint64_t ticks) { return static_cast<double>(ticks) / ticksPerNanosecond; };
+    return LatencySummary{
+        count,
+        toNanoseconds(total_.load(std::memory_order_relaxed)) / static_cast<double>(count),
+        toNanoseconds(GetQuantile(0.5)),
+        toNanoseconds(GetQuantile(0.99)),
+        toNanoseconds(GetQuantile(0.999)),
+        toNanoseconds(max_.load(std::memory_order_relaxed)),
+    };
+}
+
+void LatencyHistogram::Reset()
+{
+    for (auto& counter : counts_)
+        counter.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+// 读取时间戳计数器：x86 上为 TSC（rdtsc，约 20 个周期，不等待之前的指令完成），其他平台退化为 steady_clock 的纳秒数
+inline std::uint64_t ReadTimestampCounter()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// 每纳秒的计数器周期数；x86 上第一次调用时对照 steady_clock 校准一次（约 10 毫秒），假定 TSC 频率恒定
+double GetTimestampCounterTicksPerNanosecond();
+
+// 延迟分位数，单位为纳秒
+struct LatencySummary
+{
+    std::uint64_t count_{ };
+    double mean_{ };
+    double p50_{ };
+    double p99_{ };
+    double p999_{ };
+    double max_{ };
+};
+
+// HDR 风格的对数线性直方图，记录计数器周期数
+//
+// 每个 2 的幂区间再等分为 32 个子桶，相对误差不超过 1/32；0 到 63 个周期逐个计数。
+// 只允许一个线程写入（订单簿在持有锁时写入），计数用 relaxed 的 load + store 更新而不是原子加，
+// 写入只有几条指令；其他线程可以随时无锁读取，读到的是某个近似一致的快照。
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr std::size_t BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+    void Record(std::uint64_t ticks)
+    {
+        Increment(counts_[BucketIndex(ticks)], 1);
+        Increment(count_, 1);
+        Increment(total_, ticks);
+        if (ticks > max_.load(std::memory_order_relaxed))
+            max_.store(ticks, std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetCount() const { return count_.load(std::memory_order_relaxed); }
+    // 不小于 quantile 比例记录值的最小桶上界（周期数，不超过最大值），没有记录时返回 0
+    std::uint64_t GetQuantile(double quantile) const;
+    // 换算为纳秒的分位数
+    LatencySummary Summarize() const;
+    // 清空记录，不能与 Record 并发调用
+    void Reset();
+
+    // 值 ticks 所在的桶：高 6 位有效位决定子桶，其余位数决定区间
+    static std::size_t BucketIndex(std::uint64_t ticks)
+    {
+        const auto shift = std::bit_width(ticks | ((1ull << (SubBucketBits + 1)) - 1)) - (SubBucketBits + 1);
+        return (static_cast<std::size_t>(shift) << SubBucketBits) + static_cast<std::size_t>(ticks >> shift);
+    }
+    // 桶中最大的值
+    static std::uint64_t BucketUpperBound(std::size_t index);
+
+private:
+    static void Increment(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, BucketCount> counts_{ };
+    std::atomic<std::uint64_t> count_{ };
+    std::atomic<std::uint64_t> total_{ };
+    std::atomic<std::uint64_t> max_{ };
+};
+
+// 作用域计时：构造时读取计数器，析构时把经过的周期数记入直方图
+class LatencyTimer
+{
+public:
+    explicit LatencyTimer(LatencyHistogram& histogram)
+        : histogram_{ histogram }
+        , start_{ ReadTimestampCounter() }
+    { }
+    LatencyTimer(const LatencyTimer&) = delete;
+    void operator=(const LatencyTimer&) = delete;
+    ~LatencyTimer() { histogram_.Record(ReadTimestampCounter() - start_); }
+
+private:
+    LatencyHistogram& histogram_;
+    std::uint64_t start_;
+};
+
+// 连续计时：一串连续的操作共用边界上的读数，每个操作只读取一次计数器
+//
+// 每次 Lap 把距上一次读数经过的周期数记入直方图，适合批量处理中逐条计时。
+class LatencyLapTimer
+{
+public:
+    LatencyLapTimer() : last_{ ReadTimestampCounter() } { }
+
+    void Lap(LatencyHistogram& histogram)
+    {
+        const auto now = ReadTimestampCounter();
+        histogram.Record(now - last_);
+        last_ = now;
+    }
+
+    // 不计入任何直方图，只把读数推进到当前时刻（跳过不需要统计的操作）
+    void Skip() { last_ = ReadTimestampCounter(); }
+
+private:
+    std::uint64_t last_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <mutex>
+
+#include "LatencyHistogram.h"   // 包含延迟直方图和计数器读取
+
+// 一个加锁调用点的统计：等待时间（开始加锁到取得锁）和持有时间（取得锁到释放），单位为计数器周期
+struct LockSiteHistograms
+{
+    LatencyHistogram wait_;
+    LatencyHistogram hold_;
+};
+
+// 换算为纳秒的锁统计
+struct LockSiteSummary
+{
+    LatencySummary wait_;
+    LatencySummary hold_;
+};
+
+// 记录等待和持有时间的作用域锁，用法与 std::scoped_lock 相同
+//
+// 先 try_lock：没有竞争时等待时间记为 0，只读取一次计数器；有竞争时再阻塞加锁并记录等待时间。
+// 两个直方图都在持有锁时写入，因此同一把锁的所有调用点共用一个写者，满足 LatencyHistogram 单写者的要求。
+class ProfiledLock
+{
+public:
+    ProfiledLock(std::mutex& mutex, LockSiteHistograms& histograms)
+        : mutex_{ mutex }
+        , histograms_{ histograms }
+    {
+        if (mutex_.try_lock())
+        {
+            acquired_ = ReadTimestampCounter();
+            histograms_.wait_.Record(0);
+        }
+        else
+        {
+            const auto start = ReadTimestampCounter();
+            mutex_.lock();
+            acquired_ = ReadTimestampCounter();
+            histograms_.wait_.Record(acquired_ - start);
+        }
+    }
+
+    ProfiledLock(const ProfiledLock&) = delete;
+    void operator=(const ProfiledLock&) = delete;
+
+    ~ProfiledLock()
+    {
+        histograms_.hold_.Record(ReadTimestampCounter() - acquired_);
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex& mutex_;
+    LockSiteHistograms& histograms_;
+    std::uint64_t acquired_;
+};
@@ -0,0 +1,186 @@
+#include "MarketByOrderFeed.h"
+
+#include <format>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Orderbook.h"
+
+namespace
+{
+    constexpr std::size_t ReadBufferSize = 1 << 20;       // 按块读取时的缓冲区大小
+    constexpr std::size_t ReleaseThreshold = 16 << 20;    // 已解码部分累计到这么多字节后归还给内核
+
+    // 检查消息长度是否与消息类型一致
+    template<typename Message>
+    const Message& CastMarketByOrderMessage(const MarketByOrderHeader& header, std::uint64_t offset)
+    {
+        if (header.length_ != sizeof(Message))
+            throw std::runtime_error(std::format("Market-by-order message at offset {} has an invalid length.", offset));
+        return reinterpret_cast<const Message&>(header);
+    }
+}
+
+MarketByOrderReader::MarketByOrderReader(const std::filesystem::path& path)
+{
+#ifndef _WIN32
+    const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        throw std::runtime_error("Unable to open market-by-order capture.");
+
+    struct stat status{ };
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapping_ = static_cast<char*>(mapping);
+            mappingSize_ = static_cast<std::size_t>(status.st_size);
+            madvise(mapping_, mappingSize_, MADV_SEQUENTIAL);
+        }
+    }
+    close(descriptor);  // 映射建立后不再需要文件描述符
+
+    if (mapping_ != nullptr)
+    {
+        cursor_ = mapping_;
+        end_ = mapping_ + mappingSize_;
+        return;
+    }
+#endif
+
+    // 无法映射（空文件、管道或其他平台）时按块读取
+    file_.open(path, std::ios::binary);
+    if (!file_)
+        throw std::runtime_error("Unable to open market-by-order capture.");
+
+    buffer_ = std::make_unique<char[]>(ReadBufferSize);
+    cursor_ = end_ = buffer_.get();
+}
+
+MarketByOrderReader::~MarketByOrderReader()
+{
+#ifndef _WIN32
+    if (mapping_ != nullptr)
+        munmap(mapping_, mappingSize_);
+#endif
+}
+
+std::size_t MarketByOrderReader::Read(std::span<OrderbookCommand> commands)
+{
+    std::size_t count{ };
+    while (count < commands.size())
+    {
+        // 剩余数据不足一条完整的消息：先读入更多数据；文件已读完时剩余部分是被截断的消息
+        const auto available = static_cast<std::size_t>(end_ - cursor_);
+        if (available < sizeof(MarketByOrderHeader) ||
+            available < reinterpret_cast<const MarketByOrderHeader*>(cursor_)->length_)
+        {
+            if (Refill())
+                continue;
+            if (available == 0)
+                break;
+            throw std::runtime_error(std::format("Market-by-order capture is truncated at offset {}.", offset_));
+        }
+
+        const auto& header = *reinterpret_cast<const MarketByOrderHeader*>(cursor_);
+        auto& command = commands[count++];
+        switch (header.type_)
+        {
+            case MarketByOrderMessageType::Add:
+            {
+                const auto& message = CastMarketByOrderMessage<MarketByOrderAdd>(header, offset_);
+                if (message.side_ > static_cast<std::uint8_t>(Side::Sell))
+                    throw std::runtime_error(std::format("Market-by-order message at offset {} has an invalid side.", offset_));
+                command = OrderbookCommand{ OrderbookCommandType::Add, OrderType::GoodTillCancel, static_cast<Side>(message.side_), message.price_, message.quantity_, message.orderId_ };
+                break;
+            }
+            case MarketByOrderMessageType::Execute:
+            {
+                const auto& message = CastMarketByOrderMessage<MarketByOrderExecute>(header, offset_);
+                command = OrderbookCommand{ OrderbookCommandType::Execute, OrderType::GoodTillCancel, Side::Buy, 0, message.quantity_, message.orderId_ };
+                break;
+            }
+            case MarketByOrderMessageType::Cancel:
+            {
+                const auto& message = CastMarketByOrderMessage<MarketByOrderCancel>(header, offset_);
+                command = OrderbookCommand{ OrderbookCommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, message.orderId_ };
+                break;
+            }
+            case MarketByOrderMessageType::Replace:
+            {
+                const auto& message = CastMarketByOrderMessage<MarketByOrderReplace>(header, offset_);
+                command = OrderbookCommand{ OrderbookCommandType::Replace, OrderType::GoodTillCancel, Side::Buy, message.price_, message.quantity_, message.orderId_ };
+                break;
+            }
+            default:
+                throw std::runtime_error(std::format("Unknown market-by-order message type at offset {}.", offset_));
+        }
+
+        cursor_ += header.length_;
+        offset_ += header.length_;
+    }
+
+    ReleaseConsumed();
+    return count;
+}
+
+// 按块读取时，把不完整的消息移动到缓冲区开头并读入更多数据；读入了新数据时返回 true
+bool MarketByOrderReader::Refill()
+{
+    if (mapping_ != nullptr || endOfFile_)
+        return false;
+
+    const auto remaining = static_cast<std::size_t>(end_ - cursor_);
+    std::memmove(buffer_.get(), cursor_, remaining);
+    file_.read(buffer_.get() + remaining, static_cast<std::streamsize>(ReadBufferSize - remaining));
+    const auto received = static_cast<std::size_t>(file_.gcount());
+    if (received < ReadBufferSize - remaining)
+        endOfFile_ = true;
+
+    cursor_ = buffer_.get();
+    end_ = cursor_ + remaining + received;
+    return received > 0;
+}
+
+// 把已经解码过的映射页面归还给内核，使常驻内存不随文件大小增长
+void MarketByOrderReader::ReleaseConsumed()
+{
+#ifndef _WIN32
+    if (mapping_ == nullptr)
+        return;
+
+    static const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto consumed = static_cast<std::size_t>(cursor_ - mapping_) / pageSize * pageSize;
+    if (consumed - released_ < ReleaseThreshold)
+        return;
+
+    madvise(mapping_ + released_, consumed - released_, MADV_DONTNEED);
+    released_ = consumed;
+#endif
+}
+
+MarketByOrderReplay ReplayMarketByOrderFile(Orderbook& orderbook, const std::filesystem::path& path, std::size_t chunkSize)
+{
+    if (chunkSize == 0)
+        throw std::logic_error("Replay chunk size must be positive.");
+
+    MarketByOrderReader reader{ path };
+    OrderbookCommands commands(chunkSize);
+    MarketByOrderReplay replay;
+
+    while (const auto count = reader.Read(commands))
+    {
+        replay.skipped_ += orderbook.ApplyCommands(std::span{ commands.data(), count });
+        replay.messages_ += count;
+    }
+
+    replay.bytes_ = reader.GetOffset();
+    return replay;
+}
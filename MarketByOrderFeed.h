@@ -0,0 +1,153 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+
+#include "OrderbookCommand.h"   // 包含批量接口使用的命令定义
+
+class Orderbook;
+
+// 逐笔委托（market-by-order）行情的录制文件格式
+//
+// 文件由定长、紧凑排列（无填充）的小端消息首尾相接组成，每条消息以 MarketByOrderHeader 开头。
+// 消息描述外部市场上按订单 ID 标识的挂单变化，回放时原样应用到订单簿（见 Orderbook::ApplyCommands），不在本地撮合。
+static_assert(std::endian::native == std::endian::little, "Market-by-order captures are little-endian.");
+
+// 消息类型
+enum class MarketByOrderMessageType : std::uint8_t
+{
+    Add = 'A',       // 新挂单
+    Execute = 'E',   // 挂单成交了一部分或全部
+    Cancel = 'D',    // 挂单被删除
+    Replace = 'U',   // 挂单改价或改量；价格不变且数量不增加时保留队列位置
+};
+
+#pragma pack(push, 1)
+
+// 消息头：length_ 为包括消息头在内的整个消息长度
+struct MarketByOrderHeader
+{
+    std::uint16_t length_;
+    MarketByOrderMessageType type_;
+};
+
+struct MarketByOrderAdd
+{
+    MarketByOrderHeader header_;
+    OrderId orderId_;
+    std::uint8_t side_;         // Side 的取值
+    Price price_;
+    Quantity quantity_;
+};
+
+struct MarketByOrderExecute
+{
+    MarketByOrderHeader header_;
+    OrderId orderId_;
+    Quantity quantity_;         // 本次成交的数量
+};
+
+struct MarketByOrderCancel
+{
+    MarketByOrderHeader header_;
+    OrderId orderId_;
+};
+
+struct MarketByOrderReplace
+{
+    MarketByOrderHeader header_;
+    OrderId orderId_;
+    Price price_;
+    Quantity quantity_;         // 修改后的剩余数量
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(MarketByOrderAdd) == 20);
+static_assert(sizeof(MarketByOrderExecute) == 15);
+static_assert(sizeof(MarketByOrderCancel) == 11);
+static_assert(sizeof(MarketByOrderReplace) == 19);
+
+// 将消息编码到 out 中，返回消息长度（用于录制工具和测试）
+inline std::size_t EncodeMarketByOrderAdd(char* out, OrderId orderId, Side side, Price price, Quantity quantity)
+{
+    const MarketByOrderAdd message{ { sizeof(MarketByOrderAdd), MarketByOrderMessageType::Add }, orderId, static_cast<std::uint8_t>(side), price, quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeMarketByOrderExecute(char* out, OrderId orderId, Quantity quantity)
+{
+    const MarketByOrderExecute message{ { sizeof(MarketByOrderExecute), MarketByOrderMessageType::Execute }, orderId, quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeMarketByOrderCancel(char* out, OrderId orderId)
+{
+    const MarketByOrderCancel message{ { sizeof(MarketByOrderCancel), MarketByOrderMessageType::Cancel }, orderId };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+inline std::size_t EncodeMarketByOrderReplace(char* out, OrderId orderId, Price price, Quantity quantity)
+{
+    const MarketByOrderReplace message{ { sizeof(MarketByOrderReplace), MarketByOrderMessageType::Replace }, orderId, price, quantity };
+    std::memcpy(out, &message, sizeof(message));
+    return sizeof(message);
+}
+
+// 回放的统计信息
+struct MarketByOrderReplay
+{
+    std::uint64_t messages_{ };   // 应用的消息数
+    std::uint64_t bytes_{ };      // 读取的字节数
+    std::uint64_t skipped_{ };    // 无法应用而被跳过的消息数（如超过剩余数量的成交）
+};
+
+// 逐笔委托录制文件的流式读取器
+//
+// 在 POSIX 上把文件映射到内存中顺序扫描，已经解码过的页面会定期归还给内核；其他平台上按块读入固定大小的缓冲区。
+// 消息在映射（或缓冲区）中就地解码为订单簿命令，不拷贝、不构造中间对象。
+class MarketByOrderReader
+{
+public:
+    explicit MarketByOrderReader(const std::filesystem::path& path);
+    MarketByOrderReader(const MarketByOrderReader&) = delete;
+    void operator=(const MarketByOrderReader&) = delete;
+    ~MarketByOrderReader();
+
+    // 解码最多 commands.size() 条消息，返回实际解码出的条数；返回 0 表示文件已经读完
+    std::size_t Read(std::span<OrderbookCommand> commands);
+
+    // 已经解码的字节数
+    std::uint64_t GetOffset() const { return offset_; }
+    // 是否使用内存映射
+    bool IsMemoryMapped() const { return mapping_ != nullptr; }
+
+private:
+    bool Refill();
+    void ReleaseConsumed();
+
+    // 内存映射
+    char* mapping_{ };
+    std::size_t mappingSize_{ };
+    std::size_t released_{ };                // 已经归还给内核的字节数
+
+    // 按块读取（无法映射时使用）
+    std::ifstream file_;
+    std::unique_ptr<char[]> buffer_;
+    bool endOfFile_{ false };
+
+    const char* cursor_{ };                  // 下一条消息的起始位置
+    const char* end_{ };                     // 可用数据的结束位置
+    std::uint64_t offset_{ };
+};
+
+// 以 chunkSize 条消息为一批把录制文件应用到订单簿中，每批只加锁一次；订单簿必须是被动模式
+MarketByOrderReplay ReplayMarketByOrderFile(Orderbook& orderbook, const std::filesystem::path& path, std::size_t chunkSize = 4'096);
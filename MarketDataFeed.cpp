@@ -0,0 +1,197 @@
+#include "MarketDataFeed.h"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    constexpr std::size_t AlignToCacheLine(std::size_t size)
+    {
+        return (size + SharedMemoryFormat::CacheLineSize - 1) / SharedMemoryFormat::CacheLineSize * SharedMemoryFormat::CacheLineSize;
+    }
+
+    // 快照区在段中的偏移
+    constexpr std::size_t SnapshotOffset = AlignToCacheLine(sizeof(MarketDataHeader));
+
+    // 事件槽位区在段中的偏移
+    constexpr std::size_t GetSlotsOffset(std::uint32_t depth)
+    {
+        return SnapshotOffset + AlignToCacheLine(2 * std::size_t{ depth } * sizeof(LevelInfo));
+    }
+
+    constexpr std::size_t GetSegmentSize(std::uint32_t capacity, std::uint32_t depth)
+    {
+        return GetSlotsOffset(depth) + std::size_t{ capacity } * sizeof(MarketDataSlot);
+    }
+
+    // 检查写者的参数并返回段大小
+    std::size_t GetPublisherSegmentSize(std::uint32_t capacity, std::uint32_t depth, std::uint32_t snapshotInterval)
+    {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            throw std::logic_error("Market data capacity must be a power of two.");
+        // 读者重新同步后要从快照之后的第一个事件开始读，这些事件必须还在环中
+        if (snapshotInterval == 0 || snapshotInterval > capacity / 2)
+            throw std::logic_error("Market data snapshot interval must be between 1 and half the capacity.");
+        return GetSegmentSize(capacity, depth);
+    }
+
+    // 把 levels 中从最佳价格开始的最多 depth 个级别写入 destination，返回写入的个数
+    template<typename Levels>
+    std::uint32_t CopyTopLevels(const Levels& levels, LevelInfo* destination, std::uint32_t depth)
+    {
+        std::uint32_t count{ };
+        for (auto level = levels.begin(); level != levels.end() && count < depth; ++level)
+            destination[count++] = LevelInfo{ level->first, level->second };
+        return count;
+    }
+}
+
+MarketDataPublisher::MarketDataPublisher(const std::string& name, std::uint32_t capacity, std::uint32_t depth, std::uint32_t snapshotInterval)
+    : segment_{ SharedMemorySegment::Create(name, GetPublisherSegmentSize(capacity, depth, snapshotInterval)) }
+    , mask_{ capacity - 1u }
+    , snapshotInterval_{ snapshotInterval }
+{
+    auto* address = static_cast<char*>(segment_.GetAddress());
+    header_ = new (address) MarketDataHeader{ MarketDataFormat::Magic, MarketDataFormat::Version, capacity, depth, 0, 0, 0, 0, 0, 0 };
+    snapshotLevels_ = reinterpret_cast<LevelInfo*>(address + SnapshotOffset);
+    slots_ = reinterpret_cast<MarketDataSlot*>(address + GetSlotsOffset(depth));
+    for (std::uint32_t index = 0; index < capacity; ++index)
+        new (&slots_[index]) MarketDataSlot{ };
+
+    header_->ready_.store(1, std::memory_order_release);
+}
+
+void MarketDataPublisher::OnLevelChanged(Side side, Price price, Quantity quantity, Quantity count)
+{
+    if (side == Side::Buy)
+    {
+        if (count == 0)
+            bids_.erase(price);
+        else
+            bids_[price] = quantity;
+    }
+    else
+    {
+        if (count == 0)
+            asks_.erase(price);
+        else
+            asks_[price] = quantity;
+    }
+
+    Publish(MarketDataEvent{ 0, MarketDataEventType::Level, side, price, quantity, count, 0, 0, 0 });
+}
+
+void MarketDataPublisher::OnTrade(const Trade& trade)
+{
+    const auto& bid = trade.GetBidTrade();
+    const auto& ask = trade.GetAskTrade();
+    Publish(MarketDataEvent{ 0, MarketDataEventType::Trade, Side::Buy, bid.price_, bid.quantity_, 0, ask.price_, bid.orderId_, ask.orderId_ });
+}
+
+void MarketDataPublisher::Publish(const MarketDataEvent& event)
+{
+    // 先把槽位标记为改写中，再写入内容，最后写入新的序号；读者读取前后的序号一致才说明读到的内容完整
+    auto& slot = slots_[++sequence_ & mask_];
+    slot.sequence_.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event_ = event;
+    slot.event_.sequence_ = sequence_;
+    slot.sequence_.store(sequence_, std::memory_order_release);
+    header_->published_.store(sequence_, std::memory_order_release);
+
+    if (++sinceSnapshot_ >= snapshotInterval_)
+        PublishSnapshot();
+}
+
+void MarketDataPublisher::PublishSnapshot()
+{
+    const auto version = header_->snapshotVersion_.load(std::memory_order_relaxed);
+    header_->snapshotVersion_.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header_->snapshotSequence_ = sequence_;
+    header_->bidCount_ = CopyTopLevels(bids_, snapshotLevels_, header_->depth_);
+    header_->askCount_ = CopyTopLevels(asks_, snapshotLevels_ + header_->depth_, header_->depth_);
+
+    header_->snapshotVersion_.store(version + 2, std::memory_order_release);
+    sinceSnapshot_ = 0;
+}
+
+MarketDataSubscriber::MarketDataSubscriber(const std::string& name)
+    : segment_{ SharedMemorySegment::Open(name, true) }
+{
+    const auto* address = static_cast<const char*>(segment_.GetAddress());
+    header_ = reinterpret_cast<const MarketDataHeader*>(address);
+    if (segment_.GetSize() < sizeof(MarketDataHeader) ||
+        header_->magic_ != MarketDataFormat::Magic || header_->version_ != MarketDataFormat::Version ||
+        header_->ready_.load(std::memory_order_acquire) != 1 ||
+        segment_.GetSize() < GetSegmentSize(header_->capacity_, header_->depth_))
+        throw std::runtime_error("Shared memory segment is not a market data feed.");
+
+    snapshotLevels_ = reinterpret_cast<const LevelInfo*>(address + SnapshotOffset);
+    slots_ = reinterpret_cast<const MarketDataSlot*>(address + GetSlotsOffset(header_->depth_));
+    mask_ = header_->capacity_ - 1u;
+}
+
+MarketDataReadResult MarketDataSubscriber::Read(MarketDataEvent& event)
+{
+    const auto& slot = slots_[next_ & mask_];
+    const auto sequence = slot.sequence_.load(std::memory_order_acquire);
+    if (sequence != next_)
+    {
+        // 槽位中是更新的事件，或者写者正在用更新的事件改写它：next_ 已经被覆盖
+        if (sequence > next_ || header_->published_.load(std::memory_order_acquire) >= next_ + mask_)
+            return MarketDataReadResult::Overrun;
+        return MarketDataReadResult::NoData;
+    }
+
+    std::memcpy(&event, &slot.event_, sizeof(event));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence_.load(std::memory_order_relaxed) != next_)
+        return MarketDataReadResult::Overrun;
+
+    ++next_;
+    return MarketDataReadResult::Event;
+}
+
+MarketDataSnapshot MarketDataSubscriber::Resync()
+{
+    const auto depth = header_->depth_;
+    MarketDataSnapshot snapshot;
+    snapshot.bids_.resize(depth);
+    snapshot.asks_.resize(depth);
+
+    // 顺序锁：读取前后的版本号相同且为偶数时，读到的快照是完整的
+    std::uint64_t sequence{ };
+    std::uint32_t bidCount{ }, askCount{ };
+    while (true)
+    {
+        const auto version = header_->snapshotVersion_.load(std::memory_order_acquire);
+        if (version % 2 == 0)
+        {
+            sequence = header_->snapshotSequence_;
+            bidCount = std::min(header_->bidCount_, depth);
+            askCount = std::min(header_->askCount_, depth);
+            std::memcpy(snapshot.bids_.data(), snapshotLevels_, bidCount * sizeof(LevelInfo));
+            std::memcpy(snapshot.asks_.data(), snapshotLevels_ + depth, askCount * sizeof(LevelInfo));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->snapshotVersion_.load(std::memory_order_relaxed) == version)
+                break;
+        }
+        std::this_thread::yield();
+    }
+
+    snapshot.sequence_ = sequence;
+    snapshot.bids_.resize(bidCount);
+    snapshot.asks_.resize(askCount);
+    next_ = sequence + 1;
+    return snapshot;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "SharedMemoryChannel.h"   // 包含共享内存段的映射
+#include "OrderbookListener.h"     // 包含订单簿事件监听者的定义
+#include "LevelInfo.h"             // 包含 LevelInfos 的定义
+
+// 行情广播段的布局常量
+//
+// 段的开头是 MarketDataHeader，之后是快照区（depth_ 个买方级别和 depth_ 个卖方级别），最后是 capacity_ 个事件槽位。
+// 事件按序号（从 1 开始）写入第 sequence % capacity 个槽位，写者从不等待读者，读者落后超过一圈时事件被覆盖。
+struct MarketDataFormat
+{
+    static constexpr std::uint32_t Magic = 0x444D424F;        // "OBMD"
+    static constexpr std::uint32_t Version = 1;
+};
+
+// 行情事件的类型
+enum class MarketDataEventType : std::uint8_t
+{
+    Level = 'L',    // 价格级别变化
+    Trade = 'T',    // 成交
+};
+
+// 行情事件
+//
+// Level：side_ 方向 price_ 价格级别变化后的汇总数量 quantity_ 和订单数 count_，count_ 为 0 表示该级别已删除。
+// Trade：成交数量 quantity_，买方订单 bidOrderId_ 的价格 price_，卖方订单 askOrderId_ 的价格 askPrice_。
+struct MarketDataEvent
+{
+    std::uint64_t sequence_;
+    MarketDataEventType type_;
+    Side side_;
+    Price price_;
+    Quantity quantity_;
+    Quantity count_;
+    Price askPrice_;
+    OrderId bidOrderId_;
+    OrderId askOrderId_;
+};
+
+// 事件槽位：sequence_ 为 0 表示写者正在改写该槽位，其余时间等于 event_ 的序号
+struct alignas(SharedMemoryFormat::CacheLineSize) MarketDataSlot
+{
+    std::atomic<std::uint64_t> sequence_;
+    MarketDataEvent event_;
+};
+
+static_assert(sizeof(MarketDataSlot) == SharedMemoryFormat::CacheLineSize);
+
+struct MarketDataHeader
+{
+    std::uint32_t magic_;
+    std::uint32_t version_;
+    std::uint32_t capacity_;                  // 事件槽位数，2 的幂
+    std::uint32_t depth_;                     // 快照中每一方的最大级别数
+    std::atomic<std::uint32_t> ready_;        // 写者初始化完成后置为 1
+
+    alignas(SharedMemoryFormat::CacheLineSize) std::atomic<std::uint64_t> published_;   // 最后发布的事件序号
+
+    // 快照区由顺序锁保护：写者改写前后各把 snapshotVersion_ 加一，奇数表示正在改写
+    alignas(SharedMemoryFormat::CacheLineSize) std::atomic<std::uint64_t> snapshotVersion_;
+    std::uint64_t snapshotSequence_;          // 快照反映的是序号不超过该值的所有事件之后的状态
+    std::uint32_t bidCount_;
+    std::uint32_t askCount_;
+};
+
+// 读者从快照区恢复出的状态
+struct MarketDataSnapshot
+{
+    std::uint64_t sequence_{ };   // 之后应该从 sequence_ + 1 开始读取事件
+    LevelInfos bids_;             // 从最佳买价开始的前 depth 个买方级别
+    LevelInfos asks_;             // 从最佳卖价开始的前 depth 个卖方级别
+};
+
+// 行情广播的写者
+//
+// 作为订单簿的监听者，在撮合线程中把每个级别变化和成交写入共享内存中的事件环，
+// 并每隔 snapshotInterval 个事件把前 depth 个级别写入快照区，供落后的读者重新同步。
+// 读者以只读方式映射同一个段，写者不知道读者的存在，也不读取读者的任何状态，因此增加读者不会给撮合线程带来任何开销。
+class MarketDataPublisher : public OrderbookListener
+{
+public:
+    MarketDataPublisher(const std::string& name, std::uint32_t capacity = 65'536, std::uint32_t depth = 64, std::uint32_t snapshotInterval = 1'024);
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    void operator=(const MarketDataPublisher&) = delete;
+
+    void OnLevelChanged(Side side, Price price, Quantity quantity, Quantity count) override;
+    void OnTrade(const Trade& trade) override;
+
+    // 立即把当前的前 depth 个级别写入快照区
+    void PublishSnapshot();
+
+    // 最后发布的事件序号
+    std::uint64_t GetSequence() const { return sequence_; }
+
+private:
+    void Publish(const MarketDataEvent& event);
+
+    SharedMemorySegment segment_;
+    MarketDataHeader* header_{ };
+    LevelInfo* snapshotLevels_{ };
+    MarketDataSlot* slots_{ };
+    std::uint64_t mask_{ };
+    std::uint32_t snapshotInterval_{ };
+
+    std::uint64_t sequence_{ };
+    std::uint64_t sinceSnapshot_{ };
+
+    // 写者本地维护的完整级别，用于生成快照
+    std::map<Price, Quantity, std::greater<Price>> bids_;
+    std::map<Price, Quantity, std::less<Price>> asks_;
+};
+
+// 读取一个事件的结果
+enum class MarketDataReadResult
+{
+    Event,      // 读到了下一个事件
+    NoData,     // 下一个事件尚未发布
+    Overrun,    // 下一个事件已经被覆盖，需要调用 Resync
+};
+
+// 行情广播的读者，每个读者独立维护自己的读取位置
+//
+// 典型用法：先调用 Resync 取得初始状态，然后循环调用 Read 应用事件；遇到 Overrun 时再次 Resync。
+// 快照只包含前 depth 个级别，因此重新同步之后只有这部分级别是完整的，更深的级别要等到它们再次变化时才会出现。
+class MarketDataSubscriber
+{
+public:
+    explicit MarketDataSubscriber(const std::string& name);
+
+    // 读取下一个事件
+    MarketDataReadResult Read(MarketDataEvent& event);
+    // 从快照区恢复状态，并把读取位置移到快照之后的第一个事件
+    MarketDataSnapshot Resync();
+
+    // 下一个要读取的事件序号
+    std::uint64_t GetNextSequence() const { return next_; }
+    // 写者最后发布的事件序号
+    std::uint64_t GetPublishedSequence() const { return header_->published_.load(std::memory_order_acquire); }
+
+private:
+    SharedMemorySegment segment_;
+    const MarketDataHeader* header_{ };
+    const LevelInfo* snapshotLevels_{ };
+    const MarketDataSlot* slots_{ };
+    std::uint64_t mask_{ };
+    std::uint64_t next_{ 1 };
+};
+
+#endif
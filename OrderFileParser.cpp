@@ -0,0 +1,364 @@
+#include "OrderFileParser.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Orderbook.h"
+
+namespace
+{
+    constexpr std::size_t ReadBufferSize = 1 << 20;       // 按块读取时的缓冲区大小，也是单行长度的上限
+    constexpr std::size_t ReleaseThreshold = 16 << 20;    // 已解析部分累计到这么多字节后归还给内核
+
+    // 计算 [begin, begin + 64) 内换行符位置的位图，不足 64 字节时只检查到 end
+    std::uint64_t NewlineMask(const char* begin, const char* end)
+    {
+        if (end - begin >= 64)
+        {
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i newline = _mm_set1_epi8('\n');
+            std::uint64_t mask{ };
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 16 * i));
+                const auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+                mask |= static_cast<std::uint64_t>(bits) << (16 * i);
+            }
+            return mask;
+#endif
+        }
+
+        std::uint64_t mask{ };
+        const auto size = std::min<std::ptrdiff_t>(end - begin, 64);
+        for (std::ptrdiff_t i = 0; i < size; ++i)
+            mask |= static_cast<std::uint64_t>(begin[i] == '\n') << i;
+        return mask;
+    }
+
+    // 在一行内从左到右依次解析字段
+    class LineScanner
+    {
+    public:
+        LineScanner(const char* begin, const char* end, std::uint64_t lineNumber)
+            : position_{ begin }
+            , end_{ end }
+            , lineNumber_{ lineNumber }
+        { }
+
+        // 字段之间必须恰好是一个空格
+        void Separator()
+        {
+            if (position_ == end_ || *position_ != ' ')
+                Fail("expected a space");
+            ++position_;
+        }
+
+        // 解析无符号十进制整数，不允许超过 max
+        std::uint64_t Unsigned(std::uint64_t max)
+        {
+            const char* start = position_;
+            std::uint64_t value{ };
+            while (position_ != end_ && static_cast<unsigned char>(*position_ - '0') < 10)
+            {
+                value = value * 10 + static_cast<unsigned char>(*position_ - '0');
+                ++position_;
+            }
+
+            // 超过 19 位可能已经溢出
+            if (position_ == start || position_ - start > 19 || value > max)
+                Fail("invalid number");
+            return value;
+        }
+
+        Price ParsePrice() { return static_cast<Price>(Unsigned(std::numeric_limits<Price>::max())); }
+        Quantity ParseQuantity() { return static_cast<Quantity>(Unsigned(std::numeric_limits<Quantity>::max())); }
+        OrderId ParseOrderId() { return static_cast<OrderId>(Unsigned(std::numeric_limits<OrderId>::max())); }
+
+        Side ParseSide()
+        {
+            if (position_ == end_)
+                Fail("missing side");
+
+            const char value = *position_++;
+            if (value == 'B')
+                return Side::Buy;
+            if (value == 'S')
+                return Side::Sell;
+            Fail("unknown side");
+        }
+
+        OrderType ParseOrderType()
+        {
+            const char* start = position_;
+            while (position_ != end_ && *position_ != ' ')
+                ++position_;
+
+            const std::string_view word{ start, static_cast<std::size_t>(position_ - start) };
+            if (word == "GoodTillCancel")
+                return OrderType::GoodTillCancel;
+            if (word == "FillAndKill")
+                return OrderType::FillAndKill;
+            if (word == "FillOrKill")
+                return OrderType::FillOrKill;
+            if (word == "GoodForDay")
+                return OrderType::GoodForDay;
+            if (word == "Market")
+                return OrderType::Market;
+            Fail("unknown order type");
+        }
+
+        // 行尾不能有多余的字符
+        void End()
+        {
+            if (position_ != end_)
+                Fail("unexpected trailing characters");
+        }
+
+    private:
+        [[noreturn]] void Fail(const char* reason) const
+        {
+            throw std::logic_error(std::format("Order file line {}: {}.", lineNumber_, reason));
+        }
+
+        const char* position_;
+        const char* end_;
+        std::uint64_t lineNumber_;
+    };
+}
+
+OrderFileParser::OrderFileParser(const std::filesystem::path& path)
+{
+#ifndef _WIN32
+    const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        throw std::runtime_error("Unable to open order file.");
+
+    struct stat status{ };
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mapping_ = static_cast<char*>(mapping);
+            mappingSize_ = static_cast<std::size_t>(status.st_size);
+            madvise(mapping_, mappingSize_, MADV_SEQUENTIAL);
+        }
+    }
+    close(descriptor);  // 映射建立后不再需要文件描述符
+
+    if (mapping_ != nullptr)
+    {
+        cursor_ = mapping_;
+        end_ = mapping_ + mappingSize_;
+        ResetNewlineMask(cursor_);
+        return;
+    }
+#endif
+
+    // 无法映射（空文件、管道或其他平台）时按块读取
+    file_.open(path, std::ios::binary);
+    if (!file_)
+        throw std::runtime_error("Unable to open order file.");
+
+    buffer_ = std::make_unique<char[]>(ReadBufferSize);
+    cursor_ = end_ = buffer_.get();
+    ResetNewlineMask(cursor_);
+}
+
+OrderFileParser::~OrderFileParser()
+{
+#ifndef _WIN32
+    if (mapping_ != nullptr)
+        munmap(mapping_, mappingSize_);
+#endif
+}
+
+std::size_t OrderFileParser::Parse(std::span<OrderbookCommand> commands)
+{
+    std::size_t count{ };
+    while (count < commands.size())
+    {
+        const char* newline = NextNewline();
+        if (newline == end_)
+        {
+            // 没有完整的行：先读入更多数据；文件已读完时剩余部分就是没有换行符的最后一行
+            if (Refill())
+                continue;
+            if (cursor_ == end_)
+                break;
+        }
+
+        ++lineNumber_;
+        if (ParseLine(cursor_, newline, commands[count]))
+            ++count;
+        cursor_ = newline == end_ ? end_ : newline + 1;
+    }
+
+    ReleaseConsumed();
+    return count;
+}
+
+// 取出下一个换行符的位置，没有时返回 end_
+const char* OrderFileParser::NextNewline()
+{
+    while (newlineMask_ == 0)
+    {
+        if (end_ - maskBase_ <= 64)
+            return end_;
+
+        maskBase_ += 64;
+        newlineMask_ = NewlineMask(maskBase_, end_);
+    }
+
+    const char* newline = maskBase_ + std::countr_zero(newlineMask_);
+    newlineMask_ &= newlineMask_ - 1;  // 清除最低位，下次返回下一个换行符
+    return newline;
+}
+
+void OrderFileParser::ResetNewlineMask(const char* from)
+{
+    maskBase_ = from;
+    newlineMask_ = NewlineMask(from, end_);
+}
+
+// 按块读取时，把不完整的行移动到缓冲区开头并读入更多数据；读入了新数据时返回 true
+bool OrderFileParser::Refill()
+{
+    if (mapping_ != nullptr || endOfFile_)
+        return false;
+
+    const auto remaining = static_cast<std::size_t>(end_ - cursor_);
+    if (remaining == ReadBufferSize)
+        throw std::logic_error(std::format("Order file line {} is too long.", lineNumber_ + 1));
+
+    std::memmove(buffer_.get(), cursor_, remaining);
+    file_.read(buffer_.get() + remaining, static_cast<std::streamsize>(ReadBufferSize - remaining));
+    const auto received = static_cast<std::size_t>(file_.gcount());
+    if (received < ReadBufferSize - remaining)
+        endOfFile_ = true;
+
+    cursor_ = buffer_.get();
+    end_ = cursor_ + remaining + received;
+    ResetNewlineMask(cursor_);
+    return received > 0;
+}
+
+// 把已经解析过的映射页面归还给内核，使常驻内存不随文件大小增长
+void OrderFileParser::ReleaseConsumed()
+{
+#ifndef _WIN32
+    if (mapping_ == nullptr)
+        return;
+
+    static const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto consumed = static_cast<std::size_t>(cursor_ - mapping_) / pageSize * pageSize;
+    if (consumed - released_ < ReleaseThreshold)
+        return;
+
+    madvise(mapping_ + released_, consumed - released_, MADV_DONTNEED);
+    released_ = consumed;
+#endif
+}
+
+// 解析一行，产生命令时返回 true；空行和无法识别的行被跳过
+bool OrderFileParser::ParseLine(const char* begin, const char* end, OrderbookCommand& command)
+{
+    if (end != begin && end[-1] == '\r')
+        --end;
+    if (begin == end)
+        return false;
+
+    const char type = *begin;
+    if (type != 'A' && type != 'M' && type != 'C' && type != 'R')
+        return false;
+    if (result_.has_value())
+        throw std::logic_error("Result should only be specified at the end.");
+
+    LineScanner scanner{ begin + 1, end, lineNumber_ };
+    if (type == 'A')
+    {
+        command.type_ = OrderbookCommandType::Add;
+        scanner.Separator();
+        command.side_ = scanner.ParseSide();
+        scanner.Separator();
+        command.orderType_ = scanner.ParseOrderType();
+        scanner.Separator();
+        command.price_ = scanner.ParsePrice();
+        scanner.Separator();
+        command.quantity_ = scanner.ParseQuantity();
+        scanner.Separator();
+        command.orderId_ = scanner.ParseOrderId();
+    }
+    else if (type == 'M')
+    {
+        command.type_ = OrderbookCommandType::Modify;
+        scanner.Separator();
+        command.orderId_ = scanner.ParseOrderId();
+        scanner.Separator();
+        command.side_ = scanner.ParseSide();
+        scanner.Separator();
+        command.price_ = scanner.ParsePrice();
+        scanner.Separator();
+        command.quantity_ = scanner.ParseQuantity();
+    }
+    else if (type == 'C')
+    {
+        command.type_ = OrderbookCommandType::Cancel;
+        scanner.Separator();
+        command.orderId_ = scanner.ParseOrderId();
+    }
+    else
+    {
+        OrderFileResult result{ };
+        scanner.Separator();
+        result.allCount_ = scanner.Unsigned(std::numeric_limits<std::uint32_t>::max());
+        scanner.Separator();
+        result.bidCount_ = scanner.Unsigned(std::numeric_limits<std::uint32_t>::max());
+        scanner.Separator();
+        result.askCount_ = scanner.Unsigned(std::numeric_limits<std::uint32_t>::max());
+        scanner.End();
+        result_ = result;
+        return false;
+    }
+
+    scanner.End();
+    return true;
+}
+
+OrderFileReplay ReplayOrderFile(Orderbook& orderbook, const std::filesystem::path& path, std::size_t chunkSize)
+{
+    if (chunkSize == 0)
+        throw std::logic_error("Replay chunk size must be positive.");
+
+    OrderFileParser parser{ path };
+    OrderbookCommands commands(chunkSize);
+    Trades trades;
+    OrderFileReplay replay;
+
+    while (const auto count = parser.Parse(commands))
+    {
+        trades.clear();
+        orderbook.ProcessCommands(std::span{ commands.data(), count }, trades);
+        replay.commands_ += count;
+        replay.trades_ += trades.size();
+    }
+
+    replay.result_ = parser.GetResult();
+    return replay;
+}
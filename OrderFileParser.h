@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "OrderbookCommand.h"   // 包含批量接口使用的命令定义
+
+class Orderbook;
+
+// 文件末尾 R 行给出的预期结果
+struct OrderFileResult
+{
+    std::size_t allCount_;   // 订单总数
+    std::size_t bidCount_;   // 买单价格级别数
+    std::size_t askCount_;   // 卖单价格级别数
+};
+
+// 回放的统计信息
+struct OrderFileReplay
+{
+    std::uint64_t commands_{ };                 // 执行的命令数
+    std::uint64_t trades_{ };                   // 产生的成交数
+    std::optional<OrderFileResult> result_;     // 文件中的预期结果（如果有）
+};
+
+// 文本订单文件（A / M / C / R 格式）的流式解析器
+//
+// 在 POSIX 上把文件映射到内存中顺序扫描，已经解析过的页面会定期归还给内核；其他平台上按块读入固定大小的缓冲区。
+// 换行符使用 SIMD 按 64 字节一组查找并缓存为位图，字段在一次顺序扫描中直接解析，不切分字符串、不调用 from_chars。
+// 每次 Parse 只填充调用方提供的命令数组，因此无论文件多大，占用的内存都是常量。
+class OrderFileParser
+{
+public:
+    explicit OrderFileParser(const std::filesystem::path& path);
+    OrderFileParser(const OrderFileParser&) = delete;
+    void operator=(const OrderFileParser&) = delete;
+    ~OrderFileParser();
+
+    // 解析最多 commands.size() 条命令，返回实际解析出的条数；返回 0 表示文件已经读完
+    std::size_t Parse(std::span<OrderbookCommand> commands);
+
+    // 文件中的预期结果，读到 R 行之后才有值
+    const std::optional<OrderFileResult>& GetResult() const { return result_; }
+    // 已经处理的行数
+    std::uint64_t GetLineNumber() const { return lineNumber_; }
+    // 是否使用内存映射
+    bool IsMemoryMapped() const { return mapping_ != nullptr; }
+
+private:
+    const char* NextNewline();
+    void ResetNewlineMask(const char* from);
+    bool Refill();
+    void ReleaseConsumed();
+    bool ParseLine(const char* begin, const char* end, OrderbookCommand& command);
+
+    // 内存映射
+    char* mapping_{ };
+    std::size_t mappingSize_{ };
+    std::size_t released_{ };                // 已经归还给内核的字节数
+
+    // 按块读取（无法映射时使用）
+    std::ifstream file_;
+    std::unique_ptr<char[]> buffer_;
+    bool endOfFile_{ false };
+
+    const char* cursor_{ };                  // 下一行的起始位置
+    const char* end_{ };                     // 可用数据的结束位置
+    const char* maskBase_{ };                // 换行位图对应的起始位置
+    std::uint64_t newlineMask_{ };           // maskBase_ 起 64 字节内尚未处理的换行符位置
+
+    std::uint64_t lineNumber_{ };
+    std::optional<OrderFileResult> result_;
+};
+
+// 以 chunkSize 条命令为一批把订单文件回放到订单簿中，每批只加锁一次
+OrderFileReplay ReplayOrderFile(Orderbook& orderbook, const std::filesystem::path& path, std::size_t chunkSize = 4'096);
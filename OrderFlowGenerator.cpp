@@ -0,0 +1,373 @@
+#include "OrderFlowGenerator.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "BinaryProtocol.h"
+
+namespace
+{
+    constexpr std::uint32_t MaxLots = 20;   // 单个订单最多的手数
+
+    // 权重归一化为累积概率
+    std::array<double, 5> ToCumulative(const std::array<double, 5>& weights)
+    {
+        std::array<double, 5> cumulative{ };
+        double total{ };
+        for (std::size_t index = 0; index < weights.size(); ++index)
+        {
+            if (weights[index] < 0)
+                throw std::logic_error("Order type weights must not be negative.");
+            total += weights[index];
+            cumulative[index] = total;
+        }
+        if (total <= 0)
+            throw std::logic_error("At least one order type weight must be positive.");
+        for (auto& value : cumulative)
+            value /= total;
+        return cumulative;
+    }
+
+    char* Append(char* out, std::string_view value)
+    {
+        std::memcpy(out, value.data(), value.size());
+        return out + value.size();
+    }
+
+    // 追加一个空格和一个十进制整数
+    template<typename Integer>
+    char* AppendNumber(char* out, Integer value)
+    {
+        *out++ = ' ';
+        return std::to_chars(out, out + 24, value).ptr;
+    }
+}
+
+OrderFlowGenerator::OrderFlowGenerator(OrderFlowOptions options)
+    : options_{ options }
+    , random_{ options.seed_ }
+    , passiveTypes_{ ToCumulative(options.passiveTypeWeights_) }
+    , aggressiveTypes_{ ToCumulative(options.aggressiveTypeWeights_) }
+    , midPrice_{ options.midPrice_ }
+{
+    if (options_.depth_ == 0 || options_.maxTicks_ == 0 || options_.lotSize_ == 0)
+        throw std::logic_error("Order flow depth, tick range and lot size must be positive.");
+    if (options_.cancelRatio_ < 0 || options_.cancelRatio_ >= 1 || options_.modifyRatio_ < 0 || options_.modifyRatio_ >= 1)
+        throw std::logic_error("Order flow cancel and modify ratios must be in [0, 1).");
+    if (options_.calmRate_ <= 0 || options_.burstRate_ <= 0 || options_.priceTailExponent_ <= 0)
+        throw std::logic_error("Order flow rates and tail exponent must be positive.");
+    if (options_.midPrice_ <= static_cast<Price>(options_.maxTicks_))
+        throw std::logic_error("Order flow mid price must exceed the tick range.");
+
+    // 每个主动单大约吃掉一个挂单：设新订单中主动单的比例为 a，则挂单中被成交的比例为 a / (1 - a)，
+    // 令其等于 1 - cancelRatio_ 得到 a = (1 - c) / (2 - c)
+    aggressiveShare_ = (1 - options_.cancelRatio_) / (2 - options_.cancelRatio_);
+    resting_.reserve(options_.depth_ * 2);
+    live_.reserve(options_.depth_ * 2);
+
+    // tail_[k] = k^(-alpha) = P(d >= k)
+    tail_.resize(options_.maxTicks_ + 2);
+    for (std::size_t ticks = 1; ticks < tail_.size(); ++ticks)
+        tail_[ticks] = std::pow(static_cast<double>(ticks), -options_.priceTailExponent_);
+    tail_.back() = 0;
+}
+
+OrderbookCommand OrderFlowGenerator::Next()
+{
+    Advance();
+
+    // 挂单数不足目标的一半时只添加挂单（包括开始时建立订单簿）
+    if (resting_.empty() || resting_.size() < options_.depth_ / 2)
+        return MakePassive();
+
+    if (NextUniform() < options_.modifyRatio_)
+        return MakeModify();
+
+    // 稳定状态下撤单数为挂单数的 cancelRatio_ 倍；按挂单数与目标的比值调整撤单概率，使挂单数回到目标附近
+    const auto cancelsPerOrder = options_.cancelRatio_ * (1 - aggressiveShare_);
+    const auto cancelProbability = cancelsPerOrder / (1 + cancelsPerOrder) * static_cast<double>(resting_.size()) / options_.depth_;
+    const auto choice = NextUniform();
+    if (choice < cancelProbability)
+        return MakeCancel();
+    if ((choice - cancelProbability) / (1 - std::min(cancelProbability, 0.999)) < aggressiveShare_)
+        return MakeAggressive();
+    return MakePassive();
+}
+
+std::size_t OrderFlowGenerator::Generate(std::span<OrderbookCommand> commands)
+{
+    for (auto& command : commands)
+        command = Next();
+    return commands.size();
+}
+
+OrderbookCommand OrderFlowGenerator::MakePassive()
+{
+    ++counts_.passive_;
+    const auto side = NextSide();
+    const auto orderId = nextOrderId_++;
+    const OrderbookCommand command{ OrderbookCommandType::Add, PickType(passiveTypes_), side, PassivePrice(side), NextQuantity(), orderId };
+    Submit(orderId, side, command.orderType_, command.price_, command.quantity_);
+    return command;
+}
+
+// 主动单：市价单，或价格到达对手方最优价的限价单，越过的距离同样服从幂律
+OrderbookCommand OrderFlowGenerator::MakeAggressive()
+{
+    ++counts_.aggressive_;
+    auto side = NextSide();
+    // 中间价移动后，仍留在中间价另一侧的对手方挂单优先被主动单成交，最优价因此跟随中间价
+    if (!asks_.empty() && asks_.begin()->first <= midPrice_)
+        side = Side::Buy;
+    else if (!bids_.empty() && bids_.rbegin()->first >= midPrice_)
+        side = Side::Sell;
+    const auto orderType = PickType(aggressiveTypes_);
+    const auto orderId = nextOrderId_++;
+    const auto price = orderType == OrderType::Market ? Constants::InvalidPrice : AggressivePrice(side);
+    const OrderbookCommand command{ OrderbookCommandType::Add, orderType, side, price, NextQuantity(), orderId };
+    Submit(orderId, side, orderType, price, command.quantity_);
+    return command;
+}
+
+OrderbookCommand OrderFlowGenerator::MakeCancel()
+{
+    ++counts_.cancels_;
+    const auto orderId = resting_[NextIndex(resting_.size())];
+    Remove(live_.find(orderId));
+    return OrderbookCommand{ OrderbookCommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, orderId };
+}
+
+// 改单：同一侧的新价格和新数量；订单簿先撤销原订单再按原订单类型挂入，新价格不越过对手方最优价，因此不会成交
+OrderbookCommand OrderFlowGenerator::MakeModify()
+{
+    ++counts_.modifies_;
+    const auto orderId = resting_[NextIndex(resting_.size())];
+    const auto order = live_.find(orderId);
+    const auto side = order->second.side_;
+    const OrderbookCommand command{ OrderbookCommandType::Modify, OrderType::GoodTillCancel, side, PassivePrice(side), NextQuantity(), orderId };
+    Remove(order);
+    Submit(orderId, side, OrderType::GoodTillCancel, command.price_, command.quantity_);
+    return command;
+}
+
+// 离中间价的距离 d = floor(u^(-1 / alpha))，即 P(d >= k) = k^(-alpha)，超过 maxTicks_ 的部分截断；
+// 查预先计算的尾概率表代替 pow，距离集中在 1 附近，平均只需比较几次
+Price OrderFlowGenerator::NextTicks()
+{
+    const auto value = NextUniform();
+    Price ticks = 1;
+    while (value < tail_[ticks + 1])
+        ++ticks;
+    return ticks;
+}
+
+// 挂单价格从中间价起算，但不越过对手方的最优价（中间价本应在买卖最优价之间，这里再保证一次）
+Price OrderFlowGenerator::PassivePrice(Side side)
+{
+    const auto ticks = NextTicks();
+    if (side == Side::Buy)
+        return (asks_.empty() ? midPrice_ : std::min(midPrice_, asks_.begin()->first)) - ticks;
+    return (bids_.empty() ? midPrice_ : std::max(midPrice_, bids_.rbegin()->first)) + ticks;
+}
+
+// 主动单价格从对手方最优价起算，距离为 1 时恰好等于最优价；对手方为空时退化为越过中间价的限价单
+Price OrderFlowGenerator::AggressivePrice(Side side)
+{
+    const auto ticks = NextTicks();
+    if (side == Side::Buy)
+        return asks_.empty() ? midPrice_ + ticks : asks_.begin()->first + ticks - 1;
+    return bids_.empty() ? midPrice_ - ticks : bids_.rbegin()->first - ticks + 1;
+}
+
+// 在影子订单簿上按 Orderbook::AddOrderInternal 的规则执行一个新订单
+void OrderFlowGenerator::Submit(OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity)
+{
+    // 市价单转为对手方最差价格的 GoodTillCancel 订单，对手方为空时被丢弃
+    if (orderType == OrderType::Market)
+    {
+        const auto& opposite = side == Side::Buy ? asks_ : bids_;
+        if (opposite.empty())
+            return;
+        price = side == Side::Buy ? opposite.rbegin()->first : opposite.begin()->first;
+        orderType = OrderType::GoodTillCancel;
+    }
+
+    if (orderType == OrderType::FillOrKill && GetCrossingQuantity(side, price) < quantity)
+        return;
+
+    // 订单簿在挂单前没有交叉，因此能成交的新订单独占己方最优价，FillAndKill 的剩余部分总会被撤销
+    const auto remaining = Match(side, price, quantity);
+    if (remaining > 0 && orderType != OrderType::FillAndKill && orderType != OrderType::FillOrKill)
+        Rest(orderId, side, price, remaining);
+}
+
+// 按价格优先、时间优先与对手方成交，返回剩余数量
+Quantity OrderFlowGenerator::Match(Side side, Price price, Quantity quantity)
+{
+    auto& levels = side == Side::Buy ? asks_ : bids_;
+    while (quantity > 0 && !levels.empty())
+    {
+        const auto best = side == Side::Buy ? levels.begin() : std::prev(levels.end());
+        if (side == Side::Buy ? best->first > price : best->first < price)
+            break;
+
+        auto& level = best->second;
+        const auto entry = level.queue_.front();
+        level.queue_.pop_front();
+        const auto order = live_.find(entry.orderId_);
+        if (order == live_.end() || order->second.sequence_ != entry.sequence_)
+            continue;
+
+        if (quantity < order->second.quantity_)
+        {
+            order->second.quantity_ -= quantity;
+            level.quantity_ -= quantity;
+            level.queue_.push_front(entry);
+            return 0;
+        }
+
+        // 完全成交，Remove 可能删除该价格级别
+        quantity -= order->second.quantity_;
+        ++counts_.filled_;
+        Remove(order);
+    }
+    return quantity;
+}
+
+// 对手方价格满足条件的数量之和
+Quantity OrderFlowGenerator::GetCrossingQuantity(Side side, Price price) const
+{
+    Quantity quantity{ };
+    if (side == Side::Buy)
+    {
+        for (auto level = asks_.begin(); level != asks_.end() && level->first <= price; ++level)
+            quantity += level->second.quantity_;
+    }
+    else
+    {
+        for (auto level = bids_.rbegin(); level != bids_.rend() && level->first >= price; ++level)
+            quantity += level->second.quantity_;
+    }
+    return quantity;
+}
+
+void OrderFlowGenerator::Rest(OrderId orderId, Side side, Price price, Quantity quantity)
+{
+    auto& level = (side == Side::Buy ? bids_ : asks_)[price];
+    level.queue_.push_back(QueueEntry{ orderId, ++sequence_ });
+    level.quantity_ += quantity;
+    ++level.count_;
+    live_[orderId] = RestingOrder{ side, price, quantity, sequence_, resting_.size() };
+    resting_.push_back(orderId);
+
+    // 失效条目过多时压缩队列，长期存在的价格级别不会无限增长
+    if (level.queue_.size() > 2 * level.count_ + 16)
+    {
+        std::erase_if(level.queue_, [this](const QueueEntry& entry)
+        {
+            const auto order = live_.find(entry.orderId_);
+            return order == live_.end() || order->second.sequence_ != entry.sequence_;
+        });
+    }
+}
+
+// 从影子订单簿中删除挂单；价格队列中的条目留待成交或压缩时丢弃
+void OrderFlowGenerator::Remove(std::unordered_map<OrderId, RestingOrder>::iterator order)
+{
+    const auto& resting = order->second;
+    auto& levels = resting.side_ == Side::Buy ? bids_ : asks_;
+    const auto level = levels.find(resting.price_);
+    level->second.quantity_ -= resting.quantity_;
+    if (--level->second.count_ == 0)
+        levels.erase(level);
+
+    resting_[resting.index_] = resting_.back();
+    live_.find(resting_.back())->second.index_ = resting.index_;
+    resting_.pop_back();
+    live_.erase(order);
+}
+
+// 手数服从几何分布：一半的订单为一手，每多一手概率减半
+Quantity OrderFlowGenerator::NextQuantity()
+{
+    const auto lots = std::min<std::uint32_t>(1 + static_cast<std::uint32_t>(std::countr_zero(random_() | (1ull << 63))), MaxLots);
+    return options_.lotSize_ * lots;
+}
+
+OrderType OrderFlowGenerator::PickType(const std::array<double, 5>& cumulative)
+{
+    const auto value = NextUniform();
+    const auto found = std::upper_bound(cumulative.begin(), cumulative.end(), value);
+    return static_cast<OrderType>(std::min<std::ptrdiff_t>(found - cumulative.begin(), cumulative.size() - 1));
+}
+
+// 推进到达时间、切换平静期和突发期，并让中间价随机游走
+void OrderFlowGenerator::Advance()
+{
+    const auto rate = burst_ ? options_.burstRate_ : options_.calmRate_;
+    timestamp_ += static_cast<std::uint64_t>(-std::log(1 - NextUniform()) * 1e9 / rate);
+
+    const auto regime = NextUniform();
+    if (burst_ ? regime < options_.burstEndProbability_ : regime < options_.burstStartProbability_)
+        burst_ = !burst_;
+
+    // 中间价保持在能容纳全部价位的范围内
+    if (NextUniform() < options_.midMoveProbability_)
+        midPrice_ = std::max<Price>(midPrice_ + (random_() & 1 ? 1 : -1), static_cast<Price>(options_.maxTicks_) + 1);
+}
+
+std::size_t FormatOrderFlowText(char* out, const OrderbookCommand& command)
+{
+    char* position = out;
+    const std::string_view side = command.side_ == Side::Buy ? "B" : "S";
+    switch (command.type_)
+    {
+        case OrderbookCommandType::Add:
+            position = Append(position, "A ");
+            position = Append(position, side);
+            *position++ = ' ';
+            position = Append(position, ToString(command.orderType_));
+            position = AppendNumber(position, command.price_);
+            position = AppendNumber(position, command.quantity_);
+            position = AppendNumber(position, command.orderId_);
+            break;
+        case OrderbookCommandType::Modify:
+            position = Append(position, "M");
+            position = AppendNumber(position, command.orderId_);
+            *position++ = ' ';
+            position = Append(position, side);
+            position = AppendNumber(position, command.price_);
+            position = AppendNumber(position, command.quantity_);
+            break;
+        case OrderbookCommandType::Cancel:
+            position = Append(position, "C");
+            position = AppendNumber(position, command.orderId_);
+            break;
+        default:
+            throw std::logic_error("Order flow only contains add, modify and cancel commands.");
+    }
+    *position++ = '\n';
+    return static_cast<std::size_t>(position - out);
+}
+
+std::size_t EncodeOrderFlowBinary(char* out, const OrderbookCommand& command)
+{
+    switch (command.type_)
+    {
+        case OrderbookCommandType::Add:
+            if (command.orderType_ == OrderType::Market)
+                return EncodeMarketOrder(out, command.orderId_, command.side_, command.quantity_);
+            return EncodeAddOrder(out, command.orderId_, command.side_, command.orderType_, command.price_, command.quantity_);
+        case OrderbookCommandType::Modify:
+            return EncodeModifyOrder(out, command.orderId_, command.side_, command.price_, command.quantity_);
+        case OrderbookCommandType::Cancel:
+            return EncodeCancelOrder(out, command.orderId_);
+        default:
+            throw std::logic_error("Order flow only contains add, modify and cancel commands.");
+    }
+}
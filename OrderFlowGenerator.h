@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderbookCommand.h"   // 包含批量接口使用的命令定义
+
+// 合成订单流的参数
+struct OrderFlowOptions
+{
+    std::uint64_t seed_{ 1 };                     // 随机种子，相同的参数和种子生成完全相同的订单流
+    Price midPrice_{ 10'000 };                    // 初始中间价
+    std::uint32_t depth_{ 10'000 };               // 目标挂单数
+    std::uint32_t maxTicks_{ 1'000 };             // 挂单离中间价的最大距离
+    double priceTailExponent_{ 1.5 };             // 挂单离中间价距离的幂律指数，越大越集中在最优价附近
+    double cancelRatio_{ 0.9 };                   // 以撤单结束的挂单比例，其余被主动单成交
+    double modifyRatio_{ 0.05 };                  // 改单占全部消息的比例
+    double midMoveProbability_{ 0.002 };          // 每条消息后中间价随机移动一个价位的概率
+    Quantity lotSize_{ 100 };                     // 数量为整手的倍数
+    double calmRate_{ 50'000 };                   // 平静期的平均消息速率（条 / 秒）
+    double burstRate_{ 2'000'000 };               // 突发期的平均消息速率（条 / 秒）
+    double burstStartProbability_{ 0.0005 };      // 平静期每条消息后进入突发期的概率
+    double burstEndProbability_{ 0.002 };         // 突发期每条消息后回到平静期的概率
+    std::array<double, 5> passiveTypeWeights_{ 0.75, 0, 0, 0.25, 0 };   // 挂单的订单类型权重，按 OrderType 的顺序
+    std::array<double, 5> aggressiveTypeWeights_{ 0.2, 0.45, 0.1, 0.05, 0.2 }; // 主动单的订单类型权重，按 OrderType 的顺序
+};
+
+// 各类消息的计数
+struct OrderFlowCounts
+{
+    std::uint64_t passive_{ };      // 挂单
+    std::uint64_t aggressive_{ };   // 主动单（市价单或穿过对手方最优价的限价单）
+    std::uint64_t cancels_{ };
+    std::uint64_t modifies_{ };
+    std::uint64_t filled_{ };       // 被主动单完全成交的挂单
+};
+
+// 合成订单流生成器
+//
+// 模拟生产环境订单流的几个统计特征：
+//   - 挂单离中间价的距离服从幂律（Pareto）分布，集中在最优价附近并带有长尾；中间价随机游走，主动单优先成交
+//     留在中间价另一侧的对手方挂单，买卖最优价因此跟随中间价；
+//   - 大部分挂单最终被撤销（cancelRatio_），主动单的比例按此推出，使挂单数稳定在 depth_ 附近；
+//   - 到达时间是在平静期和突发期之间切换的泊松过程（马尔可夫调制），GetTimestamp 给出每条消息的到达时间；
+//   - 挂单和主动单分别按权重选择订单类型。
+// 生成器按 Orderbook 的规则（价格优先、时间优先，以及 FillAndKill / FillOrKill / 市价单的处理）维护一个影子订单簿，
+// 因此知道哪些挂单已经被成交：撤单和改单只指向仍在簿中的订单，挂单的价格不会越过对手方的最优价，
+// 只有主动单会成交。当日有效订单在收盘时被订单簿清理的情况不模拟，此后针对它们的撤单会被订单簿忽略。
+// 每条消息需要几次随机数、几次哈希表查找和 O(log 价格级别数) 的簿记，可以在进程内直接驱动订单簿。
+class OrderFlowGenerator
+{
+public:
+    explicit OrderFlowGenerator(OrderFlowOptions options = { });
+
+    // 生成下一条消息
+    OrderbookCommand Next();
+    // 填满 commands，返回填充的条数
+    std::size_t Generate(std::span<OrderbookCommand> commands);
+
+    // 最近一条消息的到达时间（自开始起的纳秒数）
+    std::uint64_t GetTimestamp() const { return timestamp_; }
+    Price GetMidPrice() const { return midPrice_; }
+    const OrderFlowCounts& GetCounts() const { return counts_; }
+
+private:
+    // 影子订单簿中的挂单
+    struct RestingOrder
+    {
+        Side side_;
+        Price price_;
+        Quantity quantity_;          // 剩余数量
+        std::uint64_t sequence_;     // 挂入价格队列时的序号，改单后重新挂入的订单序号不同
+        std::size_t index_;          // 在 resting_ 中的位置
+    };
+
+    // 价格队列中的条目：撤单和改单不从队列中删除，序号与 live_ 中的不一致（或订单已不存在）时视为失效
+    struct QueueEntry
+    {
+        OrderId orderId_;
+        std::uint64_t sequence_;
+    };
+
+    struct Level
+    {
+        std::deque<QueueEntry> queue_;
+        Quantity quantity_{ };       // 有效挂单的剩余数量之和
+        std::size_t count_{ };       // 有效挂单数，为 0 时删除该价格级别
+    };
+    using Levels = std::map<Price, Level>;
+
+    // xoshiro256** 随机数发生器：比 std::mt19937_64 快得多，且输出不依赖标准库实现；状态由 SplitMix64 从种子展开
+    class Random
+    {
+    public:
+        explicit Random(std::uint64_t seed)
+        {
+            for (auto& word : state_)
+            {
+                seed += 0x9E3779B97F4A7C15ull;
+                auto value = seed;
+                value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+                value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+                word = value ^ (value >> 31);
+            }
+        }
+
+        std::uint64_t operator()()
+        {
+            const auto result = std::rotl(state_[1] * 5, 7) * 9;
+            const auto shifted = state_[1] << 17;
+            state_[2] ^= state_[0];
+            state_[3] ^= state_[1];
+            state_[1] ^= state_[2];
+            state_[0] ^= state_[3];
+            state_[2] ^= shifted;
+            state_[3] = std::rotl(state_[3], 45);
+            return result;
+        }
+
+    private:
+        std::array<std::uint64_t, 4> state_;
+    };
+
+    OrderbookCommand MakePassive();
+    OrderbookCommand MakeAggressive();
+    OrderbookCommand MakeCancel();
+    OrderbookCommand MakeModify();
+    Price NextTicks();
+    Price PassivePrice(Side side);
+    Price AggressivePrice(Side side);
+    void Submit(OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity);
+    Quantity Match(Side side, Price price, Quantity quantity);
+    Quantity GetCrossingQuantity(Side side, Price price) const;
+    void Rest(OrderId orderId, Side side, Price price, Quantity quantity);
+    void Remove(std::unordered_map<OrderId, RestingOrder>::iterator order);
+    Quantity NextQuantity();
+    OrderType PickType(const std::array<double, 5>& cumulative);
+    Side NextSide() { return random_() & 1 ? Side::Buy : Side::Sell; }
+    // [0, size) 上的均匀分布，用乘法代替取模
+    std::size_t NextIndex(std::size_t size) { return static_cast<std::size_t>((random_() >> 32) * size >> 32); }
+    // [0, 1) 上的均匀分布，取 53 位随机数
+    double NextUniform() { return static_cast<double>(random_() >> 11) * 0x1.0p-53; }
+    void Advance();
+
+    OrderFlowOptions options_;
+    Random random_;
+    std::array<double, 5> passiveTypes_{ };       // 挂单订单类型的累积概率
+    std::array<double, 5> aggressiveTypes_{ };    // 主动单订单类型的累积概率
+    std::vector<double> tail_;                    // 挂单距离的尾概率表
+    double aggressiveShare_;                      // 新订单中主动单的比例
+    std::vector<OrderId> resting_;                // 影子订单簿中的挂单，用于随机选择撤单和改单的目标
+    std::unordered_map<OrderId, RestingOrder> live_;
+    Levels bids_;
+    Levels asks_;
+    std::uint64_t sequence_{ };
+    OrderId nextOrderId_{ 1 };
+    Price midPrice_;
+    bool burst_{ false };
+    std::uint64_t timestamp_{ };
+    OrderFlowCounts counts_;
+};
+
+// 把命令格式化为一行 A / M / C 文本（与 OrderbookTest/TestFiles 的格式一致，包括换行符），返回写入的字节数
+//
+// out 至少需要 OrderFlowMaxTextSize 字节。
+constexpr std::size_t OrderFlowMaxTextSize = 64;
+std::size_t FormatOrderFlowText(char* out, const OrderbookCommand& command);
+
+// 把命令编码为一条二进制订单录入消息（见 BinaryProtocol.h），市价单编码为 MarketOrder，返回写入的字节数
+//
+// out 至少需要 OrderFlowMaxBinarySize 字节。
+constexpr std::size_t OrderFlowMaxBinarySize = 32;
+std::size_t EncodeOrderFlowBinary(char* out, const OrderbookCommand& command);
@@ -0,0 +1,430 @@
+#include "OrderGateway.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Orderbook.h"
+
+namespace
+{
+    constexpr std::uint64_t ListenerId = 0;                // 监听套接字在 epoll 中的标识
+    constexpr std::size_t OutputChunkSize = 64 * 1024;      // 输出块大小
+    constexpr int MaxIovecs = 64;                           // 一次 sendmsg 最多发送的块数
+}
+
+OrderGateway::OrderGateway(Orderbook& orderbook, OrderGatewayOptions options)
+    : router_{ orderbook }
+    , options_{ std::move(options) }
+    , events_{ std::make_unique<epoll_event[]>(options_.maxEvents_) }
+{
+    listener_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener_ < 0)
+        throw std::runtime_error("Unable to create gateway socket.");
+
+    const int reuse = 1;
+    setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{ };
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options_.port_);
+    if (inet_pton(AF_INET, options_.address_.c_str(), &address.sin_addr) != 1 ||
+        bind(listener_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener_, SOMAXCONN) < 0)
+    {
+        close(listener_);
+        throw std::runtime_error("Unable to listen on gateway address.");
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    epoll_ = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{ };
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = ListenerId;
+    if (epoll_ < 0 || epoll_ctl(epoll_, EPOLL_CTL_ADD, listener_, &event) < 0)
+    {
+        if (epoll_ >= 0)
+            close(epoll_);
+        close(listener_);
+        throw std::runtime_error("Unable to create gateway epoll instance.");
+    }
+}
+
+OrderGateway::~OrderGateway()
+{
+    for (const auto& [_, session] : sessions_)
+        close(session.descriptor_);
+    close(epoll_);
+    close(listener_);
+}
+
+std::size_t OrderGateway::Poll(int timeoutMilliseconds)
+{
+    const int count = epoll_wait(epoll_, events_.get(), static_cast<int>(options_.maxEvents_), GetFlushTimeout(timeoutMilliseconds));
+    if (count < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+        throw std::runtime_error("Gateway epoll_wait failed.");
+    }
+
+    const auto firstMessage = router_.GetMessageCount();
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& event = events_[i];
+        if (event.data.u64 == ListenerId)
+        {
+            Accept();
+            continue;
+        }
+
+        const auto session = sessions_.find(event.data.u64);
+        if (session == sessions_.end())
+            continue;
+
+        if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            ReadSession(session->first, session->second);
+
+        // 套接字重新可写：继续发送上次没有发完的数据
+        if ((event.events & EPOLLOUT) && !session->second.output_.empty() && !session->second.pendingFlush_)
+        {
+            session->second.pendingFlush_ = true;
+            pendingFlush_.push_back(session->first);
+        }
+    }
+
+    // 本轮所有会话的命令合成一批，整批只加锁一次
+    if (router_.GetPendingCommands() > 0 || !router_.GetReports().empty())
+        ProcessBatch();
+
+    FlushPending();
+
+    for (const auto sessionId : closing_)
+        CloseSession(sessionId);
+    closing_.clear();
+
+    return router_.GetMessageCount() - firstMessage;
+}
+
+void OrderGateway::Run(const std::atomic<bool>& stop)
+{
+    while (!stop.load(std::memory_order_acquire))
+        Poll(100);
+}
+
+OrderGatewayStats OrderGateway::GetStats() const
+{
+    return OrderGatewayStats{
+        sessionCount_.load(std::memory_order_relaxed),
+        messages_.load(std::memory_order_relaxed),
+        reads_.load(std::memory_order_relaxed),
+        batches_.load(std::memory_order_relaxed),
+        reports_.load(std::memory_order_relaxed),
+        writes_.load(std::memory_order_relaxed),
+        protocolErrors_.load(std::memory_order_relaxed) };
+}
+
+std::string OrderGateway::GetLastProtocolError() const
+{
+    std::lock_guard lock{ errorMutex_ };
+    return lastProtocolError_;
+}
+
+// 边沿触发：一次接受所有排队的连接
+void OrderGateway::Accept()
+{
+    while (true)
+    {
+        const int descriptor = accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descriptor < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            throw std::runtime_error("Gateway accept failed.");
+        }
+
+        const int noDelay = 1;
+        setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        const auto sessionId = nextSessionId_++;
+        epoll_event event{ };
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = sessionId;
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, descriptor, &event) < 0)
+        {
+            close(descriptor);
+            continue;
+        }
+
+        auto& session = sessions_[sessionId];
+        session.descriptor_ = descriptor;
+        session.input_.resize(options_.readBufferSize_);
+        sessionCount_.store(sessions_.size(), std::memory_order_relaxed);
+    }
+}
+
+// 边沿触发：一直读到 EAGAIN，每次 read 之后解码缓冲区中所有完整的消息
+//
+// 解码之后缓冲区仍然是满的，说明其中的消息比接收缓冲区还长，永远不可能完整，按协议错误关闭会话；
+// 因此每次 read 的长度都大于 0，读到 0 只表示对端关闭。
+void OrderGateway::ReadSession(std::uint64_t sessionId, Session& session)
+{
+    if (session.closing_)
+        return;
+
+    while (true)
+    {
+        const auto received = read(session.descriptor_, session.input_.data() + session.inputSize_, session.input_.size() - session.inputSize_);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                break;
+            return;
+        }
+        if (received == 0)
+            break;
+
+        reads_.fetch_add(1, std::memory_order_relaxed);
+        session.inputSize_ += static_cast<std::size_t>(received);
+
+        std::size_t consumed{ };
+        bool failed{ false };
+        if (options_.protocol_ == OrderGatewayProtocol::Fix)
+        {
+            try
+            {
+                consumed = router_.DecodeFix(sessionId, session.input_.data(), session.inputSize_, session.fix_);
+            }
+            catch (const std::runtime_error& exception)
+            {
+                OnProtocolError(exception.what());
+                failed = true;
+            }
+        }
+        else
+        {
+            const auto result = router_.Decode(sessionId, session.input_.data(), session.inputSize_);
+            consumed = result.consumed_;
+            if (result.error_ != nullptr)
+            {
+                OnProtocolError(result.error_);
+                failed = true;
+            }
+        }
+        messages_.store(router_.GetMessageCount(), std::memory_order_relaxed);
+        if (failed)
+            break;  // 协议错误：关闭会话
+
+        // 将不完整的消息移动到缓冲区开头
+        std::memmove(session.input_.data(), session.input_.data() + consumed, session.inputSize_ - consumed);
+        session.inputSize_ -= consumed;
+        if (session.inputSize_ == session.input_.size())
+        {
+            OnProtocolError("Message is larger than the gateway receive buffer.");
+            break;
+        }
+    }
+
+    // 对端关闭、读取错误或协议错误
+    session.closing_ = true;
+    closing_.push_back(sessionId);
+}
+
+// 执行本轮的命令批次，把所有回报分发到各会话的输出块
+void OrderGateway::ProcessBatch()
+{
+    if (router_.Execute() > 0)
+        batches_.fetch_add(1, std::memory_order_relaxed);
+    roundTime_ = std::chrono::steady_clock::now();
+
+    if (options_.protocol_ == OrderGatewayProtocol::Fix && !router_.GetReports().empty())
+        FormatFixTimestamp(sendingTime_, std::chrono::system_clock::now());
+
+    for (const auto& report : router_.GetReports())
+        Report(report);
+    router_.ClearReports();
+}
+
+// 把一条执行回报追加到会话的最后一个输出块中
+void OrderGateway::Report(const SessionReport& report)
+{
+    const auto found = sessions_.find(report.sessionId_);
+    if (found == sessions_.end() || found->second.closing_)
+        return;  // 会话已经断开
+
+    auto& session = found->second;
+    const auto maxSize = options_.protocol_ == OrderGatewayProtocol::Fix ? Fix::MaxExecutionReportSize : sizeof(ExecutionReportMessage);
+    if (session.output_.empty() || OutputChunkSize - session.output_.back().end_ < maxSize)
+    {
+        if (freeChunks_.empty())
+            session.output_.push_back(OutputChunk{ std::make_unique<char[]>(OutputChunkSize) });
+        else
+        {
+            session.output_.push_back(std::move(freeChunks_.back()));
+            freeChunks_.pop_back();
+        }
+    }
+
+    // 第一条未发送的回报决定发送期限
+    if (session.outputSize_ == 0)
+        session.flushDeadline_ = roundTime_ + options_.flushInterval_;
+
+    auto& chunk = session.output_.back();
+    const auto begin = chunk.end_;
+    if (options_.protocol_ == OrderGatewayProtocol::Fix)
+        chunk.end_ += EncodeFixExecutionReport(chunk.data_.get() + chunk.end_, session.fix_, sendingTime_, options_.symbol_, report.report_, report.fix_);
+    else
+    {
+        std::memcpy(chunk.data_.get() + chunk.end_, &report.report_, sizeof(report.report_));
+        chunk.end_ += sizeof(report.report_);
+    }
+    session.outputSize_ += chunk.end_ - begin;
+    reports_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!session.pendingFlush_)
+    {
+        session.pendingFlush_ = true;
+        pendingFlush_.push_back(report.sessionId_);
+    }
+}
+
+// 用一次 sendmsg（与 writev 相同的分散写）发出会话所有待发送的输出块；内核缓冲区已满时等待 EPOLLOUT
+//
+// MSG_NOSIGNAL：对端已经重置连接时返回 EPIPE 而不是产生 SIGPIPE，网关不依赖宿主进程忽略该信号。
+void OrderGateway::FlushSession(std::uint64_t sessionId, Session& session)
+{
+    iovec vectors[MaxIovecs];
+    while (!session.output_.empty())
+    {
+        int count{ };
+        for (auto chunk = session.output_.begin(); chunk != session.output_.end() && count < MaxIovecs; ++chunk, ++count)
+            vectors[count] = iovec{ chunk->data_.get() + chunk->begin_, chunk->end_ - chunk->begin_ };
+
+        msghdr message{ };
+        message.msg_iov = vectors;
+        message.msg_iovlen = static_cast<std::size_t>(count);
+        const auto written = sendmsg(session.descriptor_, &message, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EPIPE || errno == ECONNRESET)
+            {
+                // 对端已经断开：本轮结束后关闭会话
+                if (!session.closing_)
+                {
+                    session.closing_ = true;
+                    closing_.push_back(sessionId);
+                }
+            }
+            return;  // EAGAIN：等待 EPOLLOUT；其他错误由读取路径发现并关闭会话
+        }
+        writes_.fetch_add(1, std::memory_order_relaxed);
+
+        // 释放已经完整发出的块
+        auto remaining = static_cast<std::size_t>(written);
+        session.outputSize_ -= remaining;
+        while (remaining > 0)
+        {
+            auto& chunk = session.output_.front();
+            const auto sent = std::min(remaining, chunk.end_ - chunk.begin_);
+            chunk.begin_ += sent;
+            remaining -= sent;
+            if (chunk.begin_ == chunk.end_)
+            {
+                chunk.begin_ = chunk.end_ = 0;
+                freeChunks_.push_back(std::move(chunk));
+                session.output_.pop_front();
+            }
+        }
+    }
+}
+
+// 发送达到大小或时间阈值的会话，其余会话留在待发送列表中等到之后的轮次
+void OrderGateway::FlushPending()
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::size_t kept{ };
+    for (const auto sessionId : pendingFlush_)
+    {
+        const auto session = sessions_.find(sessionId);
+        if (session == sessions_.end())
+            continue;
+
+        if (session->second.outputSize_ < options_.flushBytes_ && now < session->second.flushDeadline_)
+        {
+            pendingFlush_[kept++] = sessionId;
+            continue;
+        }
+
+        session->second.pendingFlush_ = false;
+        FlushSession(sessionId, session->second);
+    }
+    pendingFlush_.resize(kept);
+}
+
+// 有延迟发送的回报时，epoll_wait 的超时不超过最近的发送期限
+int OrderGateway::GetFlushTimeout(int timeoutMilliseconds) const
+{
+    if (pendingFlush_.empty())
+        return timeoutMilliseconds;
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (const auto sessionId : pendingFlush_)
+    {
+        const auto session = sessions_.find(sessionId);
+        if (session != sessions_.end())
+            deadline = std::min(deadline, session->second.flushDeadline_);
+    }
+
+    if (deadline == std::chrono::steady_clock::time_point::max())
+        return timeoutMilliseconds;
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0)
+        return 0;
+    return timeoutMilliseconds < 0 ? static_cast<int>(remaining) : static_cast<int>(std::min<std::int64_t>(remaining, timeoutMilliseconds));
+}
+
+// 协议错误：记录原因并计数，调用方随后关闭会话
+void OrderGateway::OnProtocolError(const char* error)
+{
+    protocolErrors_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard lock{ errorMutex_ };
+    lastProtocolError_ = error;
+}
+
+void OrderGateway::CloseSession(std::uint64_t sessionId)
+{
+    const auto session = sessions_.find(sessionId);
+    if (session == sessions_.end())
+        return;
+
+    // 会话的挂单保留在订单簿中，之后的成交回报会被丢弃
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, session->second.descriptor_, nullptr);
+    close(session->second.descriptor_);
+    sessions_.erase(session);
+    sessionCount_.store(sessions_.size(), std::memory_order_relaxed);
+}
+
+#endif
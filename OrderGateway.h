@@ -0,0 +1,143 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderSessionRouter.h" // 包含会话订单路由
+
+struct epoll_event;
+
+// 会话使用的订单录入协议
+enum class OrderGatewayProtocol
+{
+    Binary,   // 二进制协议（见 BinaryProtocol.h）
+    Fix,      // FIX 4.4 tag=value（见 FixProtocol.h）
+};
+
+// 网关的配置
+struct OrderGatewayOptions
+{
+    std::string address_{ "127.0.0.1" };      // 监听地址
+    std::uint16_t port_{ 0 };                 // 监听端口，0 表示由系统分配
+    std::size_t readBufferSize_{ 64 * 1024 }; // 每个会话的接收缓冲区大小，一次 read 最多读入这么多字节；更长的消息是协议错误
+    std::size_t maxEvents_{ 64 };             // 一次 epoll_wait 最多处理的事件数
+    OrderGatewayProtocol protocol_{ OrderGatewayProtocol::Binary };   // 所有会话使用的协议
+    std::string symbol_;                      // FIX 执行回报中的 Symbol (55)，为空时省略
+    std::size_t flushBytes_{ 64 * 1024 };     // 会话待发送的回报达到这么多字节时立即发送
+    std::chrono::microseconds flushInterval_{ 0 };   // 回报最多延迟这么久发送，0 表示每轮结束时都发送
+};
+
+// 网关的统计信息，messages_ / reads_ 与 reports_ / writes_ 反映批量化的程度
+struct OrderGatewayStats
+{
+    std::uint64_t sessions_;   // 当前会话数
+    std::uint64_t messages_;   // 收到的订单消息数
+    std::uint64_t reads_;      // 读到数据的 read 调用次数
+    std::uint64_t batches_;    // 提交给订单簿的批次数
+    std::uint64_t reports_;    // 生成的执行回报数
+    std::uint64_t writes_;     // 发送回报的 sendmsg 调用次数
+    std::uint64_t protocolErrors_;   // 因协议错误（包括超过接收缓冲区的消息）关闭的会话数
+};
+
+// TCP 订单网关
+//
+// 单线程事件循环：监听套接字和所有会话都以边沿触发方式注册到 epoll。
+// 每轮事件中，每个可读会话都会被读到 EAGAIN，一次 read 通常带回多条消息；
+// 本轮所有会话解码出的命令合成一批，通过 Orderbook::ProcessCommands 只加锁一次执行。
+// 执行回报先追加到各会话的输出块中，本轮结束时每个会话用一次 sendmsg（分散写，与 writev 相同）发出所有待发送的块。
+// flushInterval_ 非零时，回报可以跨越多轮累积：会话的待发送数据达到 flushBytes_，或最早的一条回报已等待 flushInterval_ 时才发送，
+// 使 sendmsg 的次数随突发次数而不是成交数增长；等待期间 epoll_wait 的超时不会超过最近的发送期限（毫秒精度）。
+//
+// 订单归属、撤单改单权限和剩余数量由 OrderSessionRouter 维护。
+// 使用 FIX 时，回报在输出块中就地编码为 ExecutionReport，同一轮的回报共用一个 SendingTime。
+class OrderGateway
+{
+public:
+    OrderGateway(Orderbook& orderbook, OrderGatewayOptions options = { });
+    OrderGateway(const OrderGateway&) = delete;
+    void operator=(const OrderGateway&) = delete;
+    ~OrderGateway();
+
+    // 实际监听的端口
+    std::uint16_t GetPort() const { return port_; }
+
+    // 等待并处理一轮事件，返回处理的订单消息数
+    std::size_t Poll(int timeoutMilliseconds);
+    // 持续处理事件，直到 stop 被置为 true
+    void Run(const std::atomic<bool>& stop);
+
+    // 获取统计信息，可以在其他线程调用
+    OrderGatewayStats GetStats() const;
+    // 最近一次因协议错误关闭会话的原因，没有时为空；可以在其他线程调用
+    std::string GetLastProtocolError() const;
+
+private:
+    // 输出块：会话的待发送数据由若干个定长块组成，sendmsg 一次发出
+    struct OutputChunk
+    {
+        std::unique_ptr<char[]> data_;
+        std::size_t begin_{ };                 // 尚未发送部分的起始位置
+        std::size_t end_{ };                   // 已写入数据的结束位置
+    };
+
+    struct Session
+    {
+        int descriptor_{ -1 };
+        std::vector<char> input_;              // 接收缓冲区
+        std::size_t inputSize_{ };             // 接收缓冲区中尚未解码的字节数
+        std::deque<OutputChunk> output_;       // 待发送的输出块
+        std::size_t outputSize_{ };            // 输出块中尚未发送的字节数
+        std::chrono::steady_clock::time_point flushDeadline_;   // 最早一条未发送回报的发送期限
+        FixSession fix_;                       // FIX 会话状态（仅 FIX）
+        bool pendingFlush_{ false };           // 是否已经在本轮的待刷新列表中
+        bool closing_{ false };                // 本轮结束后关闭
+    };
+
+    void Accept();
+    void ReadSession(std::uint64_t sessionId, Session& session);
+    void ProcessBatch();
+    void Report(const SessionReport& report);
+    void FlushSession(std::uint64_t sessionId, Session& session);
+    void FlushPending();
+    int GetFlushTimeout(int timeoutMilliseconds) const;
+    void CloseSession(std::uint64_t sessionId);
+    void OnProtocolError(const char* error);
+
+    OrderSessionRouter router_;
+    OrderGatewayOptions options_;
+    int listener_{ -1 };
+    int epoll_{ -1 };
+    std::uint16_t port_{ };
+
+    std::uint64_t nextSessionId_{ 1 };                      // 0 保留给监听套接字
+    std::unordered_map<std::uint64_t, Session> sessions_;
+
+    std::unique_ptr<epoll_event[]> events_;
+    std::vector<std::uint64_t> pendingFlush_;               // 有待发送数据的会话
+    std::vector<std::uint64_t> closing_;                    // 本轮结束后关闭的会话
+    std::vector<OutputChunk> freeChunks_;                   // 可重用的输出块
+    char sendingTime_[Fix::TimestampSize]{ };              // 本轮 FIX 回报的 SendingTime
+    std::chrono::steady_clock::time_point roundTime_;      // 本轮批次的执行时间
+
+    std::atomic<std::uint64_t> sessionCount_{ };
+    std::atomic<std::uint64_t> messages_{ };
+    std::atomic<std::uint64_t> reads_{ };
+    std::atomic<std::uint64_t> batches_{ };
+    std::atomic<std::uint64_t> reports_{ };
+    std::atomic<std::uint64_t> writes_{ };
+    std::atomic<std::uint64_t> protocolErrors_{ };
+
+    mutable std::mutex errorMutex_;                         // 保护 lastProtocolError_
+    std::string lastProtocolError_;
+};
+
+#endif
@@ -0,0 +1,262 @@
+#include "OrderSessionRouter.h"
+
+#include <algorithm>
+
+#include "Orderbook.h"
+
+// 把解码出的消息转交给路由器
+class OrderSessionRouter::MessageHandler
+{
+public:
+    MessageHandler(OrderSessionRouter& router, std::uint64_t sessionId)
+        : router_{ router }
+        , sessionId_{ sessionId }
+    { }
+
+    void OnAddOrder(const AddOrderMessage& message)
+    {
+        router_.Add(sessionId_, message.orderId_, ToSide(message.side_), ToOrderType(message.orderType_), message.price_, message.quantity_);
+    }
+
+    void OnMarketOrder(const MarketOrderMessage& message)
+    {
+        router_.Add(sessionId_, message.orderId_, ToSide(message.side_), OrderType::Market, Constants::InvalidPrice, message.quantity_);
+    }
+
+    void OnCancelOrder(const CancelOrderMessage& message)
+    {
+        // 二进制撤单消息不带方向，只在拒绝未知订单时用到
+        router_.Cancel(sessionId_, message.orderId_, Side::Buy);
+    }
+
+    void OnModifyOrder(const ModifyOrderMessage& message)
+    {
+        router_.Modify(sessionId_, message.orderId_, ToSide(message.side_), message.price_, message.quantity_);
+    }
+
+private:
+    OrderSessionRouter& router_;
+    std::uint64_t sessionId_;
+};
+
+// 把解码出的 FIX 消息转交给路由器；改单和撤单以 OrigClOrdID 标识订单
+class OrderSessionRouter::FixMessageHandler
+{
+public:
+    FixMessageHandler(OrderSessionRouter& router, std::uint64_t sessionId)
+        : router_{ router }
+        , sessionId_{ sessionId }
+    { }
+
+    void OnNewOrderSingle(const FixOrderMessage& message)
+    {
+        router_.Add(sessionId_, message.clOrdId_, message.side_, message.orderType_, message.price_, message.quantity_);
+    }
+
+    void OnOrderCancelRequest(const FixOrderMessage& message)
+    {
+        router_.Cancel(sessionId_, message.origClOrdId_, message.side_);
+    }
+
+    void OnOrderCancelReplaceRequest(const FixOrderMessage& message)
+    {
+        router_.Modify(sessionId_, message.origClOrdId_, message.side_, message.price_, message.quantity_);
+    }
+
+private:
+    OrderSessionRouter& router_;
+    std::uint64_t sessionId_;
+};
+
+OrderSessionRouter::OrderSessionRouter(Orderbook& orderbook)
+    : orderbook_{ orderbook }
+    , prunedOrders_{ orderbook.GetStats().prunedOrders_ }
+{ }
+
+BinaryDecodeResult OrderSessionRouter::Decode(std::uint64_t sessionId, const char* data, std::size_t size)
+{
+    return DecodeBinaryMessages(data, size, MessageHandler{ *this, sessionId });
+}
+
+std::size_t OrderSessionRouter::DecodeFix(std::uint64_t sessionId, const char* data, std::size_t size, FixSession& session)
+{
+    return DecodeFixMessages(data, size, session, FixMessageHandler{ *this, sessionId });
+}
+
+std::size_t OrderSessionRouter::Execute()
+{
+    ReportPrunedOrders();
+    if (commands_.empty())
+        return 0;
+
+    trades_.clear();
+    results_.resize(commands_.size());
+    orderbook_.ProcessCommands(commands_, trades_, results_);
+
+    std::size_t tradeIndex{ };
+    for (std::size_t index = 0; index < commands_.size(); ++index)
+    {
+        const auto& command = commands_[index];
+        const auto& result = results_[index];
+        const auto sessionId = commandSessions_[index];
+
+        switch (command.type_)
+        {
+            case OrderbookCommandType::Add:
+                // ID 已被不经路由器的订单占用，订单簿忽略了这条命令
+                if (result.found_)
+                {
+                    Report(sessionId, command.orderId_, command.side_, ExecutionType::Rejected, command.price_, command.quantity_, 0);
+                    orders_.erase(command.orderId_);
+                    continue;
+                }
+                break;
+            case OrderbookCommandType::Cancel:
+                // 订单已在本批次中全部成交，撤单失败；否则由下面的检查回报 Cancelled
+                if (!orders_.contains(command.orderId_))
+                    Report(sessionId, command.orderId_, command.side_, ExecutionType::Rejected, 0, 0, 0);
+                break;
+            case OrderbookCommandType::Modify:
+            {
+                const auto state = orders_.find(command.orderId_);
+                if (result.found_ && state != orders_.end())
+                {
+                    state->second.side_ = command.side_;
+                    state->second.leavesQuantity_ = command.quantity_;
+                    Report(state->second, command.orderId_, ExecutionType::Accepted, command.price_, command.quantity_, command.quantity_);
+                }
+                else
+                    Report(sessionId, command.orderId_, command.side_, ExecutionType::Rejected, command.price_, command.quantity_, 0);
+                break;
+            }
+            default:
+                break;
+        }
+
+        for (; tradeIndex < result.tradeEnd_; ++tradeIndex)
+        {
+            ReportFill(trades_[tradeIndex].GetBidTrade());
+            ReportFill(trades_[tradeIndex].GetAskTrade());
+        }
+
+        // 订单在命令执行后不在簿中：被撤销，或者剩余部分被订单簿丢弃
+        const auto state = orders_.find(command.orderId_);
+        if (state != orders_.end() && result.remainingQuantity_ == 0)
+        {
+            Report(state->second, command.orderId_, ExecutionType::Cancelled, 0, state->second.leavesQuantity_, 0);
+            orders_.erase(state);
+        }
+    }
+
+    const auto executed = commands_.size();
+    commands_.clear();
+    commandSessions_.clear();
+    return executed;
+}
+
+void OrderSessionRouter::Add(std::uint64_t sessionId, OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity)
+{
+    ++messages_;
+
+    // 订单 ID 在所有会话之间必须唯一
+    if (orders_.contains(orderId))
+    {
+        Report(sessionId, orderId, side, ExecutionType::Rejected, price, quantity, 0);
+        return;
+    }
+
+    const auto& state = orders_.emplace(orderId, OrderState{ sessionId, orderType, side, quantity, 0, 0 }).first->second;
+    Report(state, orderId, ExecutionType::Accepted, price, quantity, quantity);
+    commands_.push_back(OrderbookCommand{ OrderbookCommandType::Add, orderType, side, price, quantity, orderId });
+    commandSessions_.push_back(sessionId);
+}
+
+// 撤单和改单在解码时只检查归属，回报和状态的更新在 Execute 中根据订单簿的处理结果进行
+void OrderSessionRouter::Cancel(std::uint64_t sessionId, OrderId orderId, Side side)
+{
+    ++messages_;
+
+    const auto state = orders_.find(orderId);
+    if (state == orders_.end() || state->second.sessionId_ != sessionId)
+    {
+        Report(sessionId, orderId, side, ExecutionType::Rejected, 0, 0, 0);
+        return;
+    }
+
+    // 命令带上订单的方向，订单在本批次中全部成交而撤单失败时用于回报
+    commands_.push_back(OrderbookCommand{ OrderbookCommandType::Cancel, OrderType::GoodTillCancel, state->second.side_, 0, 0, orderId });
+    commandSessions_.push_back(sessionId);
+}
+
+void OrderSessionRouter::Modify(std::uint64_t sessionId, OrderId orderId, Side side, Price price, Quantity quantity)
+{
+    ++messages_;
+
+    const auto state = orders_.find(orderId);
+    if (state == orders_.end() || state->second.sessionId_ != sessionId)
+    {
+        Report(sessionId, orderId, side, ExecutionType::Rejected, price, quantity, 0);
+        return;
+    }
+
+    commands_.push_back(OrderbookCommand{ OrderbookCommandType::Modify, state->second.orderType_, side, price, quantity, orderId });
+    commandSessions_.push_back(sessionId);
+}
+
+void OrderSessionRouter::Report(std::uint64_t sessionId, OrderId orderId, Side side, ExecutionType executionType, Price price, Quantity quantity, Quantity leavesQuantity)
+{
+    auto& report = reports_.emplace_back();
+    report.sessionId_ = sessionId;
+    report.fix_ = FixExecutionFields{ side, 0, 0 };
+    EncodeExecutionReport(reinterpret_cast<char*>(&report.report_), orderId, executionType, price, quantity, leavesQuantity);
+}
+
+void OrderSessionRouter::Report(const OrderState& state, OrderId orderId, ExecutionType executionType, Price price, Quantity quantity, Quantity leavesQuantity)
+{
+    auto& report = reports_.emplace_back();
+    report.sessionId_ = state.sessionId_;
+    report.fix_ = FixExecutionFields{ state.side_, state.cumQuantity_,
+        state.cumQuantity_ == 0 ? 0 : static_cast<double>(state.filledValue_) / static_cast<double>(state.cumQuantity_) };
+    EncodeExecutionReport(reinterpret_cast<char*>(&report.report_), orderId, executionType, price, quantity, leavesQuantity);
+}
+
+void OrderSessionRouter::ReportFill(const TradeInfo& trade)
+{
+    const auto state = orders_.find(trade.orderId_);
+    if (state == orders_.end())
+        return;
+
+    auto& leavesQuantity = state->second.leavesQuantity_;
+    leavesQuantity -= std::min(leavesQuantity, trade.quantity_);
+    state->second.cumQuantity_ += trade.quantity_;
+    state->second.filledValue_ += static_cast<std::int64_t>(trade.price_) * trade.quantity_;
+    Report(state->second, trade.orderId_, ExecutionType::Filled, trade.price_, trade.quantity_, leavesQuantity);
+    if (leavesQuantity == 0)
+        orders_.erase(state);
+}
+
+// 订单簿在两次 Execute 之间做过每日清理时，检查路由器跟踪的 GoodForDay 订单是否还在簿中
+void OrderSessionRouter::ReportPrunedOrders()
+{
+    const auto prunedOrders = orderbook_.GetStats().prunedOrders_;
+    if (prunedOrders == prunedOrders_)
+        return;
+    prunedOrders_ = prunedOrders;
+
+    std::vector<OrderId> orderIds;
+    for (const auto& [orderId, state] : orders_)
+        if (state.orderType_ == OrderType::GoodForDay)
+            orderIds.push_back(orderId);
+
+    std::vector<Quantity> quantities(orderIds.size());
+    orderbook_.GetRemainingQuantities(orderIds, quantities);
+    for (std::size_t index = 0; index < orderIds.size(); ++index)
+    {
+        if (quantities[index] > 0)
+            continue;
+
+        const auto state = orders_.find(orderIds[index]);
+        Report(state->second, orderIds[index], ExecutionType::Cancelled, 0, state->second.leavesQuantity_, 0);
+        orders_.erase(state);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "BinaryProtocol.h"     // 包含二进制订单录入协议与执行回报
+#include "FixProtocol.h"        // 包含 FIX 订单录入的解码
+#include "OrderbookCommand.h"   // 包含批量接口使用的命令定义
+
+// 发给某个会话的一条执行回报
+struct SessionReport
+{
+    std::uint64_t sessionId_;          // 接收回报的会话
+    ExecutionReportMessage report_;    // 已编码的回报消息
+    FixExecutionFields fix_;           // 订单的方向和累计成交（仅 FIX 回报使用）
+};
+
+using SessionReports = std::vector<SessionReport>;
+
+// 会话订单路由：各个传输层（TCP 网关、共享内存通道）共用的会话状态
+//
+// 传输层把各会话收到的二进制消息交给 Decode（FIX 消息交给 DecodeFix），路由器把它们转换为一批命令并立即生成新订单的受理回报；
+// Execute 把整批命令一次提交给订单簿，再按命令顺序、根据订单簿对每条命令的实际处理生成撤单和改单的回报以及双方的成交回报。
+// 订单归属于添加它的会话，撤单和改单只能由所属会话发起，不属于该会话的订单在解码时即被拒绝；
+// 撤单或改单之前订单已在同一批次中全部成交时被拒绝。路由器跟踪每个订单的剩余数量，
+// 订单在命令执行后不在簿中（FillAndKill / FillOrKill 的剩余部分、没有对手方的市价单）时补发一条 Cancelled 回报；
+// 订单簿每日清理 GoodForDay 订单后，下一次 Execute 为被清理的订单补发 Cancelled 回报（即使当前批次为空）。
+// 回报按产生顺序放在 GetReports 中，由传输层发送后调用 ClearReports。
+class OrderSessionRouter
+{
+public:
+    explicit OrderSessionRouter(Orderbook& orderbook);
+    OrderSessionRouter(const OrderSessionRouter&) = delete;
+    void operator=(const OrderSessionRouter&) = delete;
+
+    // 解码 sessionId 会话的缓冲区中所有完整的消息并加入当前批次；遇到协议错误时停止，错误之前的消息已经加入批次
+    BinaryDecodeResult Decode(std::uint64_t sessionId, const char* data, std::size_t size);
+    // 同 Decode，但缓冲区中是 FIX 消息；session 为该会话的 FIX 状态，回报仍以二进制执行回报的形式放在 GetReports 中
+    std::size_t DecodeFix(std::uint64_t sessionId, const char* data, std::size_t size, FixSession& session);
+    // 执行当前批次，返回执行的命令数
+    std::size_t Execute();
+
+    // 当前批次中尚未执行的命令数
+    std::size_t GetPendingCommands() const { return commands_.size(); }
+    // 累计解码的消息数
+    std::uint64_t GetMessageCount() const { return messages_; }
+
+    const SessionReports& GetReports() const { return reports_; }
+    void ClearReports() { reports_.clear(); }
+
+private:
+    // 路由器跟踪的订单状态
+    struct OrderState
+    {
+        std::uint64_t sessionId_;              // 所属会话
+        OrderType orderType_;                  // 订单类型
+        Side side_;                            // 买卖方向
+        Quantity leavesQuantity_;              // 剩余数量
+        Quantity cumQuantity_;                 // 累计成交数量，改单后保留
+        std::int64_t filledValue_;             // 累计成交金额（价格 × 数量），用于计算平均成交价
+    };
+
+    class MessageHandler;
+    class FixMessageHandler;
+
+    void Add(std::uint64_t sessionId, OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity);
+    void Cancel(std::uint64_t sessionId, OrderId orderId, Side side);
+    void Modify(std::uint64_t sessionId, OrderId orderId, Side side, Price price, Quantity quantity);
+    // 路由器没有跟踪（或不再跟踪）的订单：没有累计成交
+    void Report(std::uint64_t sessionId, OrderId orderId, Side side, ExecutionType executionType, Price price, Quantity quantity, Quantity leavesQuantity);
+    // 路由器跟踪的订单：方向和累计成交取自订单状态
+    void Report(const OrderState& state, OrderId orderId, ExecutionType executionType, Price price, Quantity quantity, Quantity leavesQuantity);
+    void ReportFill(const TradeInfo& trade);
+    void ReportPrunedOrders();
+
+    Orderbook& orderbook_;
+    std::unordered_map<OrderId, OrderState> orders_;
+    OrderbookCommands commands_;                 // 当前批次
+    std::vector<std::uint64_t> commandSessions_; // 当前批次每条命令所属的会话
+    OrderbookCommandResults results_;            // 当前批次每条命令的执行结果
+    Trades trades_;                              // 当前批次的成交
+    SessionReports reports_;                     // 待发送的回报
+    std::uint64_t messages_{ };
+    std::uint64_t prunedOrders_;                 // 上次检查时订单簿累计清理的订单数
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 enum class OrderType
 {
 	GoodTillCancel,
@@ -12,4 +14,18 @@ enum class OrderType
 //FillAndKill (FAK)：立即部分执行，未成交部分会被取消。
 //FillOrKill (FOK)：必须全部立即成交，否则全部取消。
 //GoodForDay (GFD)：当日有效，未完成部分在当天结束时取消。
-//Market：按当前市场价格立即执行。
\ No newline at end of file
+//Market：按当前市场价格立即执行。
+
+// 订单类型的名称，与文本订单文件中的写法一致
+inline std::string_view ToString(OrderType orderType)
+{
+	switch (orderType)
+	{
+		case OrderType::GoodTillCancel: return "GoodTillCancel";
+		case OrderType::FillAndKill: return "FillAndKill";
+		case OrderType::FillOrKill: return "FillOrKill";
+		case OrderType::GoodForDay: return "GoodForDay";
+		case OrderType::Market: return "Market";
+		default: return "Unknown";
+	}
+}
@@ -1,9 +1,56 @@
 
 #include "Orderbook.h"
+#include <algorithm>
 #include <numeric>
+#include <optional>
 #include <chrono>
 #include <ctime>
 
+// 给 ordersMutex_ 加锁；启用 ORDERBOOK_LOCK_STATS 时记录该调用点的等待和持有时间，否则就是 std::scoped_lock
+#ifdef ORDERBOOK_LOCK_STATS
+#define ORDERBOOK_LOCK(site) ProfiledLock ordersLock{ ordersMutex_, lockProfile_[static_cast<std::size_t>(site)] }
+#else
+#define ORDERBOOK_LOCK(site) std::scoped_lock ordersLock{ ordersMutex_ }
+#endif
+
+// 操作延迟统计，未启用 ORDERBOOK_LATENCY_STATS 时全部展开为空
+//   ORDERBOOK_MEASURE_LATENCY：在所在作用域结束时记入对应的直方图；_IF 版本只在条件成立时计时
+//   ORDERBOOK_START_LATENCY_LAPS / ORDERBOOK_LATENCY_LAP：批量接口连续计时，每条命令只读取一次计数器；_SKIP 版本不计入直方图
+#ifdef ORDERBOOK_LATENCY_STATS
+#define ORDERBOOK_MEASURE_LATENCY(operation) const LatencyTimer latencyTimer{ latency_[static_cast<std::size_t>(operation)] }
+#define ORDERBOOK_MEASURE_LATENCY_IF(condition, operation) std::optional<LatencyTimer> latencyTimer; if (condition) latencyTimer.emplace(latency_[static_cast<std::size_t>(operation)])
+#define ORDERBOOK_START_LATENCY_LAPS() LatencyLapTimer latencyLaps
+#define ORDERBOOK_LATENCY_LAP(operation) latencyLaps.Lap(latency_[static_cast<std::size_t>(operation)])
+#define ORDERBOOK_SKIP_LATENCY_LAP() latencyLaps.Skip()
+#else
+#define ORDERBOOK_MEASURE_LATENCY(operation)
+#define ORDERBOOK_MEASURE_LATENCY_IF(condition, operation)
+#define ORDERBOOK_START_LATENCY_LAPS()
+#define ORDERBOOK_LATENCY_LAP(operation)
+#define ORDERBOOK_SKIP_LATENCY_LAP()
+#endif
+
+namespace
+{
+    // splitmix64 混合函数，用于把订单字段打散成均匀分布的哈希值
+    std::uint64_t Mix(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // 单个挂单对校验和的贡献：包含前驱订单 ID，因此同一价格队列内的顺序也会反映在校验和中
+    std::uint64_t OrderHash(const Order& order, OrderId predecessor)
+    {
+        auto hash = Mix(order.GetOrderId());
+        hash = Mix(hash ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(order.GetPrice())) << 1 | static_cast<std::uint64_t>(order.GetSide())));
+        hash = Mix(hash ^ order.GetRemainingQuantity());
+        return Mix(hash ^ predecessor);
+    }
+}
+
 // 清理当日有效订单的函数
 void Orderbook::PruneGoodForDayOrders()
 {
@@ -45,20 +92,9 @@ void Orderbook::PruneGoodForDayOrders()
         OrderIds orderIds;
 
         {
-            // 使用 scoped_lock 锁定订单映射
-            std::scoped_lock ordersLock{ ordersMutex_ };
-
-            // 遍历所有订单，收集 GoodForDay 类型的订单 ID
-            for (const auto& [_, entry] : orders_)
-            {
-                const auto& [order, placeholder] = entry;
-
-                if (order->GetOrderType() != OrderType::GoodForDay)
-                    continue;
-
-                // 如果订单是 GoodForDay 类型，则将其 ID 放入 orderIds 列表中
-                orderIds.push_back(order->GetOrderId());
-            }
+            // 锁定订单映射
+            ORDERBOOK_LOCK(OrderbookLockSite::Prune);
+            orderIds = GetGoodForDayOrderIds();
         }
 
         // 调用取消订单的函数
@@ -66,15 +102,38 @@ void Orderbook::PruneGoodForDayOrders()
     }
 }
 
+// 遍历所有订单，收集 GoodForDay 类型的订单 ID
+OrderIds Orderbook::GetGoodForDayOrderIds() const
+{
+    OrderIds orderIds;
+    for (const auto& [_, entry] : orders_)
+    {
+        const auto& [order, placeholder] = entry;
+
+        if (order->GetOrderType() != OrderType::GoodForDay)
+            continue;
+
+        // 如果订单是 GoodForDay 类型，则将其 ID 放入 orderIds 列表中
+        orderIds.push_back(order->GetOrderId());
+    }
+    return orderIds;
+}
+
 // 批量取消订单
 void Orderbook::CancelOrders(OrderIds orderIds)
 {
-    // 使用 scoped_lock 锁定订单列表
-    std::scoped_lock ordersLock{ ordersMutex_ };
+    // 锁定订单列表
+    ORDERBOOK_LOCK(OrderbookLockSite::CancelOrders);
+    CancelOrdersInternal(orderIds);
+}
 
-    // 遍历订单 ID 列表，依次取消每个订单
+// 遍历订单 ID 列表，依次取消每个订单
+void Orderbook::CancelOrdersInternal(const OrderIds& orderIds)
+{
+    const auto before = orders_.size();
     for (const auto& orderId : orderIds)
         CancelOrderInternal(orderId);
+    counters_.OnPruned(before - orders_.size());
 }
 
 // 内部函数：处理订单取消的具体逻辑
@@ -95,6 +154,7 @@ void Orderbook::CancelOrderInternal(OrderId orderId)
         auto price = order->GetPrice();
         auto& orders = asks_.at(price);
         // 从卖单列表中删除该订单
+        RemoveFromChecksum(orders, iterator);
         orders.erase(iterator);
         // 如果该价格级别的订单为空，删除该价格级别
         if (orders.empty())
@@ -106,6 +166,7 @@ void Orderbook::CancelOrderInternal(OrderId orderId)
         auto price = order->GetPrice();
         auto& orders = bids_.at(price);
         // 从买单列表中删除该订单
+        RemoveFromChecksum(orders, iterator);
         orders.erase(iterator);
         // 如果该价格级别的订单为空，删除该价格级别
         if (orders.empty())
@@ -119,27 +180,30 @@ void Orderbook::CancelOrderInternal(OrderId orderId)
 // 当订单被取消时，更新订单簿数据
 void Orderbook::OnOrderCancelled(OrderPointer order)
 {
-    UpdateLevelData(order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Remove);
+    UpdateLevelData(order->GetSide(), order->GetPrice(), order->GetRemainingQuantity(), LevelData::Action::Remove);
 }
 
 // 当新订单被添加时，更新订单簿数据
 void Orderbook::OnOrderAdded(OrderPointer order)
 {
-    UpdateLevelData(order->GetPrice(), order->GetInitialQuantity(), LevelData::Action::Add);
+    UpdateLevelData(order->GetSide(), order->GetPrice(), order->GetInitialQuantity(), LevelData::Action::Add);
 }
 
 // 当订单被匹配时，更新订单簿数据
-void Orderbook::OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled)
+void Orderbook::OnOrderMatched(Side side, Price price, Quantity quantity, bool isFullyFilled)
 {
     // 如果订单完全成交，则删除该订单的数据；否则只更新数量
-    UpdateLevelData(price, quantity, isFullyFilled ? LevelData::Action::Remove : LevelData::Action::Match);
+    UpdateLevelData(side, price, quantity, isFullyFilled ? LevelData::Action::Remove : LevelData::Action::Match);
 }
 
 // 更新订单簿价格级别的数据
-void Orderbook::UpdateLevelData(Price price, Quantity quantity, LevelData::Action action)
+void Orderbook::UpdateLevelData(Side side, Price price, Quantity quantity, LevelData::Action action)
 {
     // 获取或创建该价格级别的级别数据
-    auto& data = data_[price];
+    auto& levels = side == Side::Buy ? bidData_ : askData_;
+    auto& data = levels[price];
+    if (action == LevelData::Action::Add && data.count_ == 0)
+        counters_.OnLevelCreated(bidData_.size() + askData_.size());
 
     // 根据操作类型更新该价格级别的订单数量和订单数
     data.count_ += action == LevelData::Action::Remove ? -1 : action == LevelData::Action::Add ? 1 : 0;
@@ -152,9 +216,43 @@ void Orderbook::UpdateLevelData(Price price, Quantity quantity, LevelData::Actio
         data.quantity_ += quantity;  // 如果新增订单，增加数量
     }
 
+    // 通知监听者该价格级别的最新状态
+    if (listener_ != nullptr)
+        listener_->OnLevelChanged(side, price, data.quantity_, data.count_);
+
     // 如果该价格级别的订单数为 0，则删除该价格级别
     if (data.count_ == 0)
-        data_.erase(price);
+    {
+        levels.erase(price);
+        counters_.OnLevelDestroyed();
+    }
+}
+
+// 在校验和中加入一个挂单
+void Orderbook::AddToChecksum(const Order& order, OrderId predecessor)
+{
+    checksum_ += OrderHash(order, predecessor);
+}
+
+// 从校验和中移除一个挂单
+void Orderbook::RemoveFromChecksum(const Order& order, OrderId predecessor)
+{
+    checksum_ -= OrderHash(order, predecessor);
+}
+
+// 从校验和中移除队列中的一个订单，并更新其后继订单的前驱
+void Orderbook::RemoveFromChecksum(const OrderPointers& orders, OrderPointers::iterator iterator)
+{
+    const auto& order = **iterator;
+    const OrderId predecessor = iterator == orders.begin() ? 0 : (*std::prev(iterator))->GetOrderId();
+    RemoveFromChecksum(order, predecessor);
+
+    const auto next = std::next(iterator);
+    if (next != orders.end())
+    {
+        RemoveFromChecksum(**next, order.GetOrderId());
+        AddToChecksum(**next, predecessor);
+    }
 }
 
 // 判断是否可以完全匹配某个订单
@@ -164,31 +262,11 @@ bool Orderbook::CanFullyFill(Side side, Price price, Quantity quantity) const
     if (!CanMatch(side, price))
         return false;
 
-    std::optional<Price> threshold;
-
-    // 如果是买单，获取最佳卖价作为匹配的阈值
-    if (side == Side::Buy)
-    {
-        const auto [askPrice, _] = *asks_.begin();
-        threshold = askPrice;
-    }
-    else
-    {
-        // 如果是卖单，获取最佳买价作为匹配的阈值
-        const auto [bidPrice, _] = *bids_.begin();
-        threshold = bidPrice;
-    }
-
-    // 遍历订单簿，检查是否可以完全成交
-    for (const auto& [levelPrice, levelData] : data_)
+    // 遍历对手方的价格级别，检查是否可以完全成交
+    const auto& levels = side == Side::Buy ? askData_ : bidData_;
+    for (const auto& [levelPrice, levelData] : levels)
     {
-        // 如果当前级别的价格不满足匹配条件，则跳过
-        //这里比对手方最佳还好的价格是与自己同一边的价格故舍弃
-        if (threshold.has_value() &&
-            (side == Side::Buy && threshold.value() > levelPrice) ||
-            (side == Side::Sell && threshold.value() < levelPrice))
-            continue;
-        //这里是不满足下单条件的价格
+        // 跳过不满足下单条件的价格
         if ((side == Side::Buy && levelPrice > price) ||
             (side == Side::Sell && levelPrice < price))
             continue;
@@ -228,11 +306,11 @@ bool Orderbook::CanMatch(Side side, Price price) const
     }
 }
 
-// 匹配买单和卖单，并生成交易记录
-Trades Orderbook::MatchOrders()
+// 匹配买单和卖单，成交记录追加到 trades
+void Orderbook::MatchOrders(Trades& trades)
 {
-    Trades trades;  // 存储匹配结果的交易记录
-    trades.reserve(orders_.size());  // 预留空间
+    // 没有交叉时不计时，Match 只统计真正发生撮合的过程
+    ORDERBOOK_MEASURE_LATENCY_IF(!bids_.empty() && !asks_.empty() && bids_.begin()->first >= asks_.begin()->first, OrderbookOperation::Match);
 
     while (true)
     {
@@ -257,57 +335,71 @@ Trades Orderbook::MatchOrders()
             // 计算可以成交的数量
             Quantity quantity = std::min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
 
-            // 更新买单和卖单的成交数量
+            // 更新买单和卖单的成交数量（两者均为队首，前驱为 0）
+            RemoveFromChecksum(*bid, 0);
+            RemoveFromChecksum(*ask, 0);
             bid->Fill(quantity);
             ask->Fill(quantity);
 
-            // 如果买单已完全成交，从列表中删除该买单
+            // 如果买单已完全成交，从列表中删除该买单，新的队首不再有前驱
             if (bid->IsFilled())
             {
                 bids.pop_front();
                 orders_.erase(bid->GetOrderId());
+                if (!bids.empty())
+                {
+                    RemoveFromChecksum(*bids.front(), bid->GetOrderId());
+                    AddToChecksum(*bids.front(), 0);
+                }
             }
+            else
+                AddToChecksum(*bid, 0);
 
-            // 如果卖单已完全成交，从列表中删除该卖单
+            // 如果卖单已完全成交，从列表中删除该卖单，新的队首不再有前驱
             if (ask->IsFilled())
             {
                 asks.pop_front();
                 orders_.erase(ask->GetOrderId());
+                if (!asks.empty())
+                {
+                    RemoveFromChecksum(*asks.front(), ask->GetOrderId());
+                    AddToChecksum(*asks.front(), 0);
+                }
             }
+            else
+                AddToChecksum(*ask, 0);
 
             // 将此次交易信息记录到交易列表中
             trades.push_back(Trade{
                     TradeInfo{ bid->GetOrderId(), bid->GetPrice(), quantity },
                     TradeInfo{ ask->GetOrderId(), ask->GetPrice(), quantity }
             });
+            counters_.OnTrade(quantity);
+            if (listener_ != nullptr)
+                listener_->OnTrade(trades.back());
 
             // 更新订单簿数据
-            OnOrderMatched(bid->GetPrice(), quantity, bid->IsFilled());
-            OnOrderMatched(ask->GetPrice(), quantity, ask->IsFilled());
+            OnOrderMatched(Side::Buy, bid->GetPrice(), quantity, bid->IsFilled());
+            OnOrderMatched(Side::Sell, ask->GetPrice(), quantity, ask->IsFilled());
         }
 
-        // 如果所有买单已匹配完，删除买单价格级别
+        // 如果所有买单已匹配完，删除买单价格级别（级别数据已由 UpdateLevelData 在订单数归零时删除）；
+        // 按迭代器删除，bidPrice 引用的是被删除节点中的键，删除后不能再使用
         if (bids.empty())
-        {
-            bids_.erase(bidPrice);
-            data_.erase(bidPrice);
-        }
+            bids_.erase(bids_.begin());
 
         // 如果所有卖单已匹配完，删除卖单价格级别
         if (asks.empty())
-        {
-            asks_.erase(askPrice);
-            data_.erase(askPrice);
-        }
+            asks_.erase(asks_.begin());
     }
 
-    // 处理 FillAndKill 类型的订单，如果无法匹配则取消订单
+    // 处理 FillAndKill 类型的订单，如果无法匹配则取消订单（此时已持有锁，使用内部实现）
     if (!bids_.empty())
     {
         auto& [_, bids] = *bids_.begin();
         auto& order = bids.front();
         if (order->GetOrderType() == OrderType::FillAndKill)
-            CancelOrder(order->GetOrderId());
+            CancelOrderInternal(order->GetOrderId());
     }
 
     if (!asks_.empty())
@@ -315,31 +407,39 @@ Trades Orderbook::MatchOrders()
         auto& [_, asks] = *asks_.begin();
         auto& order = asks.front();
         if (order->GetOrderType() == OrderType::FillAndKill)
-            CancelOrder(order->GetOrderId());
+            CancelOrderInternal(order->GetOrderId());
     }
-
-    return trades;
 }
 
-// 构造函数，启动清理当日有效订单的线程
-Orderbook::Orderbook() : ordersPruneThread_{ [this] { PruneGoodForDayOrders(); } } { }
+// 构造函数，撮合模式且按本地时钟清理时启动清理当日有效订单的线程
+Orderbook::Orderbook(OrderbookMode mode, OrderbookPruning pruning)
+    : mode_{ mode }
+    , ordersPruneThread_{ mode == OrderbookMode::Matching && pruning == OrderbookPruning::Clock ? std::thread{ [this] { PruneGoodForDayOrders(); } } : std::thread{ } }
+{ }
 
 // 析构函数，关闭订单簿并等待清理线程退出
 Orderbook::~Orderbook()
 {
     shutdown_.store(true, std::memory_order_release);   // 设置关闭标志
     shutdownConditionVariable_.notify_one();           // 唤醒清理线程
-    ordersPruneThread_.join();                         // 等待线程结束
+    if (ordersPruneThread_.joinable())
+        ordersPruneThread_.join();                     // 等待线程结束
 }
 
-// 添加订单并匹配，返回交易记录
-Trades Orderbook::AddOrder(OrderPointer order)
+// 内部函数：添加订单并匹配，成交记录追加到 trades
+void Orderbook::AddOrderInternal(OrderPointer order, Trades& trades)
 {
-    std::scoped_lock ordersLock{ ordersMutex_ };  // 锁定订单列表
-
-    // 如果订单已存在，返回空的交易记录
+    // 如果订单已存在，不做任何处理
     if (orders_.contains(order->GetOrderId()))
-        return { };
+        return;
+
+    // 被动模式下直接挂单，不检查能否成交，也不撮合；市价订单没有价格，无法镜像，直接忽略
+    if (mode_ == OrderbookMode::Passive)
+    {
+        if (order->GetOrderType() != OrderType::Market)
+            InsertOrderInternal(order);
+        return;
+    }
 
     // 如果是市场订单，自动调整为 GoodTillCancel 类型
     if (order->GetOrderType() == OrderType::Market)
@@ -356,90 +456,319 @@ Trades Orderbook::AddOrder(OrderPointer order)
             order->ToGoodTillCancel(worstBid);
         }
         else
-            return { };  // 如果没有匹配的价格，直接返回
+            return;  // 如果没有匹配的价格，直接返回
     }
 
-    // 如果订单是 FillAndKill 类型，但无法匹配，则返回空的交易记录
+    // 如果订单是 FillAndKill 类型，但无法匹配，则不做任何处理
     if (order->GetOrderType() == OrderType::FillAndKill && !CanMatch(order->GetSide(), order->GetPrice()))
-        return { };
+    {
+        counters_.OnRejected(OrderType::FillAndKill);
+        return;
+    }
 
-    // 如果订单是 FillOrKill 类型，但无法完全匹配，则返回空的交易记录
+    // 如果订单是 FillOrKill 类型，但无法完全匹配，则不做任何处理
     if (order->GetOrderType() == OrderType::FillOrKill && !CanFullyFill(order->GetSide(), order->GetPrice(), order->GetInitialQuantity()))
-        return { };
+    {
+        counters_.OnRejected(OrderType::FillOrKill);
+        return;
+    }
+
+    // 挂单并尝试匹配
+    InsertOrderInternal(order);
+    MatchOrders(trades);
+}
 
+// 内部函数：把订单挂到价格队列末尾，不撮合
+void Orderbook::InsertOrderInternal(OrderPointer order)
+{
     OrderPointers::iterator iterator;
 
     // 根据订单方向，将订单插入到买单或卖单列表中
     if (order->GetSide() == Side::Buy)
     {
         auto& orders = bids_[order->GetPrice()];
+        AddToChecksum(*order, orders.empty() ? 0 : orders.back()->GetOrderId());
         orders.push_back(order);
         iterator = std::prev(orders.end());
     }
     else
     {
         auto& orders = asks_[order->GetPrice()];
+        AddToChecksum(*order, orders.empty() ? 0 : orders.back()->GetOrderId());
         orders.push_back(order);
         iterator = std::prev(orders.end());
     }
 
     // 在订单映射中记录订单信息
     orders_.insert({ order->GetOrderId(), OrderEntry{ order, iterator } });
+    counters_.OnOrderInserted(orders_.size());
 
     // 调用订单添加的回调函数
     OnOrderAdded(order);
+}
 
-    // 尝试匹配订单，并返回匹配结果
-    return MatchOrders();
+// 内部函数：减少挂单的剩余数量，保留其队列位置
+bool Orderbook::ReduceOrderInternal(OrderId orderId, Quantity quantity)
+{
+    // 如果订单不存在，不做任何处理
+    const auto entry = orders_.find(orderId);
+    if (entry == orders_.end())
+        return true;
+
+    const auto& [order, iterator] = entry->second;
+    if (quantity > order->GetRemainingQuantity())
+        return false;
+
+    // 全部减完时按取消处理
+    if (quantity == order->GetRemainingQuantity())
+    {
+        CancelOrderInternal(orderId);
+        return true;
+    }
+
+    const auto& orders = order->GetSide() == Side::Buy ? bids_.at(order->GetPrice()) : asks_.at(order->GetPrice());
+    const OrderId predecessor = iterator == orders.begin() ? 0 : (*std::prev(iterator))->GetOrderId();
+    RemoveFromChecksum(*order, predecessor);
+    order->Fill(quantity);
+    AddToChecksum(*order, predecessor);
+
+    OnOrderMatched(order->GetSide(), order->GetPrice(), quantity, false);
+    return true;
+}
+
+void Orderbook::RequirePassive() const
+{
+    if (mode_ != OrderbookMode::Passive)
+        throw std::logic_error("External changes can only be applied to a passive orderbook.");
+}
+
+// 内部函数：修改挂单的价格和数量
+void Orderbook::ReplaceOrderInternal(OrderId orderId, Price price, Quantity quantity)
+{
+    // 如果订单不存在，不做任何处理
+    const auto entry = orders_.find(orderId);
+    if (entry == orders_.end())
+        return;
+
+    const auto order = entry->second.order_;
+
+    // 价格和数量都不变时不做任何处理，也不产生价格级别事件
+    if (price == order->GetPrice() && quantity == order->GetRemainingQuantity())
+        return;
+
+    // 价格不变且数量减少时保留队列位置
+    if (price == order->GetPrice() && quantity <= order->GetRemainingQuantity())
+    {
+        ReduceOrderInternal(orderId, order->GetRemainingQuantity() - quantity);
+        return;
+    }
+
+    CancelOrderInternal(orderId);
+    if (quantity > 0)
+        InsertOrderInternal(std::make_shared<Order>(order->GetOrderType(), orderId, order->GetSide(), price, quantity));
+}
+
+// 内部函数：修改订单，先取消原订单，再以原订单类型添加修改后的订单
+void Orderbook::ModifyOrderInternal(const OrderModify& order, Trades& trades)
+{
+    // 如果订单不存在，不做任何处理
+    if (!orders_.contains(order.GetOrderId()))
+        return;
+
+    // 获取现有订单的类型
+    const auto orderType = orders_.at(order.GetOrderId()).order_->GetOrderType();
+
+    CancelOrderInternal(order.GetOrderId());
+    AddOrderInternal(order.ToOrderPointer(orderType), trades);
+}
+
+// 添加订单并匹配，返回交易记录
+Trades Orderbook::AddOrder(OrderPointer order)
+{
+    ORDERBOOK_LOCK(OrderbookLockSite::AddOrder);  // 锁定订单列表
+    ORDERBOOK_MEASURE_LATENCY(OrderbookOperation::Add);
+
+    counters_.OnAdd(order->GetOrderType());
+    Trades trades;
+    AddOrderInternal(order, trades);
+    return trades;
 }
 
 // 取消订单
 void Orderbook::CancelOrder(OrderId orderId)
 {
-    std::scoped_lock ordersLock{ ordersMutex_ };  // 锁定订单列表
+    ORDERBOOK_LOCK(OrderbookLockSite::CancelOrder);  // 锁定订单列表
+    ORDERBOOK_MEASURE_LATENCY(OrderbookOperation::Cancel);
 
+    counters_.OnCancel();
     CancelOrderInternal(orderId);  // 调用内部函数取消订单
 }
 
-// 修改订单，先取消原订单，再添加修改后的订单
+// 修改订单，先取消原订单，再添加修改后的订单（在同一次加锁内完成）
 Trades Orderbook::ModifyOrder(OrderModify order)
 {
-    OrderType orderType;
+    ORDERBOOK_LOCK(OrderbookLockSite::ModifyOrder);  // 锁定订单列表
+    ORDERBOOK_MEASURE_LATENCY(OrderbookOperation::Modify);
+
+    counters_.OnModify();
+    Trades trades;
+    ModifyOrderInternal(order, trades);
+    return trades;
+}
+
+// 批量执行命令：整批只加锁一次
+std::uint64_t Orderbook::ProcessCommands(std::span<const OrderbookCommand> commands, Trades& trades, std::span<OrderbookCommandResult> results)
+{
+    if (!results.empty() && results.size() != commands.size())
+        throw std::logic_error("Command results must have one entry per command.");
+
+    ORDERBOOK_LOCK(OrderbookLockSite::ProcessCommands);  // 锁定订单列表
+    ORDERBOOK_START_LATENCY_LAPS();
 
+    for (std::size_t index = 0; index < commands.size(); ++index)
     {
-        std::scoped_lock ordersLock{ ordersMutex_ };  // 锁定订单列表
+        const auto& command = commands[index];
+        const bool found = !results.empty() && orders_.contains(command.orderId_);
 
-        // 如果订单不存在，返回空的交易记录
-        if (!orders_.contains(order.GetOrderId()))
-            return { };
+        switch (command.type_)
+        {
+            case OrderbookCommandType::Add:
+                counters_.OnAdd(command.orderType_);
+                AddOrderInternal(std::make_shared<Order>(command.orderType_, command.orderId_, command.side_, command.price_, command.quantity_), trades);
+                ORDERBOOK_LATENCY_LAP(OrderbookOperation::Add);
+                break;
+            case OrderbookCommandType::Cancel:
+                counters_.OnCancel();
+                CancelOrderInternal(command.orderId_);
+                ORDERBOOK_LATENCY_LAP(OrderbookOperation::Cancel);
+                break;
+            case OrderbookCommandType::Modify:
+                counters_.OnModify();
+                ModifyOrderInternal(OrderModify{ command.orderId_, command.side_, command.price_, command.quantity_ }, trades);
+                ORDERBOOK_LATENCY_LAP(OrderbookOperation::Modify);
+                break;
+            case OrderbookCommandType::Prune:
+                // 每日清理不属于任何一类操作，不计入延迟直方图
+                CancelOrdersInternal(GetGoodForDayOrderIds());
+                ORDERBOOK_SKIP_LATENCY_LAP();
+                break;
+            default:
+                throw std::logic_error("Unsupported orderbook command.");
+        }
 
-        // 获取现有订单的类型
-        const auto& [existingOrder, _] = orders_.at(order.GetOrderId());
-        orderType = existingOrder->GetOrderType();
+        if (!results.empty())
+        {
+            const auto entry = orders_.find(command.orderId_);
+            results[index] = OrderbookCommandResult{ trades.size(), found, entry == orders_.end() ? 0 : entry->second.order_->GetRemainingQuantity() };
+        }
     }
 
-    // 取消原订单，并添加修改后的订单
-    CancelOrder(order.GetOrderId());
-    return AddOrder(order.ToOrderPointer(orderType));
+    return checksum_;
+}
+
+// 应用外部市场的成交
+void Orderbook::ApplyExecution(OrderId orderId, Quantity quantity)
+{
+    RequirePassive();
+    ORDERBOOK_LOCK(OrderbookLockSite::Apply);  // 锁定订单列表
+
+    if (!ReduceOrderInternal(orderId, quantity))
+        throw std::logic_error(std::format("Order ({}) cannot be reduced by more than its remaining quantity.", orderId));
+}
+
+// 应用外部市场的改单
+void Orderbook::ApplyReplace(OrderId orderId, Price price, Quantity quantity)
+{
+    RequirePassive();
+    ORDERBOOK_LOCK(OrderbookLockSite::Apply);  // 锁定订单列表
+
+    counters_.OnModify();
+    ReplaceOrderInternal(orderId, price, quantity);
+}
+
+// 批量应用外部市场的变更：整批只加锁一次，不撮合；无法应用的命令被跳过，不会在批次中途抛出异常
+std::size_t Orderbook::ApplyCommands(std::span<const OrderbookCommand> commands)
+{
+    RequirePassive();
+    ORDERBOOK_LOCK(OrderbookLockSite::Apply);  // 锁定订单列表
+
+    std::size_t skipped{ };
+    for (const auto& command : commands)
+    {
+        switch (command.type_)
+        {
+            case OrderbookCommandType::Add:
+                // 市价订单没有价格，无法镜像（与被动模式的 AddOrder 一致）
+                if (command.orderType_ == OrderType::Market)
+                {
+                    ++skipped;
+                    break;
+                }
+                counters_.OnAdd(command.orderType_);
+                if (!orders_.contains(command.orderId_))
+                    InsertOrderInternal(std::make_shared<Order>(command.orderType_, command.orderId_, command.side_, command.price_, command.quantity_));
+                break;
+            case OrderbookCommandType::Cancel:
+                counters_.OnCancel();
+                CancelOrderInternal(command.orderId_);
+                break;
+            case OrderbookCommandType::Execute:
+                skipped += !ReduceOrderInternal(command.orderId_, command.quantity_);
+                break;
+            case OrderbookCommandType::Replace:
+                counters_.OnModify();
+                ReplaceOrderInternal(command.orderId_, command.price_, command.quantity_);
+                break;
+            default:
+                ++skipped;
+                break;
+        }
+    }
+    return skipped;
+}
+
+// 延迟直方图只由持有锁的线程写入，读取不需要加锁
+LatencySummary Orderbook::GetLatencyStats(OrderbookOperation operation) const
+{
+#ifdef ORDERBOOK_LATENCY_STATS
+    return latency_.at(static_cast<std::size_t>(operation)).Summarize();
+#else
+    static_cast<void>(operation);
+    return { };
+#endif
+}
+
+// 锁统计只由持有锁的线程写入，读取不需要加锁
+LockSiteSummary Orderbook::GetLockStats(OrderbookLockSite site) const
+{
+#ifdef ORDERBOOK_LOCK_STATS
+    const auto& histograms = lockProfile_.at(static_cast<std::size_t>(site));
+    return LockSiteSummary{ histograms.wait_.Summarize(), histograms.hold_.Summarize() };
+#else
+    static_cast<void>(site);
+    return { };
+#endif
 }
 
 // 返回订单簿中的订单数量
 std::size_t Orderbook::Size() const
 {
-    std::scoped_lock ordersLock{ ordersMutex_ };  // 锁定订单列表
+    ORDERBOOK_LOCK(OrderbookLockSite::Size);  // 锁定订单列表
     return orders_.size();  // 返回订单数量
 }
 
 // 获取订单簿中的级别信息
-OrderbookLevelInfos Orderbook::GetOrderInfos() const
+OrderbookLevelInfos Orderbook::GetOrderInfos(std::size_t depth) const
 {
     // 创建两个容器用于存储买单和卖单的级别信息
     LevelInfos bidInfos, askInfos;
 
+    ORDERBOOK_LOCK(OrderbookLockSite::GetOrderInfos);  // 锁定订单列表，与写入线程并发调用时遍历的容器不会被修改
+
     // 预留空间，以减少向量动态扩容的开销
-    // reserve 函数根据当前的订单数量（orders_.size()）为 bidInfos 和 askInfos 预留足够的内存空间
-    bidInfos.reserve(orders_.size());  // 为买单列表预留空间
-    askInfos.reserve(orders_.size());  // 为卖单列表预留空间
+    // 每方最多返回 depth 个价格级别，按实际的级别数预留
+    bidInfos.reserve(std::min(depth, bids_.size()));  // 为买单列表预留空间
+    askInfos.reserve(std::min(depth, asks_.size()));  // 为卖单列表预留空间
 
     // Lambda 函数，用于创建 LevelInfo（价格和该价格级别的订单总数量）
     // 该函数接收价格（Price）和订单列表（OrderPointers），计算该价格级别的总订单数量
@@ -457,15 +786,74 @@ OrderbookLevelInfos Orderbook::GetOrderInfos() const
                                                  }) };
     };
 
-    // 遍历买单价格级别，使用 CreateLevelInfos 生成每个价格级别的 LevelInfo，并添加到 bidInfos 向量中
-    for (const auto& [price, orders] : bids_)
-        bidInfos.push_back(CreateLevelInfos(price, orders));
+    // 从最优价开始遍历买单价格级别，使用 CreateLevelInfos 生成每个价格级别的 LevelInfo，并添加到 bidInfos 向量中
+    for (auto level = bids_.begin(); level != bids_.end() && bidInfos.size() < depth; ++level)
+        bidInfos.push_back(CreateLevelInfos(level->first, level->second));
 
-    // 遍历卖单价格级别，使用 CreateLevelInfos 生成每个价格级别的 LevelInfo，并添加到 askInfos 向量中
-    for (const auto& [price, orders] : asks_)
-        askInfos.push_back(CreateLevelInfos(price, orders));
+    // 从最优价开始遍历卖单价格级别，使用 CreateLevelInfos 生成每个价格级别的 LevelInfo，并添加到 askInfos 向量中
+    for (auto level = asks_.begin(); level != asks_.end() && askInfos.size() < depth; ++level)
+        askInfos.push_back(CreateLevelInfos(level->first, level->second));
 
     // 返回包含买单和卖单级别信息的 OrderbookLevelInfos 对象
     return OrderbookLevelInfos{ bidInfos, askInfos };
 }
 
+// 获取订单簿的内存占用
+OrderbookMemoryFootprint Orderbook::GetMemoryFootprint() const
+{
+    // 节点大小只与类型有关，探测一次
+    static const std::array<std::size_t, OrderbookContainerCount> nodeBytes{
+        NodeSizeProbe::GetSharedObjectBytes<Order>(),
+        NodeSizeProbe::GetListNodeBytes<OrderPointer>(),
+        NodeSizeProbe::GetHashNodeBytes<OrderId, OrderEntry>(),
+        NodeSizeProbe::GetMapNodeBytes<Price, OrderPointers>(),
+        NodeSizeProbe::GetHashNodeBytes<Price, LevelData>(),
+    };
+    const auto SetContainer = [](OrderbookMemoryFootprint& footprint, OrderbookContainer container, std::size_t nodes, std::size_t bucketBytes)
+    {
+        const auto index = static_cast<std::size_t>(container);
+        footprint.containers_[index] = ContainerFootprint{ nodes, nodeBytes[index], bucketBytes };
+    };
+
+    ORDERBOOK_LOCK(OrderbookLockSite::GetMemoryFootprint);  // 锁定订单列表
+    OrderbookMemoryFootprint footprint;
+    footprint.orders_ = orders_.size();
+    footprint.levels_ = bids_.size() + asks_.size();
+    footprint.objectBytes_ = sizeof(Orderbook);
+    // 每个挂单对应一个 Order 对象和一个队列节点
+    SetContainer(footprint, OrderbookContainer::Orders, orders_.size(), 0);
+    SetContainer(footprint, OrderbookContainer::Queues, orders_.size(), 0);
+    SetContainer(footprint, OrderbookContainer::OrderIndex, orders_.size(), NodeSizeProbe::GetBucketBytes(orders_));
+    SetContainer(footprint, OrderbookContainer::LevelMaps, bids_.size() + asks_.size(), 0);
+    SetContainer(footprint, OrderbookContainer::LevelData, bidData_.size() + askData_.size(),
+                 NodeSizeProbe::GetBucketBytes(bidData_) + NodeSizeProbe::GetBucketBytes(askData_));
+    return footprint;
+}
+
+// 查询一批订单的剩余数量
+void Orderbook::GetRemainingQuantities(std::span<const OrderId> orderIds, std::span<Quantity> quantities) const
+{
+    if (quantities.size() != orderIds.size())
+        throw std::logic_error("Quantities must have one entry per order ID.");
+
+    ORDERBOOK_LOCK(OrderbookLockSite::GetRemainingQuantities);  // 锁定订单列表
+    for (std::size_t index = 0; index < orderIds.size(); ++index)
+    {
+        const auto entry = orders_.find(orderIds[index]);
+        quantities[index] = entry == orders_.end() ? 0 : entry->second.order_->GetRemainingQuantity();
+    }
+}
+
+// 获取订单簿状态的校验和
+std::uint64_t Orderbook::GetChecksum() const
+{
+    ORDERBOOK_LOCK(OrderbookLockSite::GetChecksum);  // 锁定订单列表
+    return checksum_;
+}
+
+// 设置订单簿事件的监听者
+void Orderbook::SetListener(OrderbookListener* listener)
+{
+    std::scoped_lock ordersLock{ ordersMutex_ };  // 锁定订单列表
+    listener_ = listener;
+}
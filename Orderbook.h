@@ -1,16 +1,27 @@
 #pragma once
 
+#include <array>
+#include <limits>
 #include <map>
 #include <unordered_map>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
+#include <span>
 
 #include "Usings.h"                     // 包含类型定义，如 OrderId、Price、Quantity 等
 #include "Order.h"                      // 包含 Order 类的定义
 #include "OrderModify.h"                // 包含 OrderModify 类的定义
 #include "OrderbookLevelInfos.h"        // 包含 OrderbookLevelInfos 的定义，用于获取订单簿级别的信息
 #include "Trade.h"                      // 包含 Trade 类的定义，用于存储交易信息
+#include "OrderbookCommand.h"           // 包含批量接口使用的命令定义
+#include "OrderbookListener.h"          // 包含订单簿事件监听者的定义
+#include "OrderbookMode.h"              // 包含订单簿工作模式的定义
+#include "OrderbookOperation.h"         // 包含延迟统计使用的操作类型
+#include "OrderbookStats.h"             // 包含累计计数器的定义
+#include "LatencyHistogram.h"           // 包含延迟直方图的定义
+#include "LockProfile.h"                // 包含带统计的作用域锁
+#include "OrderbookMemory.h"            // 包含内存占用统计的定义
 
 // 订单簿类定义
 class Orderbook
@@ -39,51 +50,92 @@ private:
         };
     };
 
-    // 保存订单簿的级别数据，价格为键，LevelData 为值
-    std::unordered_map<Price, LevelData> data_;
+    // 保存订单簿的级别数据，价格为键，LevelData 为值；买卖双方分开保存，同一价格上两方的数据不会混在一起
+    std::unordered_map<Price, LevelData> bidData_;
+    std::unordered_map<Price, LevelData> askData_;
     // 保存买单列表，按照价格从高到低排序
     std::map<Price, OrderPointers, std::greater<Price>> bids_;
     // 保存卖单列表，按照价格从低到高排序
     std::map<Price, OrderPointers, std::less<Price>> asks_;
     // 保存订单 ID 到订单条目映射，用于快速查找订单
     std::unordered_map<OrderId, OrderEntry> orders_;
+    // 订单簿状态的滚动校验和：所有挂单哈希值之和（模 2^64），每次变更时 O(1) 更新
+    std::uint64_t checksum_{ };
+    // 累计计数器，只在持有锁时更新，读取不加锁
+    OrderbookCounters counters_;
+    // 订单簿事件的监听者（可以为空）
+    OrderbookListener* listener_{ nullptr };
+    // 工作模式，构造后不再改变
+    const OrderbookMode mode_;
+#ifdef ORDERBOOK_LATENCY_STATS
+    // 各类操作的延迟直方图，按 OrderbookOperation 索引；只在持有锁时写入，读取不加锁
+    std::array<LatencyHistogram, OrderbookOperationCount> latency_;
+#endif
     // 用于线程同步的互斥锁
     mutable std::mutex ordersMutex_;
-    // 用于清理当日有效订单的后台线程
-    std::thread ordersPruneThread_;
+#ifdef ORDERBOOK_LOCK_STATS
+    // 各加锁调用点的等待和持有时间，按 OrderbookLockSite 索引；只在持有锁时写入，读取不加锁
+    mutable std::array<LockSiteHistograms, OrderbookLockSiteCount> lockProfile_;
+#endif
     // 条件变量，用于控制线程的关闭
     std::condition_variable shutdownConditionVariable_;
     // 标识是否关闭订单簿的标志
     std::atomic<bool> shutdown_{ false };
+    // 用于清理当日有效订单的后台线程，只在撮合模式且 OrderbookPruning::Clock 时启动
+    // 必须声明在其使用的成员之后：线程在构造时即启动，此时条件变量和关闭标志必须已经构造完成
+    std::thread ordersPruneThread_;
 
     // 清理当日有效订单的函数
     void PruneGoodForDayOrders();
 
     // 批量取消订单
     void CancelOrders(OrderIds orderIds);
+    // 收集所有 GoodForDay 挂单的 ID（调用方持有锁）
+    OrderIds GetGoodForDayOrderIds() const;
+    // 取消一批订单并计入清理的订单数（调用方持有锁）
+    void CancelOrdersInternal(const OrderIds& orderIds);
     // 内部取消订单的实现
     void CancelOrderInternal(OrderId orderId);
+    // 内部添加订单的实现（调用方持有锁），成交追加到 trades
+    void AddOrderInternal(OrderPointer order, Trades& trades);
+    // 内部修改订单的实现（调用方持有锁），成交追加到 trades
+    void ModifyOrderInternal(const OrderModify& order, Trades& trades);
+    // 把订单挂到其价格队列的末尾并更新索引、级别数据和校验和，不检查订单类型也不撮合（调用方持有锁）
+    void InsertOrderInternal(OrderPointer order);
+    // 在不改变队列位置的情况下减少挂单的剩余数量，减到 0 时删除该挂单（调用方持有锁）
+    // quantity 超过剩余数量时不做任何修改并返回 false
+    bool ReduceOrderInternal(OrderId orderId, Quantity quantity);
+    // Apply* 只能用于被动模式的订单簿，否则抛出 std::logic_error
+    void RequirePassive() const;
+    // 修改挂单的价格和数量：只减少数量时保留队列位置，否则排到新价格队列的末尾（调用方持有锁）
+    void ReplaceOrderInternal(OrderId orderId, Price price, Quantity quantity);
 
     // 当订单被取消时的回调函数
     void OnOrderCancelled(OrderPointer order);
     // 当订单被添加时的回调函数
     void OnOrderAdded(OrderPointer order);
     // 当订单匹配时的回调函数
-    void OnOrderMatched(Price price, Quantity quantity, bool isFullyFilled);
+    void OnOrderMatched(Side side, Price price, Quantity quantity, bool isFullyFilled);
     // 更新价格级别数据
-    void UpdateLevelData(Price price, Quantity quantity, LevelData::Action action);
+    void UpdateLevelData(Side side, Price price, Quantity quantity, LevelData::Action action);
+
+    // 在校验和中加入 / 移除一个挂单，predecessor 为其在同一价格队列中前一个订单的 ID（队首为 0）
+    void AddToChecksum(const Order& order, OrderId predecessor);
+    void RemoveFromChecksum(const Order& order, OrderId predecessor);
+    // 从校验和中移除队列中的一个订单，并把其后继订单的前驱更新为该订单的前驱
+    void RemoveFromChecksum(const OrderPointers& orders, OrderPointers::iterator iterator);
 
     // 判断是否可以完全匹配某个订单
     bool CanFullyFill(Side side, Price price, Quantity quantity) const;
     // 判断是否可以匹配某个订单
     bool CanMatch(Side side, Price price) const;
-    // 匹配订单并返回交易记录
-    Trades MatchOrders();
+    // 匹配订单，成交追加到 trades
+    void MatchOrders(Trades& trades);
 
 public:
 
-    // 构造函数
-    Orderbook();
+    // 构造函数，默认为撮合模式，由后台线程按本地时钟清理当日有效订单
+    explicit Orderbook(OrderbookMode mode = OrderbookMode::Matching, OrderbookPruning pruning = OrderbookPruning::Clock);
     // 禁用拷贝构造函数
     Orderbook(const Orderbook&) = delete;
     // 禁用拷贝赋值运算符
@@ -101,9 +153,53 @@ public:
     void CancelOrder(OrderId orderId);
     // 修改订单并返回匹配的交易
     Trades ModifyOrder(OrderModify order);
+    // 在一次加锁内依次执行一批命令，产生的成交按顺序追加到 trades
+    // results 非空时必须与 commands 一样长，每条命令执行后写入其结果
+    // 返回整批执行完后的校验和（在同一次加锁内读取，不会混入其他线程随后的修改）
+    std::uint64_t ProcessCommands(std::span<const OrderbookCommand> commands, Trades& trades, std::span<OrderbookCommandResult> results = { });
+    // 以下 Apply* 只用于被动模式（镜像外部市场），在撮合模式的订单簿上调用时抛出 std::logic_error
+    // 外部市场上挂单成交了 quantity，直接减少其剩余数量并保留队列位置，全部成交时删除；不撮合、不产生成交
+    // quantity 超过剩余数量时抛出 std::logic_error，订单簿不变
+    void ApplyExecution(OrderId orderId, Quantity quantity);
+    // 外部市场上挂单改为 price / quantity：价格不变且数量不增加时保留队列位置，否则排到新价格队列的末尾；不撮合
+    void ApplyReplace(OrderId orderId, Price price, Quantity quantity);
+    // 在一次加锁内依次应用一批来自外部市场的逐笔变更，不撮合、不产生成交，返回被跳过的命令数
+    // Add 直接挂单（价格可以与对手方交叉），Cancel 删除挂单，Execute 减少剩余数量，Replace 修改价格和数量；
+    // 无法应用的命令（市价单、超过剩余数量的成交、其他命令类型）被跳过，不影响批次中的其余命令
+    std::size_t ApplyCommands(std::span<const OrderbookCommand> commands);
 
     // 返回订单簿的大小（订单数量）
     std::size_t Size() const;
-    // 获取当前订单簿的级别信息
-    OrderbookLevelInfos GetOrderInfos() const;
+    // 获取当前订单簿的级别信息，每方最多 depth 个价格级别（从最优价开始）；depth 为 1 时即最优买卖价
+    OrderbookLevelInfos GetOrderInfos(std::size_t depth = std::numeric_limits<std::size_t>::max()) const;
+    // 在一次加锁内查询一批订单在簿中的剩余数量，不在簿中的订单为 0；quantities 必须与 orderIds 一样长
+    void GetRemainingQuantities(std::span<const OrderId> orderIds, std::span<Quantity> quantities) const;
+    // 获取订单簿状态的校验和，覆盖订单 ID、方向、价格、剩余数量以及队列顺序
+    std::uint64_t GetChecksum() const;
+    // 获取订单簿当前的内存占用，按容器分开统计；加锁，只读取各容器的大小，可以在任意时刻调用
+    OrderbookMemoryFootprint GetMemoryFootprint() const;
+    // 获取工作模式
+    OrderbookMode GetMode() const { return mode_; }
+    // 是否由后台线程按本地时钟清理当日有效订单
+    bool PrunesOnClock() const { return ordersPruneThread_.joinable(); }
+    // 获取累计计数器的快照，不加锁，可以在任意线程调用
+    OrderbookStats GetStats() const { return counters_.GetSnapshot(); }
+    // 是否编译了操作延迟统计（CMake 选项 ORDERBOOK_LATENCY_STATS）；未编译时插桩代码完全不存在
+#ifdef ORDERBOOK_LATENCY_STATS
+    static constexpr bool LatencyStatsEnabled = true;
+#else
+    static constexpr bool LatencyStatsEnabled = false;
+#endif
+    // 获取某类操作在订单簿内部的延迟分位数（从取得锁之后开始计时，不含等锁时间），不加锁；未编译时返回空的统计
+    LatencySummary GetLatencyStats(OrderbookOperation operation) const;
+    // 是否编译了锁统计（CMake 选项 ORDERBOOK_LOCK_STATS）
+#ifdef ORDERBOOK_LOCK_STATS
+    static constexpr bool LockStatsEnabled = true;
+#else
+    static constexpr bool LockStatsEnabled = false;
+#endif
+    // 获取某个调用点在 ordersMutex_ 上的等待时间和持有时间分位数，不加锁；未编译时返回空的统计
+    LockSiteSummary GetLockStats(OrderbookLockSite site) const;
+    // 设置订单簿事件的监听者，传入空指针表示取消监听；监听者的生命周期由调用方管理
+    void SetListener(OrderbookListener* listener);
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 基准使用的硬件计数器：周期、指令、L1D 读缺失、末级缓存读缺失、分支预测失败
+enum class PerfCounter
+{
+    Cycles,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    BranchMisses,
+};
+
+constexpr std::size_t PerfCounterCount = 5;
+constexpr std::array<std::string_view, PerfCounterCount> PerfCounterNames{ "cycles", "instructions", "L1D-misses", "LLC-misses", "branch-misses" };
+
+// 通过 perf_event_open 读取本线程的硬件计数器（只统计用户态）
+//
+// 每个计数器单独打开，某个事件不受支持（例如虚拟机没有暴露 PMU，或 perf_event_paranoid 不允许）时只缺少该项，
+// IsOpen 返回 false。内核在计数器不足时会分时复用，读数按 enabled / running 时间比例放大。
+// Start 和 Stop 可以多次交替调用，只累计两者之间的部分。非 Linux 平台上所有计数器都不可用。
+class PerfCounters
+{
+public:
+    PerfCounters()
+    {
+#ifdef __linux__
+        constexpr auto Cache = [](std::uint64_t cache, std::uint64_t result)
+        {
+            return cache | (static_cast<std::uint64_t>(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (result << 16);
+        };
+        const std::array<std::pair<std::uint32_t, std::uint64_t>, PerfCounterCount> events{ {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+            { PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        } };
+
+        for (std::size_t index = 0; index < PerfCounterCount; ++index)
+        {
+            perf_event_attr attributes{ };
+            attributes.size = sizeof(attributes);
+            attributes.type = events[index].first;
+            attributes.config = events[index].second;
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            descriptors_[index] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    void operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (const auto descriptor : descriptors_)
+            if (descriptor >= 0)
+                close(descriptor);
+#endif
+    }
+
+    bool IsOpen(PerfCounter counter) const { return descriptors_[static_cast<std::size_t>(counter)] >= 0; }
+    bool IsAnyOpen() const
+    {
+        for (const auto descriptor : descriptors_)
+            if (descriptor >= 0)
+                return true;
+        return false;
+    }
+
+    void Start()
+    {
+#ifdef __linux__
+        for (const auto descriptor : descriptors_)
+            if (descriptor >= 0)
+                ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    void Stop()
+    {
+#ifdef __linux__
+        for (const auto descriptor : descriptors_)
+            if (descriptor >= 0)
+                ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    // 累计的计数，按分时复用的比例放大；不可用的计数器返回 0
+    double Read(PerfCounter counter) const
+    {
+#ifdef __linux__
+        const auto descriptor = descriptors_[static_cast<std::size_t>(counter)];
+        std::uint64_t values[3]{ };   // 计数、enabled 时间、running 时间
+        if (descriptor < 0 || read(descriptor, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[2] == 0)
+            return 0;
+        return static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+#else
+        static_cast<void>(counter);
+        return 0;
+#endif
+    }
+
+private:
+    std::array<int, PerfCounterCount> descriptors_{ -1, -1, -1, -1, -1 };
+};
@@ -0,0 +1,383 @@
+//
+// bench.cpp
+//
+// 订单簿各项操作的微基准（Google Benchmark）
+//
+// 每项操作都在不同的订单簿深度（订单数）和价格级别数下测量，撮合另外按主动单的比例测量。
+// 订单簿在计时开始前建好，计时期间保持深度基本不变：批量添加或撤销后暂停计时，把订单簿恢复到原来的深度。
+//
+// 加上 --perf_counters 时，用 perf_event_open 统计计时部分的硬件计数器（周期、指令、L1D / LLC 缺失、分支预测失败），
+// 按每项操作的平均值报告，例如 LLC-misses/op，用于比较 Order、OrderEntry 和价格级别容器的布局改动。
+// 以 ORDERBOOK_ALLOCATION_TRACKING 编译时还报告计时部分每项操作的分配次数 allocs/op；
+// 加上 --assert_no_allocations 时，建好订单簿（预热）之后计时部分只要有分配，该基准就报告错误。
+//
+// 用法：
+//   OrderbookBench [--perf_counters] [--assert_no_allocations] [--benchmark_filter=<正则>] [其他 Google Benchmark 参数]
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AllocationTracking.h"
+#include "Orderbook.h"
+#include "PerfCounters.h"
+
+namespace
+{
+    constexpr Price MidPrice = 100'000;      // 买卖两侧围绕的中间价
+    constexpr Quantity LotSize = 10;         // 挂单数量，主动单每次恰好吃掉一个挂单
+    constexpr std::int64_t BatchSize = 1024; // 暂停计时恢复深度的间隔
+
+    bool perfCountersEnabled = false;        // 命令行参数 --perf_counters
+    bool noAllocationsRequired = false;      // 命令行参数 --assert_no_allocations
+
+    // 与计时同步开关的计数器：基准用 Pause / Resume 代替 state.PauseTiming / ResumeTiming，计数只覆盖计时的部分。
+    // 硬件计数器只在 --perf_counters 时打开；分配次数总是统计（未编译分配计数时为 0）。
+    // 在建好订单簿之后构造，之前的分配算作预热。
+    class TimedCounters
+    {
+    public:
+        explicit TimedCounters(benchmark::State& state)
+            : state_{ state }
+            , allocationsStart_{ GetThreadAllocationCounts().allocations_ }
+        {
+            if (perfCountersEnabled)
+            {
+                counters_.emplace();
+                counters_->Start();
+            }
+        }
+
+        void Pause()
+        {
+            if (counters_)
+                counters_->Stop();
+            allocations_ += GetThreadAllocationCounts().allocations_ - allocationsStart_;
+            state_.PauseTiming();
+        }
+
+        void Resume()
+        {
+            state_.ResumeTiming();
+            allocationsStart_ = GetThreadAllocationCounts().allocations_;
+            if (counters_)
+                counters_->Start();
+        }
+
+        // 停止计数，报告每项操作的平均计数；不可用的计数器不报告
+        void Report(std::int64_t operations)
+        {
+            if (counters_)
+                counters_->Stop();
+            allocations_ += GetThreadAllocationCounts().allocations_ - allocationsStart_;
+            if (operations == 0)
+                return;
+
+            if (counters_)
+            {
+                for (std::size_t index = 0; index < PerfCounterCount; ++index)
+                {
+                    const auto counter = static_cast<PerfCounter>(index);
+                    if (counters_->IsOpen(counter))
+                        state_.counters[std::string{ PerfCounterNames[index] } + "/op"] = benchmark::Counter(counters_->Read(counter) / static_cast<double>(operations));
+                }
+            }
+
+            if constexpr (AllocationTrackingEnabled)
+                state_.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations_) / static_cast<double>(operations));
+            if (noAllocationsRequired && allocations_ > 0)
+                state_.SkipWithError(("allocated " + std::to_string(allocations_) + " times after warm-up").c_str());
+        }
+
+    private:
+        benchmark::State& state_;
+        std::optional<PerfCounters> counters_;
+        std::uint64_t allocationsStart_;
+        std::uint64_t allocations_{ };
+    };
+
+    // 基准使用的订单簿：depth 个挂单随机分布在买卖两侧各 levels 个价格级别上
+    class BenchBook
+    {
+    public:
+        BenchBook(std::int64_t depth, std::int64_t levels)
+            : depth_{ static_cast<std::size_t>(depth) }
+            , levels_{ static_cast<std::uint64_t>(levels) }
+        {
+            resting_.reserve(depth_ + BatchSize);
+            while (orderbook_->Size() < depth_)
+                AddResting();
+        }
+
+        Orderbook& Get() { return *orderbook_; }
+        std::size_t GetDepth() const { return depth_; }
+
+        // 随机一侧、随机级别的挂单，不会与对手方成交
+        OrderPointer MakeResting()
+        {
+            const auto side = random_() % 2 == 0 ? Side::Buy : Side::Sell;
+            return std::make_shared<Order>(OrderType::GoodTillCancel, nextOrderId_++, side, RestingPrice(side), LotSize);
+        }
+
+        Price RestingPrice(Side side)
+        {
+            const auto offset = static_cast<Price>(1 + random_() % levels_);
+            return side == Side::Buy ? MidPrice - offset : MidPrice + offset;
+        }
+
+        OrderId AddResting()
+        {
+            auto order = MakeResting();
+            const auto orderId = order->GetOrderId();
+            resting_.push_back(RestingOrder{ orderId, order->GetSide() });
+            orderbook_->AddOrder(std::move(order));
+            return orderId;
+        }
+
+        // 补充挂单直到 depth 个，不记录到 resting_：撮合基准中的挂单会被成交，记录下来的 ID 很快失效，resting_ 只会无限增长
+        void RefillUntracked()
+        {
+            while (orderbook_->Size() < depth_)
+                orderbook_->AddOrder(MakeResting());
+        }
+
+        // 随机取出一个挂单（不从订单簿中删除）
+        std::pair<OrderId, Side> TakeRandomResting()
+        {
+            const auto index = random_() % resting_.size();
+            const auto order = resting_[index];
+            resting_[index] = resting_.back();
+            resting_.pop_back();
+            return { order.orderId_, order.side_ };
+        }
+
+        std::pair<OrderId, Side> PeekRandomResting()
+        {
+            const auto& order = resting_[random_() % resting_.size()];
+            return { order.orderId_, order.side_ };
+        }
+
+        // 穿过对手方所有级别、数量为一手的 FillAndKill 单，恰好吃掉对手方最优级别的第一个挂单
+        OrderPointer MakeAggressive()
+        {
+            const auto side = random_() % 2 == 0 ? Side::Buy : Side::Sell;
+            const auto price = static_cast<Price>(side == Side::Buy ? MidPrice + levels_ + 1 : MidPrice - levels_ - 1);
+            return std::make_shared<Order>(OrderType::FillAndKill, nextOrderId_++, side, price, LotSize);
+        }
+
+        std::uint64_t Random() { return random_(); }
+
+    private:
+        struct RestingOrder
+        {
+            OrderId orderId_;
+            Side side_;
+        };
+
+        std::unique_ptr<Orderbook> orderbook_{ std::make_unique<Orderbook>() };
+        std::size_t depth_;
+        std::uint64_t levels_;
+        std::vector<RestingOrder> resting_;   // 撤单和改单基准使用的挂单
+        OrderId nextOrderId_{ 1 };
+        std::mt19937_64 random_{ 42 };
+    };
+
+    // 深度 10 / 1k / 100k / 1M，每侧 10 或 1000 个价格级别
+    void DepthAndLevels(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "depth", "levels" });
+        for (const std::int64_t depth : { 10, 1'000, 100'000, 1'000'000 })
+            for (const std::int64_t levels : { 10, 1'000 })
+                if (levels <= depth)
+                    benchmark->Args({ depth, levels });
+    }
+
+    // 在 DepthAndLevels 的基础上再按主动单比例（百分比）展开
+    void DepthLevelsAndAggression(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "depth", "levels", "aggressive%" });
+        for (const std::int64_t depth : { 10, 1'000, 100'000, 1'000'000 })
+            for (const std::int64_t levels : { 10, 1'000 })
+                for (const std::int64_t aggressive : { 10, 50, 90 })
+                    if (levels <= depth)
+                        benchmark->Args({ depth, levels, aggressive });
+    }
+}
+
+// 添加不成交的挂单；每批之后暂停计时撤掉本批的订单
+static void BM_AddOrder(benchmark::State& state)
+{
+    BenchBook book{ state.range(0), state.range(1) };
+    std::vector<OrderPointer> batch;
+    std::vector<OrderId> added;
+    added.reserve(BatchSize);
+    TimedCounters counters{ state };
+
+    for (auto _ : state)
+    {
+        counters.Pause();
+        batch.clear();
+        for (std::int64_t i = 0; i < BatchSize; ++i)
+            batch.push_back(book.MakeResting());
+        counters.Resume();
+
+        for (auto& order : batch)
+        {
+            added.push_back(order->GetOrderId());
+            benchmark::DoNotOptimize(book.Get().AddOrder(std::move(order)));
+        }
+
+        counters.Pause();
+        for (const auto orderId : added)
+            book.Get().CancelOrder(orderId);
+        added.clear();
+        counters.Resume();
+    }
+    counters.Report(state.iterations() * BatchSize);
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_AddOrder)->Apply(DepthAndLevels)->Unit(benchmark::kMicrosecond);
+
+// 撤销随机位置的挂单；每批之后暂停计时补回同样数量的挂单
+static void BM_CancelOrder(benchmark::State& state)
+{
+    BenchBook book{ state.range(0), state.range(1) };
+    const auto batchSize = std::min<std::int64_t>(BatchSize, state.range(0));
+    std::vector<OrderId> batch;
+    TimedCounters counters{ state };
+
+    for (auto _ : state)
+    {
+        counters.Pause();
+        batch.clear();
+        for (std::int64_t i = 0; i < batchSize; ++i)
+            batch.push_back(book.TakeRandomResting().first);
+        counters.Resume();
+
+        for (const auto orderId : batch)
+            book.Get().CancelOrder(orderId);
+
+        counters.Pause();
+        for (std::int64_t i = 0; i < batchSize; ++i)
+            book.AddResting();
+        counters.Resume();
+    }
+    counters.Report(state.iterations() * batchSize);
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_CancelOrder)->Apply(DepthAndLevels)->Unit(benchmark::kMicrosecond);
+
+// 把随机挂单改到同一侧的另一个随机级别，深度不变，不需要暂停计时
+static void BM_ModifyOrder(benchmark::State& state)
+{
+    BenchBook book{ state.range(0), state.range(1) };
+    TimedCounters counters{ state };
+
+    for (auto _ : state)
+    {
+        const auto [orderId, side] = book.PeekRandomResting();
+        benchmark::DoNotOptimize(book.Get().ModifyOrder(OrderModify{ orderId, side, book.RestingPrice(side), LotSize }));
+    }
+    counters.Report(state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ModifyOrder)->Apply(DepthAndLevels);
+
+// 主动单与挂单混合的订单流：aggressive% 的订单吃掉对手方最优级别的一个挂单，其余为挂单；
+// 每批之后暂停计时，撤掉本批多出的挂单或补足被吃掉的挂单，使深度回到初始值。
+// 深度很小而主动单比例很高时，对手方会在一批之内被吃空，tradesPerOrder 反映实际的成交比例
+static void BM_MatchOrders(benchmark::State& state)
+{
+    BenchBook book{ state.range(0), state.range(1) };
+    const auto aggressive = static_cast<std::uint64_t>(state.range(2));
+    std::vector<OrderPointer> batch;
+    std::vector<OrderId> added;
+    added.reserve(BatchSize);
+    std::size_t trades{ };
+    TimedCounters counters{ state };
+
+    for (auto _ : state)
+    {
+        counters.Pause();
+        batch.clear();
+        for (std::int64_t i = 0; i < BatchSize; ++i)
+            batch.push_back(book.Random() % 100 < aggressive ? book.MakeAggressive() : book.MakeResting());
+        counters.Resume();
+
+        for (auto& order : batch)
+        {
+            if (order->GetOrderType() == OrderType::GoodTillCancel)
+                added.push_back(order->GetOrderId());
+            trades += book.Get().AddOrder(std::move(order)).size();
+        }
+
+        counters.Pause();
+        for (auto orderId = added.begin(); orderId != added.end() && book.Get().Size() > book.GetDepth(); ++orderId)
+            book.Get().CancelOrder(*orderId);
+        added.clear();
+        book.RefillUntracked();
+        counters.Resume();
+    }
+    counters.Report(state.iterations() * BatchSize);
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+    state.counters["tradesPerOrder"] = benchmark::Counter(static_cast<double>(trades) / static_cast<double>(state.iterations() * BatchSize));
+}
+BENCHMARK(BM_MatchOrders)->Apply(DepthLevelsAndAggression)->Unit(benchmark::kMicrosecond);
+
+// 生成按价格级别聚合的快照
+static void BM_GetOrderInfos(benchmark::State& state)
+{
+    BenchBook book{ state.range(0), state.range(1) };
+    TimedCounters counters{ state };
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(book.Get().GetOrderInfos());
+    counters.Report(state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetOrderInfos)->Apply(DepthAndLevels);
+
+// 先取出 --perf_counters 和 --assert_no_allocations，其余参数交给 Google Benchmark
+int main(int argc, char** argv)
+{
+    int count = 1;
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::string_view{ argv[index] } == "--perf_counters")
+            perfCountersEnabled = true;
+        else if (std::string_view{ argv[index] } == "--assert_no_allocations")
+            noAllocationsRequired = true;
+        else
+            argv[count++] = argv[index];
+    }
+    argc = count;
+
+    if (noAllocationsRequired && !AllocationTrackingEnabled)
+    {
+        std::cerr << "--assert_no_allocations requires building with ORDERBOOK_ALLOCATION_TRACKING" << std::endl;
+        return 1;
+    }
+
+    if (perfCountersEnabled)
+    {
+        const PerfCounters probe;
+        for (std::size_t index = 0; index < PerfCounterCount; ++index)
+            if (!probe.IsOpen(static_cast<PerfCounter>(index)))
+                std::cerr << "perf counter " << PerfCounterNames[index] << " is not available and will not be reported" << std::endl;
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
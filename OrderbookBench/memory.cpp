@@ -0,0 +1,263 @@
+//
+// memory.cpp
+//
+// 内存占用基准：用 OrderFlowGenerator 的合成订单流驱动订单簿，在若干检查点输出 GetMemoryFootprint 的结果
+//
+// 每个检查点输出挂单数、价格级别数、总字节数、每挂单和每价格级别的字节数，以及各容器的字节数。
+// 字节数是向分配器申请的大小；glibc= 按 glibc（64 位）每块 8 字节头、16 字节对齐、最小 32 字节估计实际占用的堆内存。
+//
+// --compare 在每个检查点同时给出几种候选容器配置在同一时刻（同样的挂单数、价格级别数和价格范围）的占用：
+//   current      当前实现：make_shared 的订单 + std::list 价格队列 + std::map 价格级别 + 两个 std::unordered_map
+//   unique_ptr   订单改为 std::unique_ptr（没有控制块），其余不变
+//   pool+map     订单放在按峰值挂单数扩容的连续池中，用 32 位下标串成侵入式队列；索引为 OrderId 到下标的
+//                std::unordered_map；价格级别为 std::map，队首 / 队尾和级别数据保存在节点中
+//   pool+flat    订单池同上；索引为负载不超过 1/2 的开放寻址表；价格级别为覆盖买卖各自价格范围的连续数组
+// 候选配置的占用由当前订单簿的状态推算，节点大小用 NodeSizeProbe 探测，因此与编译器和标准库一致。
+//
+// 用法：
+//   OrderbookMemoryBench [messages] [depth] [--compare]
+//
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Orderbook.h"
+#include "OrderFlowGenerator.h"
+
+namespace
+{
+    constexpr std::size_t ChunkSize = 4'096;      // 每批生成的消息数
+    constexpr std::size_t CheckpointCount = 10;   // 检查点个数
+
+    // glibc（64 位）malloc 为一次申请实际占用的字节数
+    std::size_t GetMallocChunkBytes(std::size_t bytes)
+    {
+        return std::max<std::size_t>(32, (bytes + 8 + 15) & ~std::size_t{ 15 });
+    }
+
+    // 候选配置中的一个容器
+    struct Part
+    {
+        std::string_view name_;
+        ContainerFootprint footprint_;
+        bool perOrder_;   // 计入每挂单的字节数，否则计入每价格级别
+    };
+
+    struct Configuration
+    {
+        std::string_view name_;
+        std::vector<Part> parts_;
+    };
+
+    // 推算候选配置所需的订单簿状态
+    struct BookShape
+    {
+        OrderbookMemoryFootprint footprint_;
+        std::size_t peakOrders_{ };
+        std::size_t bidSpan_{ };   // 最优买价到最差买价的价位数
+        std::size_t askSpan_{ };
+    };
+
+    BookShape GetBookShape(const Orderbook& orderbook)
+    {
+        BookShape shape;
+        shape.footprint_ = orderbook.GetMemoryFootprint();
+        shape.peakOrders_ = orderbook.GetStats().peakOrders_;
+        const auto infos = orderbook.GetOrderInfos();
+        const auto& bids = infos.GetBids();
+        const auto& asks = infos.GetAsks();
+        if (!bids.empty())
+            shape.bidSpan_ = static_cast<std::size_t>(bids.front().price_ - bids.back().price_) + 1;
+        if (!asks.empty())
+            shape.askSpan_ = static_cast<std::size_t>(asks.back().price_ - asks.front().price_) + 1;
+        return shape;
+    }
+
+    Configuration GetCurrent(const BookShape& shape)
+    {
+        Configuration configuration{ "current", { } };
+        for (std::size_t index = 0; index < OrderbookContainerCount; ++index)
+        {
+            const auto container = static_cast<OrderbookContainer>(index);
+            const bool perOrder = container == OrderbookContainer::Orders || container == OrderbookContainer::Queues || container == OrderbookContainer::OrderIndex;
+            configuration.parts_.push_back({ OrderbookContainerNames[index], shape.footprint_.Get(container), perOrder });
+        }
+        return configuration;
+    }
+
+    Configuration GetUniquePointer(const BookShape& shape)
+    {
+        using Queue = std::list<std::unique_ptr<Order>>;
+        struct Entry
+        {
+            Order* order_;
+            Queue::iterator location_;
+        };
+
+        const auto& footprint = shape.footprint_;
+        const auto orders = footprint.orders_;
+        return Configuration{ "unique_ptr", {
+            { "orders", { orders, sizeof(Order), 0 }, true },
+            { "queues", { orders, NodeSizeProbe::GetListNodeBytes<std::unique_ptr<Order>>(), 0 }, true },
+            { "orderIndex", { orders, NodeSizeProbe::GetHashNodeBytes<OrderId, Entry>(), footprint.Get(OrderbookContainer::OrderIndex).bucketBytes_ }, true },
+            { "levelMaps", { footprint.levels_, NodeSizeProbe::GetMapNodeBytes<Price, Queue>(), 0 }, false },
+            { "levelData", footprint.Get(OrderbookContainer::LevelData), false },
+        } };
+    }
+
+    // 侵入式队列：订单池中的订单用 32 位下标串成双向链表，价格级别只保存队首和队尾
+    struct PooledOrder
+    {
+        Order order_;
+        std::uint32_t previous_;
+        std::uint32_t next_;
+    };
+
+    struct PooledLevel
+    {
+        std::uint32_t head_;
+        std::uint32_t tail_;
+        Quantity quantity_;
+        Quantity count_;
+    };
+
+    // 按峰值挂单数翻倍扩容、不收缩的订单池
+    Part GetOrderPool(const BookShape& shape)
+    {
+        const auto capacity = std::bit_ceil(std::max<std::size_t>(shape.peakOrders_, 1));
+        return { "orderPool", { 1, capacity * sizeof(PooledOrder), 0 }, true };
+    }
+
+    Configuration GetPoolWithMap(const BookShape& shape)
+    {
+        const auto& footprint = shape.footprint_;
+        return Configuration{ "pool+map", {
+            GetOrderPool(shape),
+            { "orderIndex", { footprint.orders_, NodeSizeProbe::GetHashNodeBytes<OrderId, std::uint32_t>(), footprint.Get(OrderbookContainer::OrderIndex).bucketBytes_ }, true },
+            { "levelMaps", { footprint.levels_, NodeSizeProbe::GetMapNodeBytes<Price, PooledLevel>(), 0 }, false },
+        } };
+    }
+
+    Configuration GetPoolWithFlatArrays(const BookShape& shape)
+    {
+        struct Slot
+        {
+            OrderId orderId_;
+            std::uint32_t index_;
+        };
+
+        const auto slots = std::bit_ceil(std::max<std::size_t>(2 * shape.peakOrders_, 1));
+        return Configuration{ "pool+flat", {
+            GetOrderPool(shape),
+            { "orderIndex", { 1, slots * sizeof(Slot), 0 }, true },
+            { "bidLevels", { shape.bidSpan_ > 0, shape.bidSpan_ * sizeof(PooledLevel), 0 }, false },
+            { "askLevels", { shape.askSpan_ > 0, shape.askSpan_ * sizeof(PooledLevel), 0 }, false },
+        } };
+    }
+
+    void Print(const Configuration& configuration, const BookShape& shape)
+    {
+        const auto& footprint = shape.footprint_;
+        std::size_t orderBytes{ }, levelBytes{ }, mallocBytes{ };
+        for (const auto& part : configuration.parts_)
+        {
+            const auto& container = part.footprint_;
+            (part.perOrder_ ? orderBytes : levelBytes) += container.GetBytes();
+            mallocBytes += container.nodes_ * GetMallocChunkBytes(container.nodeBytes_);
+            if (container.bucketBytes_ > 0)
+                mallocBytes += GetMallocChunkBytes(container.bucketBytes_);
+        }
+
+        const auto total = footprint.objectBytes_ + orderBytes + levelBytes;
+        std::cout << "  " << configuration.name_
+                  << ": total=" << total
+                  << " glibc=" << footprint.objectBytes_ + mallocBytes
+                  << " perOrder=" << (footprint.orders_ == 0 ? 0 : static_cast<double>(orderBytes) / static_cast<double>(footprint.orders_))
+                  << " perLevel=" << (footprint.levels_ == 0 ? 0 : static_cast<double>(levelBytes) / static_cast<double>(footprint.levels_));
+        for (const auto& part : configuration.parts_)
+            std::cout << ' ' << part.name_ << '=' << part.footprint_.GetBytes();
+        std::cout << '\n';
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string_view> arguments(argv + 1, argv + argc);
+    const auto compare = std::find(arguments.begin(), arguments.end(), "--compare");
+    const bool comparing = compare != arguments.end();
+    if (comparing)
+        arguments.erase(compare);
+    if (arguments.size() > 2)
+    {
+        std::cerr << "Usage: OrderbookMemoryBench [messages] [depth] [--compare]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const std::uint64_t messageCount = arguments.size() > 0 ? std::stoull(std::string{ arguments[0] }) : 1'000'000;
+        OrderFlowOptions options;
+        if (arguments.size() > 1)
+            options.depth_ = static_cast<std::uint32_t>(std::stoul(std::string{ arguments[1] }));
+
+        Orderbook orderbook;
+        OrderFlowGenerator generator{ options };
+        OrderbookCommands commands(ChunkSize);
+        Trades trades;
+        trades.reserve(ChunkSize);
+
+        const auto interval = std::max<std::uint64_t>(messageCount / CheckpointCount, 1);
+        std::uint64_t processed{ }, nextCheckpoint{ interval };
+        while (processed < messageCount)
+        {
+            const auto count = static_cast<std::size_t>(std::min<std::uint64_t>({ ChunkSize, messageCount - processed, nextCheckpoint - processed }));
+            generator.Generate(std::span{ commands.data(), count });
+            orderbook.ProcessCommands(std::span{ commands.data(), count }, trades);
+            trades.clear();
+            processed += count;
+            if (processed != nextCheckpoint && processed != messageCount)
+                continue;
+            nextCheckpoint += interval;
+
+            const auto shape = GetBookShape(orderbook);
+            const auto& footprint = shape.footprint_;
+            std::cout << "messages=" << processed
+                      << " orders=" << footprint.orders_
+                      << " levels=" << footprint.levels_
+                      << " peakOrders=" << shape.peakOrders_
+                      << " total=" << footprint.GetTotalBytes()
+                      << " perOrder=" << footprint.GetBytesPerOrder()
+                      << " perLevel=" << footprint.GetBytesPerLevel() << '\n';
+            if (comparing)
+            {
+                for (const auto& configuration : { GetCurrent(shape), GetUniquePointer(shape), GetPoolWithMap(shape), GetPoolWithFlatArrays(shape) })
+                    Print(configuration, shape);
+            }
+            else
+            {
+                for (std::size_t index = 0; index < OrderbookContainerCount; ++index)
+                {
+                    const auto& container = footprint.containers_[index];
+                    std::cout << "  " << OrderbookContainerNames[index]
+                              << ": nodes=" << container.nodes_
+                              << " nodeBytes=" << container.nodeBytes_
+                              << " bucketBytes=" << container.bucketBytes_
+                              << " bytes=" << container.GetBytes() << '\n';
+                }
+            }
+        }
+        std::cout.flush();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+//
+// replay.cpp
+//
+// 场景回放宏基准：把 OrderbookTest/TestFiles 格式（A / M / C / R）的场景文件回放到订单簿中并计时
+//
+// 场景文件可以是手写的小场景，也可以是录制的生产订单流或 OrderbookFlowGen 生成的数 GB 文件；解析器流式读取，内存占用与文件大小无关。
+// 解析不计入订单簿的处理时间。每次提交 batch 条命令（默认 1），用 TSC 记录每次提交的延迟，输出：
+//   - 吞吐量：订单簿处理时间内的命令数 / 秒，以及包括解析在内的端到端吞吐量；
+//   - 每次提交的延迟分位数（p50 / p99 / p99.9 / max）；
+//   - 进程的峰值常驻内存（POSIX）；
+//   - 最终状态：订单数、价格级别数、校验和以及 OrderbookStats 的主要计数。
+// 文件末尾有 R 行时与最终的订单数和价格级别数比较，不一致时返回 2，因此同一份录制文件既可以做回归也可以测性能。
+//
+// 用法：
+//   OrderbookReplayBench <scenario> [batch]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "LatencyHistogram.h"
+#include "Orderbook.h"
+#include "OrderFileParser.h"
+
+namespace
+{
+    constexpr std::size_t ChunkSize = 4'096;   // 每次解析的命令数
+
+    // 峰值常驻内存（KB），不支持时返回 0
+    long PeakResidentKilobytes()
+    {
+#ifndef _WIN32
+        rusage usage{ };
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            return usage.ru_maxrss;   // Linux 上单位为 KB
+#endif
+        return 0;
+    }
+
+    // 每秒的命令数；空场景或耗时为 0 时为 0，避免 0 / 0 得到 NaN 再转换成整数
+    std::uint64_t PerSecond(std::uint64_t count, double seconds)
+    {
+        return count == 0 || seconds <= 0 ? 0 : static_cast<std::uint64_t>(static_cast<double>(count) / seconds);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: OrderbookReplayBench <scenario> [batch]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const std::size_t batchSize = argc > 2 ? std::stoull(argv[2]) : 1;
+        if (batchSize == 0 || batchSize > ChunkSize)
+            throw std::invalid_argument("Batch size must be between 1 and " + std::to_string(ChunkSize) + ".");
+
+        Orderbook orderbook;
+        OrderFileParser parser{ argv[1] };
+        OrderbookCommands commands(ChunkSize);
+        Trades trades;
+        trades.reserve(ChunkSize);
+        auto histogram = std::make_unique<LatencyHistogram>();
+        std::uint64_t commandCount{ }, processingTicks{ };
+
+        const auto start = std::chrono::steady_clock::now();
+        while (const auto count = parser.Parse(commands))
+        {
+            for (std::size_t offset = 0; offset < count; offset += batchSize)
+            {
+                const std::span batch{ commands.data() + offset, std::min(batchSize, count - offset) };
+                const auto begin = ReadTimestampCounter();
+                orderbook.ProcessCommands(batch, trades);
+                const auto ticks = ReadTimestampCounter() - begin;
+                histogram->Record(ticks);
+                processingTicks += ticks;
+            }
+            commandCount += count;
+            trades.clear();
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto processingSeconds = static_cast<double>(processingTicks) / GetTimestampCounterTicksPerNanosecond() / 1e9;
+
+        const auto latency = histogram->Summarize();
+        const auto infos = orderbook.GetOrderInfos();
+        const auto stats = orderbook.GetStats();
+        std::cout << "commands=" << commandCount
+                  << " batch=" << batchSize
+                  << " commands/s=" << PerSecond(commandCount, processingSeconds)
+                  << " endToEnd/s=" << PerSecond(commandCount, seconds)
+                  << " seconds=" << seconds << '\n'
+                  << "latency: p50=" << latency.p50_ << "ns p99=" << latency.p99_ << "ns p99.9=" << latency.p999_
+                  << "ns max=" << latency.max_ << "ns mean=" << latency.mean_ << "ns\n"
+                  << "peakRssKB=" << PeakResidentKilobytes()
+                  << " peakOrders=" << stats.peakOrders_
+                  << " peakLevels=" << stats.peakLevels_ << '\n'
+                  << "orders=" << orderbook.Size()
+                  << " bidLevels=" << infos.GetBids().size()
+                  << " askLevels=" << infos.GetAsks().size()
+                  << " trades=" << stats.trades_
+                  << " matchedQuantity=" << stats.matchedQuantity_
+                  << " checksum=" << std::hex << orderbook.GetChecksum() << std::dec << std::endl;
+
+        if (const auto& result = parser.GetResult())
+        {
+            const bool matches = result->allCount_ == orderbook.Size() && result->bidCount_ == infos.GetBids().size() && result->askCount_ == infos.GetAsks().size();
+            std::cout << "expected: orders=" << result->allCount_ << " bidLevels=" << result->bidCount_ << " askLevels=" << result->askCount_
+                      << (matches ? " OK" : " MISMATCH") << std::endl;
+            if (!matches)
+                return 2;
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,245 @@
+//
+// scaling.cpp
+//
+// 多线程扩展性基准：N 个写入线程和 M 个读取线程同时访问订单簿，测量随 N、M 增加时的总吞吐量和每个线程的尾延迟
+//
+// 写入线程各自用 OrderFlowGenerator（不同的种子）生成下单 / 撤单 / 改单，每条命令单独调用一次 ProcessCommands，
+// 即每条命令加一次锁；订单 ID 的高位是线程编号，不同线程的订单不会冲突。读取线程轮流调用 Size、GetOrderInfos
+// （全部价格级别）和 GetOrderInfos(1)（最优买卖价）。每次调用都用 TSC 计时，记入所在线程的直方图。
+//
+// 每组 N、M 分别在两种布局下运行：
+//   shared    所有线程访问同一个订单簿；
+//   sharded   每个写入线程有自己的订单簿，读取线程依次轮流读取各个订单簿。
+// 计时开始前每个写入线程先提交 warmup 条命令把订单簿填到稳定深度，不计入结果。
+// 输出每组的总写入 / 读取吞吐量，以及每个线程的调用次数和延迟分位数（包括等锁时间）。
+//
+// 注意：shared 布局下各写入线程的生成器使用同一个中间价，各自维护只包含自己订单的影子订单簿，
+// 而订单在共享的订单簿中会与其他线程的订单撮合。影子订单簿因此逐渐偏离实际的订单簿：撤单和改单越来越多地
+// 指向已经被其他线程成交的订单，挂单也可能直接成交，处理的是与 sharded 布局不同的订单流。
+// 按价格区间隔开各线程也不能避免这一点（较高区间的买单总会越过较低区间的卖单），所以每组都输出
+// missRate：撤单和改单中目标订单已经不在订单簿中的比例，以及每条命令的成交数 tradesPerCommand；
+// 比较两种布局的吞吐量时应同时比较这两个值。
+//
+// 用法：
+//   OrderbookScalingBench [maxWriters] [maxReaders] [seconds]
+//   写入线程数取 1, 2, 4, ... 直到 maxWriters（默认 4），读取线程数取 0, 1, 2, 4, ... 直到 maxReaders（默认 4），
+//   每组运行 seconds 秒（默认 1）。
+//
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "Orderbook.h"
+#include "OrderFlowGenerator.h"
+
+namespace
+{
+    constexpr std::uint32_t Depth = 2'000;            // 每个写入线程的目标挂单数
+    constexpr std::uint64_t WarmupCommands = 20'000;  // 每个写入线程计时前提交的命令数
+    constexpr int OrderIdShift = 48;                  // 订单 ID 中线程编号所在的位置
+
+    // 一个线程的结果
+    struct ThreadResult
+    {
+        std::uint64_t operations_{ };
+        std::uint64_t checksum_{ };   // 读取结果的累加，防止读取被优化掉
+        std::uint64_t targeted_{ };   // 撤单和改单数（仅写入线程）
+        std::uint64_t misses_{ };     // 其中目标订单已经不在订单簿中的次数
+        std::uint64_t trades_{ };     // 产生的成交数（仅写入线程）
+        std::unique_ptr<LatencyHistogram> histogram_{ std::make_unique<LatencyHistogram>() };
+    };
+
+    // 同时启动和停止所有线程
+    struct Control
+    {
+        std::atomic<std::size_t> ready_{ };
+        std::atomic<bool> start_{ false };
+        std::atomic<bool> stop_{ false };
+
+        void WaitForStart()
+        {
+            ++ready_;
+            while (!start_.load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+    };
+
+    void RunWriter(Orderbook& orderbook, std::uint64_t writer, Control& control, ThreadResult& result)
+    {
+        OrderFlowOptions options;
+        options.seed_ = writer + 1;
+        options.depth_ = Depth;
+        OrderFlowGenerator generator{ options };
+        Trades trades;
+        trades.reserve(64);
+
+        const auto Next = [&generator, writer]
+        {
+            auto command = generator.Next();
+            command.orderId_ |= writer << OrderIdShift;
+            return command;
+        };
+
+        for (std::uint64_t index = 0; index < WarmupCommands; ++index)
+        {
+            const auto command = Next();
+            orderbook.ProcessCommands(std::span{ &command, 1 }, trades);
+            trades.clear();
+        }
+
+        control.WaitForStart();
+        OrderbookCommandResult commandResult{ };
+        while (!control.stop_.load(std::memory_order_relaxed))
+        {
+            const auto command = Next();
+            const auto begin = ReadTimestampCounter();
+            orderbook.ProcessCommands(std::span{ &command, 1 }, trades, std::span{ &commandResult, 1 });
+            result.histogram_->Record(ReadTimestampCounter() - begin);
+            ++result.operations_;
+            if (command.type_ != OrderbookCommandType::Add)
+            {
+                ++result.targeted_;
+                result.misses_ += !commandResult.found_;
+            }
+            result.trades_ += trades.size();
+            trades.clear();
+        }
+    }
+
+    void RunReader(const std::vector<std::unique_ptr<Orderbook>>& orderbooks, std::size_t reader, Control& control, ThreadResult& result)
+    {
+        std::size_t book = reader % orderbooks.size();
+
+        control.WaitForStart();
+        for (std::uint64_t index = 0; !control.stop_.load(std::memory_order_relaxed); ++index)
+        {
+            const auto& orderbook = *orderbooks[book];
+            const auto begin = ReadTimestampCounter();
+            switch (index % 3)
+            {
+            case 0:
+                result.checksum_ += orderbook.Size();
+                break;
+            case 1:
+                result.checksum_ += orderbook.GetOrderInfos().GetBids().size();
+                break;
+            default:
+                result.checksum_ += orderbook.GetOrderInfos(1).GetAsks().size();
+                break;
+            }
+            result.histogram_->Record(ReadTimestampCounter() - begin);
+            ++result.operations_;
+            book = (book + 1) % orderbooks.size();
+        }
+    }
+
+    double GetRatio(std::uint64_t count, std::uint64_t total)
+    {
+        return total == 0 ? 0 : static_cast<double>(count) / static_cast<double>(total);
+    }
+
+    void Print(std::string_view role, std::size_t index, const ThreadResult& result)
+    {
+        const auto latency = result.histogram_->Summarize();
+        std::cout << "  " << role << index
+                  << ": ops=" << result.operations_;
+        if (result.targeted_ > 0)
+            std::cout << " missRate=" << GetRatio(result.misses_, result.targeted_);
+        std::cout << " p50=" << latency.p50_ << "ns p99=" << latency.p99_ << "ns p99.9=" << latency.p999_
+                  << "ns max=" << latency.max_ << "ns\n";
+    }
+
+    void Run(bool sharded, std::size_t writerCount, std::size_t readerCount, double seconds)
+    {
+        std::vector<std::unique_ptr<Orderbook>> orderbooks(sharded ? writerCount : 1);
+        for (auto& orderbook : orderbooks)
+            orderbook = std::make_unique<Orderbook>();
+
+        Control control;
+        std::vector<ThreadResult> writers(writerCount), readers(readerCount);
+        std::vector<std::thread> threads;
+        for (std::size_t writer = 0; writer < writerCount; ++writer)
+            threads.emplace_back(RunWriter, std::ref(*orderbooks[sharded ? writer : 0]), writer, std::ref(control), std::ref(writers[writer]));
+        for (std::size_t reader = 0; reader < readerCount; ++reader)
+            threads.emplace_back(RunReader, std::cref(orderbooks), reader, std::ref(control), std::ref(readers[reader]));
+
+        while (control.ready_.load() < threads.size())
+            std::this_thread::yield();
+        const auto start = std::chrono::steady_clock::now();
+        control.start_.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        control.stop_ = true;
+        for (auto& thread : threads)
+            thread.join();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::uint64_t writes{ }, reads{ }, targeted{ }, misses{ }, trades{ };
+        for (const auto& result : writers)
+        {
+            writes += result.operations_;
+            targeted += result.targeted_;
+            misses += result.misses_;
+            trades += result.trades_;
+        }
+        for (const auto& result : readers)
+            reads += result.operations_;
+
+        std::cout << "layout=" << (sharded ? "sharded" : "shared")
+                  << " books=" << orderbooks.size()
+                  << " writers=" << writerCount
+                  << " readers=" << readerCount
+                  << " writes/s=" << static_cast<std::uint64_t>(writes / elapsed)
+                  << " reads/s=" << static_cast<std::uint64_t>(reads / elapsed)
+                  << " missRate=" << GetRatio(misses, targeted)
+                  << " tradesPerCommand=" << GetRatio(trades, writes) << '\n';
+        for (std::size_t index = 0; index < writers.size(); ++index)
+            Print("writer", index, writers[index]);
+        for (std::size_t index = 0; index < readers.size(); ++index)
+            Print("reader", index, readers[index]);
+        std::cout.flush();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 4)
+    {
+        std::cerr << "Usage: OrderbookScalingBench [maxWriters] [maxReaders] [seconds]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const std::size_t maxWriters = argc > 1 ? std::stoull(argv[1]) : 4;
+        const std::size_t maxReaders = argc > 2 ? std::stoull(argv[2]) : 4;
+        const double seconds = argc > 3 ? std::stod(argv[3]) : 1;
+        if (maxWriters == 0)
+            throw std::invalid_argument("At least one writer is required.");
+
+        std::cout << "hardwareThreads=" << std::thread::hardware_concurrency() << std::endl;
+        for (std::size_t writers = 1; writers <= maxWriters; writers *= 2)
+        {
+            for (std::size_t readers = 0; readers <= maxReaders; readers = readers == 0 ? 1 : readers * 2)
+            {
+                Run(false, writers, readers, seconds);
+                // 只有一个写入线程时两种布局相同
+                if (writers > 1)
+                    Run(true, writers, readers, seconds);
+            }
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Usings.h"      // 包含 OrderId、Price、Quantity 等类型定义
+#include "OrderType.h"   // 包含订单类型的定义
+#include "Side.h"        // 包含订单方向的定义
+
+// 订单簿命令的类型
+enum class OrderbookCommandType : std::uint8_t
+{
+    Add,    // 添加订单
+    Cancel, // 取消订单
+    Modify, // 修改订单
+    Execute,  // 挂单在外部成交了 quantity_（仅 ApplyCommands）
+    Replace,  // 挂单改为 price_ / quantity_（仅 ApplyCommands）
+    Prune,    // 撤销所有 GoodForDay 挂单，其余字段无效（仅 ProcessCommands）
+};
+
+// 批量接口使用的订单簿命令
+//
+// 平凡类型，调用方可以预分配一批命令反复填充，不需要为每条命令构造 Order 或 OrderModify。
+struct OrderbookCommand
+{
+    OrderbookCommandType type_;   // 命令类型
+    OrderType orderType_;         // 订单类型（仅 Add 有效）
+    Side side_;                   // 买卖方向（Add / Modify 有效）
+    Price price_;                 // 价格（Add / Modify / Replace 有效）
+    Quantity quantity_;           // 数量（Add / Modify / Execute / Replace 有效）
+    OrderId orderId_;             // 订单 ID
+};
+
+using OrderbookCommands = std::vector<OrderbookCommand>;
+
+// 批量接口中一条命令执行后的结果，供调用方按订单簿实际的处理生成回报
+struct OrderbookCommandResult
+{
+    std::size_t tradeEnd_;          // 执行后 trades 的大小：本条命令产生的成交是从上一条命令的 tradeEnd_ 到这里
+    bool found_;                    // 执行前订单 ID 已在订单簿中（Cancel / Modify 是否生效；Add 为 true 表示 ID 重复而被忽略）
+    Quantity remainingQuantity_;    // 执行后该订单在簿中的剩余数量，不在簿中（已成交、已撤销、被丢弃）为 0
+};
+
+using OrderbookCommandResults = std::vector<OrderbookCommandResult>;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Usings.h"   // 包含 Price、Quantity 等类型定义
+#include "Side.h"     // 包含订单方向的定义
+#include "Trade.h"    // 包含 Trade 类的定义
+
+// 订单簿事件的监听者
+//
+// 回调在修改订单簿的线程中、持有订单簿锁时同步调用，实现必须足够快，并且不能再调用订单簿。
+class OrderbookListener
+{
+public:
+    virtual ~OrderbookListener() = default;
+
+    // 某一方向某个价格级别的汇总数量或订单数发生了变化，quantity / count 为变化后的值，count 为 0 表示该级别已被删除
+    virtual void OnLevelChanged(Side side, Price price, Quantity quantity, Quantity count) = 0;
+    // 产生了一笔成交
+    virtual void OnTrade(const Trade& trade) = 0;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+// 内存统计按容器区分
+enum class OrderbookContainer
+{
+	Orders,
+	Queues,
+	OrderIndex,
+	LevelMaps,
+	LevelData,
+};
+//Orders：make_shared 分配的 Order 对象，包括 shared_ptr 的控制块。
+//Queues：各价格队列（std::list）的节点，每个挂单一个。
+//OrderIndex：orders_ 的节点和桶数组。
+//LevelMaps：bids_ / asks_ 的节点，每个价格级别一个，节点中包含 std::list 的表头。
+//LevelData：bidData_ / askData_ 的节点和桶数组。
+
+constexpr std::size_t OrderbookContainerCount = 5;
+constexpr std::array<std::string_view, OrderbookContainerCount> OrderbookContainerNames{ "orders", "queues", "orderIndex", "levelMaps", "levelData" };
+
+// 一类容器占用的堆内存：节点逐个分配，大小相同；哈希表另有一个桶数组
+struct ContainerFootprint
+{
+    std::size_t nodes_{ };         // 节点数
+    std::size_t nodeBytes_{ };     // 每个节点向分配器申请的字节数
+    std::size_t bucketBytes_{ };   // 桶数组的字节数，非哈希表为 0
+
+    std::size_t GetBytes() const { return nodes_ * nodeBytes_ + bucketBytes_; }
+};
+
+// 订单簿某一时刻的内存占用，按容器分开统计向分配器申请的字节数，不含分配器自身的每块开销
+//
+// 每挂单的字节数包括 Orders、Queues 和 OrderIndex，每价格级别的字节数包括 LevelMaps 和 LevelData。
+struct OrderbookMemoryFootprint
+{
+    std::size_t orders_{ };        // 挂单数
+    std::size_t levels_{ };        // 价格级别数（买卖合计）
+    std::size_t objectBytes_{ };   // Orderbook 对象本身
+    std::array<ContainerFootprint, OrderbookContainerCount> containers_{ };
+
+    const ContainerFootprint& Get(OrderbookContainer container) const { return containers_[static_cast<std::size_t>(container)]; }
+
+    std::size_t GetOrderBytes() const
+    {
+        return Get(OrderbookContainer::Orders).GetBytes() + Get(OrderbookContainer::Queues).GetBytes() + Get(OrderbookContainer::OrderIndex).GetBytes();
+    }
+    std::size_t GetLevelBytes() const
+    {
+        return Get(OrderbookContainer::LevelMaps).GetBytes() + Get(OrderbookContainer::LevelData).GetBytes();
+    }
+    std::size_t GetTotalBytes() const { return objectBytes_ + GetOrderBytes() + GetLevelBytes(); }
+    double GetBytesPerOrder() const { return orders_ == 0 ? 0 : static_cast<double>(GetOrderBytes()) / static_cast<double>(orders_); }
+    double GetBytesPerLevel() const { return levels_ == 0 ? 0 : static_cast<double>(GetLevelBytes()) / static_cast<double>(levels_); }
+};
+
+// 节点大小探测：用记录分配大小的分配器构造同样的容器并插入一个元素
+//
+// 标准库容器的节点布局不依赖于（无状态的）分配器类型，因此探测到的大小与使用 std::allocator 的容器相同。
+// 只记录单个对象的分配，哈希表的桶数组（一次分配多个指针）不计入。结果是实现相关的，每个类型只需要探测一次。
+class NodeSizeProbe
+{
+public:
+    template<typename T>
+    class Allocator
+    {
+    public:
+        using value_type = T;
+
+        Allocator() = default;
+        template<typename U>
+        Allocator(const Allocator<U>&) { }
+
+        T* allocate(std::size_t count)
+        {
+            if (count == 1)
+                lastNodeBytes_ = sizeof(T);
+            return std::allocator<T>{ }.allocate(count);
+        }
+        void deallocate(T* pointer, std::size_t count) { std::allocator<T>{ }.deallocate(pointer, count); }
+
+        template<typename U>
+        bool operator==(const Allocator<U>&) const { return true; }
+    };
+
+    // std::list<T> 的节点
+    template<typename T>
+    static std::size_t GetListNodeBytes()
+    {
+        return Probe([] { std::list<T, Allocator<T>> list; list.emplace_back(); });
+    }
+
+    // std::map<Key, Value> 的节点
+    template<typename Key, typename Value>
+    static std::size_t GetMapNodeBytes()
+    {
+        return Probe([] { std::map<Key, Value, std::less<Key>, Allocator<std::pair<const Key, Value>>> map; map.try_emplace(Key{ }); });
+    }
+
+    // std::unordered_map<Key, Value> 的节点
+    template<typename Key, typename Value>
+    static std::size_t GetHashNodeBytes()
+    {
+        return Probe([] { std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, Allocator<std::pair<const Key, Value>>> map; map.try_emplace(Key{ }); });
+    }
+
+    // std::make_shared<T> 的分配（对象加控制块）；只用到 T 的大小和对齐，不要求 T 可以默认构造
+    template<typename T>
+    static std::size_t GetSharedObjectBytes()
+    {
+        struct alignas(T) Storage { std::byte bytes_[sizeof(T)]; };
+        return Probe([] { static_cast<void>(std::allocate_shared<Storage>(Allocator<Storage>{ })); });
+    }
+
+    // 哈希表桶数组的字节数：单个桶时 libstdc++ 使用表内的存储，不分配
+    template<typename HashMap>
+    static std::size_t GetBucketBytes(const HashMap& map)
+    {
+        return map.bucket_count() > 1 ? map.bucket_count() * sizeof(void*) : 0;
+    }
+
+private:
+    template<typename Function>
+    static std::size_t Probe(Function function)
+    {
+        lastNodeBytes_ = 0;
+        function();
+        return lastNodeBytes_;
+    }
+
+    static inline thread_local std::size_t lastNodeBytes_{ };
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+enum class OrderbookMode
+{
+	Matching,
+	Passive,
+};
+//Matching：本地撮合，新订单与对手方挂单交叉时成交。
+//Passive：镜像外部市场，订单直接挂入订单簿，从不撮合、不产生成交；成交和改单通过 ApplyExecution / ApplyReplace 从外部应用。
+
+enum class OrderbookPruning
+{
+	Clock,
+	Command,
+};
+//Clock：撮合模式下由后台线程按本地时钟在每天 16:00 撤销所有 GoodForDay 订单。
+//Command：不启动后台线程，只在执行 OrderbookCommandType::Prune 时撤销；回放日志的副本使用这种方式，清理发生在日志中与主节点相同的位置。被动模式总是如此（撤单由外部市场给出）。
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+enum class OrderbookOperation
+{
+	Add,
+	Cancel,
+	Modify,
+	Match,
+};
+//Add / Cancel / Modify：一次下单、撤单、改单在订单簿内部的处理，Add 和 Modify 包括其中的撮合。
+//Match：一次撮合过程，不论由下单还是改单触发。
+
+// 操作类型的个数，用于按类型索引的数组
+constexpr std::size_t OrderbookOperationCount = 4;
+
+// 锁统计按调用点区分
+enum class OrderbookLockSite
+{
+	AddOrder,
+	CancelOrder,
+	ModifyOrder,
+	ProcessCommands,
+	Apply,
+	Size,
+	GetChecksum,
+	CancelOrders,
+	Prune,
+	GetMemoryFootprint,
+	GetOrderInfos,
+	GetRemainingQuantities,
+};
+//Apply：被动模式的 ApplyExecution / ApplyReplace / ApplyCommands。
+//CancelOrders：清理线程批量撤销当日有效订单；Prune：清理线程收集当日有效订单。
+//清理线程等待条件变量和 SetListener 的加锁不统计。
+
+constexpr std::size_t OrderbookLockSiteCount = 12;
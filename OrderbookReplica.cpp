@@ -0,0 +1,188 @@
+#include "OrderbookReplica.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include "Orderbook.h"
+
+namespace
+{
+    // 日志消息对应的批量命令，与 ApplyJournalMessage 的处理相同
+    OrderbookCommand ToOrderbookCommand(const JournalMessage& message)
+    {
+        switch (message.type_)
+        {
+            case JournalMessageType::Add:
+                return { OrderbookCommandType::Add, message.orderType_, message.side_, message.price_, message.quantity_, message.orderId_ };
+            case JournalMessageType::Modify:
+                return { OrderbookCommandType::Modify, message.orderType_, message.side_, message.price_, message.quantity_, message.orderId_ };
+            case JournalMessageType::Cancel:
+                return { OrderbookCommandType::Cancel, message.orderType_, message.side_, message.price_, message.quantity_, message.orderId_ };
+            case JournalMessageType::Prune:
+                return { OrderbookCommandType::Prune, message.orderType_, message.side_, message.price_, message.quantity_, message.orderId_ };
+            default:
+                throw std::logic_error("Unsupported journal message.");
+        }
+    }
+}
+
+OrderbookReplica::OrderbookReplica(Orderbook& orderbook, const std::filesystem::path& journalPath)
+    : orderbook_{ RequireCommandPruning(orderbook) }
+    , journalPath_{ journalPath }
+    , reader_{ std::in_place, journalPath }
+{ }
+
+#ifndef _WIN32
+OrderbookReplica::OrderbookReplica(Orderbook& orderbook, int descriptor)
+    : orderbook_{ RequireCommandPruning(orderbook) }
+    , descriptor_{ descriptor }
+{
+    // 非阻塞读取，避免主节点空闲时 Poll 被阻塞
+    const int flags = fcntl(descriptor_, F_GETFL);
+    if (flags < 0 || fcntl(descriptor_, F_SETFL, flags | O_NONBLOCK) < 0)
+        throw std::runtime_error("Unable to make replica descriptor non-blocking.");
+
+    // 缓冲区至少能容纳两个最大长度的块
+    buffer_.resize(2 * (JournalFormat::BlockHeaderSize + JournalFormat::BlockPayloadSize));
+}
+#endif
+
+Orderbook& OrderbookReplica::RequireCommandPruning(Orderbook& orderbook)
+{
+    if (orderbook.PrunesOnClock())
+        throw std::logic_error("Replica orderbook must prune only when the journal replays a prune.");
+    return orderbook;
+}
+
+std::size_t OrderbookReplica::Poll()
+{
+    return reader_ ? PollFile() : PollDescriptor();
+}
+
+void OrderbookReplica::Run(const std::atomic<bool>& stop)
+{
+    // 有数据时连续应用；空闲时先让出 CPU，长时间空闲再短暂休眠
+    std::size_t idle{ };
+    while (!stop.load(std::memory_order_acquire))
+    {
+        if (Poll() > 0)
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < 1'000)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+ReplicaStatus OrderbookReplica::GetStatus() const
+{
+    return ReplicaStatus{
+        appliedSequence_.load(std::memory_order_acquire),
+        lastTimestamp_.load(std::memory_order_relaxed),
+        bytesBehind_.load(std::memory_order_relaxed),
+        checksum_.load(std::memory_order_relaxed) };
+}
+
+std::size_t OrderbookReplica::PollFile()
+{
+    std::size_t applied{ };
+    while (reader_->ReadBlock(messages_) > 0)
+        applied += ApplyBlock(reader_->GetNextSequence() - messages_.size());
+
+    // 文件中已写出但尚未应用的字节数（即末尾尚不完整的块）
+    std::error_code error;
+    const auto fileSize = std::filesystem::file_size(journalPath_, error);
+    if (!error)
+        bytesBehind_.store(fileSize > reader_->GetOffset() ? fileSize - reader_->GetOffset() : 0, std::memory_order_relaxed);
+
+    return applied;
+}
+
+std::size_t OrderbookReplica::PollDescriptor()
+{
+#ifndef _WIN32
+    std::size_t applied{ };
+
+    while (true)
+    {
+        // 尽可能多地读取已到达的数据
+        const auto received = read(descriptor_, buffer_.data() + bufferSize_, buffer_.size() - bufferSize_);
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            throw std::runtime_error("Replica descriptor read failed.");
+        if (received > 0)
+            bufferSize_ += static_cast<std::size_t>(received);
+
+        // 解码缓冲区中所有完整的块
+        std::size_t consumed{ };
+        while (bufferSize_ - consumed >= JournalFormat::BlockHeaderSize)
+        {
+            const char* header = buffer_.data() + consumed;
+            const auto blockHeader = DecodeJournalBlockHeader(header);
+            const auto blockBytes = JournalFormat::BlockHeaderSize + blockHeader.payloadSize_;
+            if (blockBytes > buffer_.size() / 2)
+                throw std::runtime_error("Journal block is too large.");
+            if (bufferSize_ - consumed < blockBytes)
+                break;
+            if (!VerifyJournalBlock(header, header + JournalFormat::BlockHeaderSize))
+                throw std::runtime_error("Journal block failed its checksum.");
+
+            applied += ApplyBlock(DecodeJournalBlock(header, header + JournalFormat::BlockHeaderSize, messages_));
+            consumed += blockBytes;
+        }
+
+        // 将不完整的块移动到缓冲区开头
+        if (consumed > 0)
+        {
+            std::memmove(buffer_.data(), buffer_.data() + consumed, bufferSize_ - consumed);
+            bufferSize_ -= consumed;
+        }
+
+        if (received <= 0)
+            break;
+    }
+
+    // 内核中尚未读取的字节 + 缓冲区中不完整的块
+    int pending{ };
+    if (ioctl(descriptor_, FIONREAD, &pending) < 0)
+        pending = 0;
+    bytesBehind_.store(bufferSize_ + static_cast<std::size_t>(pending), std::memory_order_relaxed);
+
+    return applied;
+#else
+    return 0;
+#endif
+}
+
+std::size_t OrderbookReplica::ApplyBlock(std::uint64_t firstSequence)
+{
+    if (messages_.empty())
+        return 0;
+
+    // 序号必须与已应用的序号连续，否则副本已经与主节点不一致
+    const auto applied = appliedSequence_.load(std::memory_order_relaxed);
+    if (firstSequence != applied + 1)
+        throw std::runtime_error("Replica detected a gap in the journal sequence.");
+
+    commands_.clear();
+    for (const auto& message : messages_)
+        commands_.push_back(ToOrderbookCommand(message));
+    const auto checksum = orderbook_.ProcessCommands(commands_, trades_);
+    trades_.clear();
+
+    lastTimestamp_.store(messages_.back().timestamp_, std::memory_order_relaxed);
+    checksum_.store(checksum, std::memory_order_relaxed);
+    appliedSequence_.store(applied + messages_.size(), std::memory_order_release);
+    return messages_.size();
+}
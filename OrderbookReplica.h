@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "Journal.h"     // 包含日志的块格式与解码函数
+#include "OrderbookCommand.h" // 包含批量接口使用的订单簿命令
+
+class Orderbook;
+
+// 副本的追赶状态
+struct ReplicaStatus
+{
+    std::uint64_t appliedSequence_;  // 已应用的最后一条消息的序号，0 表示尚未应用任何消息
+    std::uint64_t lastTimestamp_;    // 已应用的最后一条消息的时间戳（纳秒）
+    std::uint64_t bytesBehind_;      // 已经到达副本但尚未应用的字节数
+    std::uint64_t checksum_;         // 应用到 appliedSequence_ 时订单簿的校验和，可与主节点同一序号的校验和比对
+};
+
+// 热备副本：持续跟随主节点写出的日志，将消息应用到本地订单簿
+//
+// 日志来源可以是主节点正在写入的日志文件（或命名管道），
+// 也可以是一个传输同样块格式的文件描述符（管道或已连接的 Unix 套接字）。
+// 只有完整的块才会被应用，因此主节点需要按时间阈值调用 JournalWriter::Flush 来控制副本的最大滞后。
+// 当日有效订单的清理必须以 JournalMessageType::Prune 写入日志：副本的订单簿需要以 OrderbookPruning::Command 构造，
+// 只在回放到 Prune 消息时清理，否则两边按各自的时钟清理，会在清理前后短暂不一致。
+class OrderbookReplica
+{
+public:
+    // 跟随日志文件；orderbook 按本地时钟清理当日有效订单时抛出 std::logic_error
+    OrderbookReplica(Orderbook& orderbook, const std::filesystem::path& journalPath);
+#ifndef _WIN32
+    // 跟随文件描述符（管道或 Unix 套接字），描述符会被设置为非阻塞模式，所有权仍归调用方
+    OrderbookReplica(Orderbook& orderbook, int descriptor);
+#endif
+    OrderbookReplica(const OrderbookReplica&) = delete;
+    void operator=(const OrderbookReplica&) = delete;
+
+    // 应用当前所有已到达的完整块，返回应用的消息数
+    std::size_t Poll();
+    // 持续追赶，直到 stop 被置为 true
+    void Run(const std::atomic<bool>& stop);
+
+    // 获取追赶状态，可以在其他线程调用
+    ReplicaStatus GetStatus() const;
+
+private:
+    std::size_t PollFile();
+    std::size_t PollDescriptor();
+    // 按本地时钟清理的订单簿不能作为副本
+    static Orderbook& RequireCommandPruning(Orderbook& orderbook);
+    // 应用一个块内的所有消息（整块一次 ProcessCommands，只加一次锁，校验和也在同一次加锁内读取），并检查序号是否连续
+    std::size_t ApplyBlock(std::uint64_t firstSequence);
+
+    Orderbook& orderbook_;                        // 被维护的订单簿
+    std::filesystem::path journalPath_;           // 日志文件路径（文件模式）
+    std::optional<JournalReader> reader_;         // 日志读取器（文件模式）
+    int descriptor_{ -1 };                        // 文件描述符（描述符模式）
+    std::vector<char> buffer_;                    // 描述符模式下的接收缓冲区
+    std::size_t bufferSize_{ };                   // 接收缓冲区中尚未解码的字节数
+    JournalMessages messages_;                    // 解码结果，重复使用以避免分配
+    OrderbookCommands commands_;                  // 一个块转换成的批量命令，重复使用以避免分配
+    Trades trades_;                               // 应用一个块产生的成交，副本不使用，只是重复使用以避免分配
+
+    std::atomic<std::uint64_t> appliedSequence_{ };
+    std::atomic<std::uint64_t> lastTimestamp_{ };
+    std::atomic<std::uint64_t> bytesBehind_{ };
+    std::atomic<std::uint64_t> checksum_{ };
+};
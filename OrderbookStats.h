@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "OrderType.h"   // 包含订单类型的定义
+#include "Usings.h"      // 包含类型定义，如 Quantity
+
+// 订单簿累计计数器的快照，自构造起累计，不会清零
+struct OrderbookStats
+{
+    std::array<std::uint64_t, 5> adds_{ };      // 收到的新订单，按 OrderType 的顺序（包括重复 ID 而被忽略的）
+    std::uint64_t cancels_{ };                  // 收到的撤单（包括订单不存在而被忽略的）
+    std::uint64_t prunedOrders_{ };             // 每日清理撤销的 GoodForDay 订单
+    std::uint64_t modifies_{ };                 // 收到的改单，包括被动模式下的 Replace
+    std::uint64_t rejectedFillOrKill_{ };       // 无法全部成交而被拒绝的 FillOrKill 订单
+    std::uint64_t rejectedFillAndKill_{ };      // 无法成交而被拒绝的 FillAndKill 订单
+    std::uint64_t trades_{ };                   // 撮合产生的成交笔数
+    std::uint64_t matchedQuantity_{ };          // 撮合成交的总数量
+    std::uint64_t levelsCreated_{ };            // 新建的价格级别（买卖双方合计）
+    std::uint64_t levelsDestroyed_{ };          // 删除的价格级别
+    std::uint64_t peakOrders_{ };               // 挂单数的峰值
+    std::uint64_t peakLevels_{ };               // 价格级别数的峰值（买卖双方合计）
+};
+
+// 订单簿的累计计数器
+//
+// 只由持有订单簿锁的线程更新，因此更新用 relaxed 的 load + store 代替原子读-改-写，在 x86 上就是普通的读写指令；
+// 计数器独占缓存行，不与订单簿的其他成员共享。GetSnapshot 可以在任意线程无锁调用，各计数器分别读取，彼此之间不保证一致。
+class alignas(64) OrderbookCounters
+{
+public:
+    void OnAdd(OrderType orderType) { Increment(adds_[static_cast<std::size_t>(orderType)]); }
+    void OnCancel() { Increment(cancels_); }
+    void OnPruned(std::size_t orders) { Increment(prunedOrders_, orders); }
+    void OnModify() { Increment(modifies_); }
+    void OnRejected(OrderType orderType) { Increment(orderType == OrderType::FillOrKill ? rejectedFillOrKill_ : rejectedFillAndKill_); }
+    void OnTrade(Quantity quantity)
+    {
+        Increment(trades_);
+        Increment(matchedQuantity_, quantity);
+    }
+    // orders 为挂入之后的挂单数
+    void OnOrderInserted(std::size_t orders) { UpdatePeak(peakOrders_, orders); }
+    // levels 为新建之后的价格级别数
+    void OnLevelCreated(std::size_t levels)
+    {
+        Increment(levelsCreated_);
+        UpdatePeak(peakLevels_, levels);
+    }
+    void OnLevelDestroyed() { Increment(levelsDestroyed_); }
+
+    OrderbookStats GetSnapshot() const
+    {
+        OrderbookStats stats;
+        for (std::size_t index = 0; index < adds_.size(); ++index)
+            stats.adds_[index] = adds_[index].load(std::memory_order_relaxed);
+        stats.cancels_ = cancels_.load(std::memory_order_relaxed);
+        stats.prunedOrders_ = prunedOrders_.load(std::memory_order_relaxed);
+        stats.modifies_ = modifies_.load(std::memory_order_relaxed);
+        stats.rejectedFillOrKill_ = rejectedFillOrKill_.load(std::memory_order_relaxed);
+        stats.rejectedFillAndKill_ = rejectedFillAndKill_.load(std::memory_order_relaxed);
+        stats.trades_ = trades_.load(std::memory_order_relaxed);
+        stats.matchedQuantity_ = matchedQuantity_.load(std::memory_order_relaxed);
+        stats.levelsCreated_ = levelsCreated_.load(std::memory_order_relaxed);
+        stats.levelsDestroyed_ = levelsDestroyed_.load(std::memory_order_relaxed);
+        stats.peakOrders_ = peakOrders_.load(std::memory_order_relaxed);
+        stats.peakLevels_ = peakLevels_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    static void Increment(std::atomic<std::uint64_t>& counter, std::uint64_t value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static void UpdatePeak(std::atomic<std::uint64_t>& peak, std::uint64_t value)
+    {
+        if (value > peak.load(std::memory_order_relaxed))
+            peak.store(value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, 5> adds_{ };
+    std::atomic<std::uint64_t> cancels_{ };
+    std::atomic<std::uint64_t> prunedOrders_{ };
+    std::atomic<std::uint64_t> modifies_{ };
+    std::atomic<std::uint64_t> rejectedFillOrKill_{ };
+    std::atomic<std::uint64_t> rejectedFillAndKill_{ };
+    std::atomic<std::uint64_t> trades_{ };
+    std::atomic<std::uint64_t> matchedQuantity_{ };
+    std::atomic<std::uint64_t> levelsCreated_{ };
+    std::atomic<std::uint64_t> levelsDestroyed_{ };
+    std::atomic<std::uint64_t> peakOrders_{ };
+    std::atomic<std::uint64_t> peakLevels_{ };
+};
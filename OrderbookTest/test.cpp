@@ -1,6 +1,22 @@
 #include "pch.h"
 
 #include "../Orderbook.h"  // 引入 Orderbook 类的定义
+#include "../Journal.h"    // 引入订单日志的编码与解码
+#include "../OrderbookReplica.h"  // 引入热备副本
+#include "../TradeTape.h"  // 引入成交记录磁带
+#include "../ColumnarExport.h"  // 引入列式导出
+#include "../BinaryProtocol.h"  // 引入二进制订单录入协议
+#include "../FixProtocol.h"  // 引入 FIX 订单录入协议
+#include "../OrderSessionRouter.h"  // 引入会话订单路由
+#include "../OrderFileParser.h"  // 引入流式订单文件解析器
+#include "../OrderFlowGenerator.h"  // 引入合成订单流生成器
+#include "../LatencyHistogram.h"  // 引入延迟直方图
+#include "../AllocationTracking.h"  // 引入分配计数
+#include "../MarketByOrderFeed.h"  // 引入逐笔委托行情回放
+#include "../OrderGateway.h"  // 引入 TCP 订单网关
+#include "../SharedMemoryOrderServer.h"  // 引入共享内存订单录入服务端
+#include "../SharedMemoryOrderClient.h"  // 引入共享内存订单录入客户端
+#include "../MarketDataFeed.h"  // 引入共享内存行情广播
 
 namespace googletest = ::testing;  // 为 Google Test 命名空间定义别名
 
@@ -294,13 +310,2308 @@ TEST_P(OrderbookTestsFixture, OrderbookTestSuite)
     ASSERT_EQ(orderbookInfos.GetAsks().size(), result.askCount_); // 检查卖单的数量
 }
 
+// 同一组测试文件编码为二进制消息后，经零拷贝解码分发，结果应与直接调用一致
+TEST_P(OrderbookTestsFixture, OrderbookBinaryTestSuite)
+{
+    // Arrange: 准备阶段
+    const auto file = OrderbookTestsFixture::TestFolderPath / GetParam(); // 获取测试文件的完整路径
+
+    InputHandler handler;
+    const auto [actions, result] = handler.GetInformations(file); // 从文件中获取动作和预期结果
+
+    // 将所有动作编码为二进制消息
+    std::vector<char> buffer(actions.size() * sizeof(AddOrderMessage));
+    std::size_t size{ };
+    for (const auto& action : actions)
+    {
+        switch (action.type_)
+        {
+            case ActionType::Add:
+                size += EncodeAddOrder(buffer.data() + size, action.orderId_, action.side_, action.orderType_, action.price_, action.quantity_);
+                break;
+            case ActionType::Modify:
+                size += EncodeModifyOrder(buffer.data() + size, action.orderId_, action.side_, action.price_, action.quantity_);
+                break;
+            case ActionType::Cancel:
+                size += EncodeCancelOrder(buffer.data() + size, action.orderId_);
+                break;
+            default:
+                throw std::logic_error("Unsupported Action.");
+        }
+    }
+
+    // Act: 执行阶段，每次只交给解码器 7 个字节，模拟消息被拆分到多次接收中
+    Orderbook orderbook;
+    std::size_t received{ }, consumed{ };
+    while (consumed < size)
+    {
+        received = std::min(size, received + 7);
+        consumed += DispatchBinaryMessages(orderbook, buffer.data() + consumed, received - consumed).consumed_;
+    }
+
+    // Assert: 断言阶段，检查结果是否符合预期
+    const auto& orderbookInfos = orderbook.GetOrderInfos();
+    ASSERT_EQ(orderbook.Size(), result.allCount_); // 检查订单簿中的订单总数
+    ASSERT_EQ(orderbookInfos.GetBids().size(), result.bidCount_); // 检查买单的数量
+    ASSERT_EQ(orderbookInfos.GetAsks().size(), result.askCount_); // 检查卖单的数量
+}
+
+// 同一组测试文件经流式解析器按批回放，结果应与直接调用一致
+TEST_P(OrderbookTestsFixture, OrderbookStreamingTestSuite)
+{
+    // Arrange: 准备阶段
+    const auto file = OrderbookTestsFixture::TestFolderPath / GetParam(); // 获取测试文件的完整路径
+
+    // Act: 执行阶段，每批两条命令
+    Orderbook orderbook;
+    const auto replay = ReplayOrderFile(orderbook, file, 2);
+
+    // Assert: 断言阶段，检查结果是否符合预期
+    ASSERT_TRUE(replay.result_.has_value());
+    const auto& orderbookInfos = orderbook.GetOrderInfos();
+    ASSERT_EQ(orderbook.Size(), replay.result_->allCount_); // 检查订单簿中的订单总数
+    ASSERT_EQ(orderbookInfos.GetBids().size(), replay.result_->bidCount_); // 检查买单的数量
+    ASSERT_EQ(orderbookInfos.GetAsks().size(), replay.result_->askCount_); // 检查卖单的数量
+}
+
 // 使用参数化测试，将多个测试文件传递给测试用例
 INSTANTIATE_TEST_SUITE_P(Tests, OrderbookTestsFixture, googletest::ValuesIn({
         "Match_GoodTillCancel.txt",
         "Match_FillAndKill.txt",
+        "Match_FillAndKill_Partial.txt",
         "Match_FillOrKill_Hit.txt",
         "Match_FillOrKill_Miss.txt",
         "Cancel_Success.txt",
         "Modify_Side.txt",
         "Match_Market.txt"
 }));
+
+// 构造日志测试使用的消息序列：价格集中在少数价位附近，订单 ID 递增
+static JournalMessages MakeJournalMessages(std::size_t count)
+{
+    JournalMessages messages;
+    messages.reserve(count);
+    std::uint64_t timestamp = 1'700'000'000'000'000'000;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto side = i % 2 == 0 ? Side::Buy : Side::Sell;
+        const auto orderId = static_cast<OrderId>(i / 3 + 1);
+        const auto price = static_cast<Price>(side == Side::Buy ? 100 - i % 7 : 110 + i % 5);
+        timestamp += 150 + i % 40;
+
+        if (i % 3 == 0)
+            messages.push_back(JournalMessage{ JournalMessageType::Add, OrderType::GoodTillCancel, side, price, static_cast<Quantity>(1 + i % 50), orderId, timestamp });
+        else if (i % 3 == 1)
+            messages.push_back(JournalMessage{ JournalMessageType::Modify, OrderType::GoodTillCancel, side, price + 1, 10, orderId, timestamp });
+        else
+            messages.push_back(JournalMessage{ JournalMessageType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, orderId, timestamp });
+    }
+    return messages;
+}
+
+// 比较两条日志消息是否一致（取消消息不携带价格和数量）
+static void ExpectSameJournalMessage(const JournalMessage& expected, const JournalMessage& actual)
+{
+    ASSERT_EQ(expected.type_, actual.type_);
+    ASSERT_EQ(expected.orderId_, actual.orderId_);
+    ASSERT_EQ(expected.timestamp_, actual.timestamp_);
+    if (expected.type_ == JournalMessageType::Cancel)
+        return;
+    ASSERT_EQ(expected.orderType_, actual.orderType_);
+    ASSERT_EQ(expected.side_, actual.side_);
+    ASSERT_EQ(expected.price_, actual.price_);
+    ASSERT_EQ(expected.quantity_, actual.quantity_);
+}
+
+// 日志编码后再解码，应得到完全相同的消息，并且比定长记录更紧凑
+TEST(JournalTests, RoundTrip)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalRoundTrip.bin";
+    const auto messages = MakeJournalMessages(50'000);
+
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+            writer.Append(message);
+    }
+
+    ASSERT_LT(std::filesystem::file_size(path), messages.size() * sizeof(JournalMessage) / 3);
+
+    JournalReader reader{ path };
+    ASSERT_GT(reader.GetIndex().size(), 1u);
+
+    JournalMessages block;
+    std::size_t position{ };
+    while (reader.ReadBlock(block) > 0)
+        for (const auto& message : block)
+            ExpectSameJournalMessage(messages[position++], message);
+    ASSERT_EQ(position, messages.size());
+}
+
+// 借助块索引定位到任意序号
+TEST(JournalTests, SeekToSequence)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalSeek.bin";
+    const auto messages = MakeJournalMessages(50'000);
+
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+            writer.Append(message);
+    }
+
+    JournalReader reader{ path };
+    JournalMessages block;
+    for (std::uint64_t sequence : { 1ull, 12'345ull, 49'999ull, 50'000ull })
+    {
+        ASSERT_TRUE(reader.Seek(sequence));
+        ASSERT_EQ(reader.GetNextSequence(), sequence);
+        ASSERT_GT(reader.ReadBlock(block), 0u);
+        ExpectSameJournalMessage(messages[sequence - 1], block.front());
+    }
+}
+
+// 进程崩溃后日志末尾的块只写了一部分：恢复时只读取少量块即可找到最后一条有效消息
+TEST(JournalTests, RecoversFromTornTail)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalTorn.bin";
+    const auto messages = MakeJournalMessages(50'000);
+
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+            writer.Append(message);
+    }
+
+    const auto index = JournalReader{ path }.GetIndex();
+    ASSERT_GT(index.size(), 2u);
+    const auto fileSize = std::filesystem::file_size(path);
+    const auto lastBlock = index.back();
+
+    // 截掉最后一个块的后半部分
+    std::filesystem::resize_file(path, lastBlock.offset_ + (fileSize - lastBlock.offset_) / 2);
+
+    const auto recovery = RecoverJournal(path);
+    ASSERT_EQ(recovery.lastSequence_, lastBlock.firstSequence_ - 1);
+    ASSERT_EQ(recovery.validBytes_, lastBlock.offset_);
+    ASSERT_LE(recovery.blocksRead_, 3u);
+
+    // 读取时不完整的块不会被当作有效数据
+    {
+        JournalReader reader{ path };
+        JournalMessages block;
+        std::size_t count{ };
+        while (reader.ReadBlock(block) > 0)
+            count += block.size();
+        ASSERT_EQ(count, recovery.lastSequence_);
+    }
+
+    // 截断后索引与日志一致，可以继续定位
+    TruncateJournal(path);
+    ASSERT_EQ(std::filesystem::file_size(path), recovery.validBytes_);
+    JournalReader reader{ path };
+    ASSERT_EQ(reader.GetIndex().size(), index.size() - 1);
+    ASSERT_TRUE(reader.Seek(recovery.lastSequence_));
+    JournalMessages block;
+    ASSERT_EQ(reader.ReadBlock(block), 1u);
+    ExpectSameJournalMessage(messages[recovery.lastSequence_ - 1], block.front());
+}
+
+// 主节点重启后以 Resume 方式续写：丢弃不完整的末尾，序号接着最后一条有效消息，续写后的日志可以完整回放和定位
+TEST(JournalTests, ResumesAfterRecovery)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalResume.bin";
+    const auto messages = MakeJournalMessages(50'000);
+
+    {
+        JournalWriter writer{ path };
+        for (std::size_t index = 0; index < 30'000; ++index)
+            writer.Append(messages[index]);
+    }
+
+    // 截掉最后一个块的一部分，模拟崩溃
+    const auto lastBlock = JournalReader{ path }.GetIndex().back();
+    std::filesystem::resize_file(path, lastBlock.offset_ + JournalFormat::BlockHeaderSize + 1);
+    const auto recovery = RecoverJournal(path);
+    ASSERT_EQ(recovery.lastSequence_, lastBlock.firstSequence_ - 1);
+
+    {
+        JournalWriter writer{ path, JournalOpenMode::Resume };
+        ASSERT_EQ(writer.GetNextSequence(), recovery.lastSequence_ + 1);
+        for (auto index = recovery.lastSequence_; index < messages.size(); ++index)
+            ASSERT_EQ(writer.Append(messages[index]), index + 1);
+    }
+
+    const auto resumed = RecoverJournal(path);
+    ASSERT_EQ(resumed.lastSequence_, messages.size());
+    ASSERT_EQ(resumed.tornBytes_, 0u);
+
+    JournalReader reader{ path };
+    JournalMessages block;
+    std::size_t position{ };
+    while (reader.ReadBlock(block) > 0)
+        for (const auto& message : block)
+            ExpectSameJournalMessage(messages[position++], message);
+    ASSERT_EQ(position, messages.size());
+
+    for (std::uint64_t sequence : { recovery.lastSequence_, recovery.lastSequence_ + 1, std::uint64_t{ 49'999 } })
+    {
+        ASSERT_TRUE(reader.Seek(sequence));
+        ASSERT_GT(reader.ReadBlock(block), 0u);
+        ExpectSameJournalMessage(messages[sequence - 1], block.front());
+    }
+}
+
+// 块内容被破坏时 CRC 校验失败
+TEST(JournalTests, DetectsCorruptedBlock)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalCorrupt.bin";
+    const auto messages = MakeJournalMessages(50'000);
+
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+            writer.Append(message);
+    }
+
+    const auto index = JournalReader{ path }.GetIndex();
+    ASSERT_GT(index.size(), 2u);
+
+    // 修改最后一个块负载中的一个字节
+    {
+        std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+        file.seekp(static_cast<std::streamoff>(index.back().offset_ + JournalFormat::BlockHeaderSize + 10));
+        file.put('\x7F');
+    }
+
+    const auto recovery = RecoverJournal(path);
+    ASSERT_EQ(recovery.lastSequence_, index.back().firstSequence_ - 1);
+    ASSERT_GT(recovery.tornBytes_, 0u);
+}
+
+// 回放日志应得到与直接调用相同的订单簿
+TEST(JournalTests, ReplayIntoOrderbook)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_JournalReplay.bin";
+    const auto messages = MakeJournalMessages(3'000);
+
+    Orderbook expected;
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+        {
+            writer.Append(message);
+            ApplyJournalMessage(expected, message);
+        }
+    }
+
+    Orderbook replayed;
+    JournalReader reader{ path };
+    JournalMessages block;
+    while (reader.ReadBlock(block) > 0)
+        for (const auto& message : block)
+            ApplyJournalMessage(replayed, message);
+
+    ASSERT_EQ(replayed.Size(), expected.Size());
+    ASSERT_EQ(replayed.GetOrderInfos().GetBids().size(), expected.GetOrderInfos().GetBids().size());
+    ASSERT_EQ(replayed.GetOrderInfos().GetAsks().size(), expected.GetOrderInfos().GetAsks().size());
+    ASSERT_EQ(replayed.GetChecksum(), expected.GetChecksum());
+}
+
+// 副本跟随正在写入的日志文件：只应用完整的块，主节点 Flush 后即可追上
+TEST(ReplicaTests, FollowsJournalFile)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_ReplicaFile.bin";
+    const auto messages = MakeJournalMessages(6'000);
+
+    Orderbook primary{ OrderbookMode::Matching, OrderbookPruning::Command };
+    Orderbook mirror{ OrderbookMode::Matching, OrderbookPruning::Command };
+    JournalWriter writer{ path };
+    OrderbookReplica replica{ mirror, path };
+
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        writer.Append(messages[i]);
+        ApplyJournalMessage(primary, messages[i]);
+
+        // 每 1000 条消息落盘一次并让副本追赶
+        if ((i + 1) % 1'000 == 0)
+        {
+            writer.Sync();
+            replica.Poll();
+            ASSERT_EQ(replica.GetStatus().appliedSequence_, i + 1);
+            ASSERT_EQ(replica.GetStatus().bytesBehind_, 0u);
+            ASSERT_EQ(mirror.Size(), primary.Size());
+            ASSERT_EQ(replica.GetStatus().checksum_, primary.GetChecksum());
+        }
+    }
+}
+
+// 副本只在回放到日志中的清理消息时撤销当日有效订单，按本地时钟清理的订单簿不能作为副本
+TEST(ReplicaTests, PrunesOnlyWhenJournalReplaysPrune)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_ReplicaPrune.bin";
+
+    Orderbook clocked;
+    ASSERT_TRUE(clocked.PrunesOnClock());
+    ASSERT_THROW((OrderbookReplica{ clocked, path }), std::logic_error);
+
+    Orderbook primary{ OrderbookMode::Matching, OrderbookPruning::Command };
+    Orderbook mirror{ OrderbookMode::Matching, OrderbookPruning::Command };
+    ASSERT_FALSE(primary.PrunesOnClock());
+    JournalWriter writer{ path };
+    OrderbookReplica replica{ mirror, path };
+
+    const JournalMessages messages{
+        { JournalMessageType::Add, OrderType::GoodForDay, Side::Buy, 100, 10, 1, 1 },
+        { JournalMessageType::Add, OrderType::GoodTillCancel, Side::Buy, 99, 10, 2, 2 },
+        { JournalMessageType::Add, OrderType::GoodForDay, Side::Sell, 105, 10, 3, 3 },
+        { JournalMessageType::Prune, OrderType::GoodTillCancel, Side::Buy, 0, 0, 0, 4 },
+        { JournalMessageType::Add, OrderType::GoodForDay, Side::Sell, 106, 10, 4, 5 },
+    };
+    for (const auto& message : messages)
+    {
+        writer.Append(message);
+        ApplyJournalMessage(primary, message);
+    }
+    writer.Sync();
+
+    ASSERT_EQ(replica.Poll(), messages.size());
+    ASSERT_EQ(primary.Size(), 2u);
+    ASSERT_EQ(mirror.Size(), 2u);
+    ASSERT_EQ(mirror.GetStats().prunedOrders_, 2u);
+    ASSERT_EQ(replica.GetStatus().checksum_, primary.GetChecksum());
+    ASSERT_EQ(replica.GetStatus().checksum_, mirror.GetChecksum());
+}
+
+#ifndef _WIN32
+#include <unistd.h>
+
+// 副本跟随管道：块可能被拆成多次到达，未完整的块计入滞后字节数
+TEST(ReplicaTests, FollowsPipe)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_ReplicaPipe.bin";
+    const auto messages = MakeJournalMessages(3'000);
+
+    Orderbook primary;
+    {
+        JournalWriter writer{ path };
+        for (const auto& message : messages)
+        {
+            writer.Append(message);
+            ApplyJournalMessage(primary, message);
+        }
+    }
+
+    std::ifstream file{ path, std::ios::binary };
+    const std::string bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{ } };
+
+    int descriptors[2];
+    ASSERT_EQ(pipe(descriptors), 0);
+
+    Orderbook mirror{ OrderbookMode::Matching, OrderbookPruning::Command };
+    OrderbookReplica replica{ mirror, descriptors[0] };
+
+    // 先发送除最后 10 个字节外的所有数据
+    ASSERT_EQ(write(descriptors[1], bytes.data(), bytes.size() - 10), static_cast<ssize_t>(bytes.size() - 10));
+    replica.Poll();
+    ASSERT_LT(replica.GetStatus().appliedSequence_, messages.size());
+    ASSERT_GT(replica.GetStatus().bytesBehind_, 0u);
+
+    ASSERT_EQ(write(descriptors[1], bytes.data() + bytes.size() - 10, 10), 10);
+    replica.Poll();
+    ASSERT_EQ(replica.GetStatus().appliedSequence_, messages.size());
+    ASSERT_EQ(replica.GetStatus().bytesBehind_, 0u);
+    ASSERT_EQ(mirror.Size(), primary.Size());
+
+    close(descriptors[0]);
+    close(descriptors[1]);
+}
+#endif
+
+// 校验和覆盖队列顺序：相同的订单以不同顺序排队时校验和不同
+TEST(ChecksumTests, ReflectsQueueOrder)
+{
+    Orderbook first;
+    first.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    first.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 100, 10));
+
+    Orderbook second;
+    second.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 100, 10));
+    second.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+
+    ASSERT_EQ(first.GetOrderInfos().GetBids().size(), second.GetOrderInfos().GetBids().size());
+    ASSERT_NE(first.GetChecksum(), second.GetChecksum());
+}
+
+// 增量更新的校验和与从头构建的订单簿一致
+TEST(ChecksumTests, MatchesFreshlyBuiltBook)
+{
+    Orderbook orderbook;
+    ASSERT_EQ(orderbook.GetChecksum(), 0u);
+
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Sell, 101, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Sell, 101, 5));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 3, Side::Sell, 101, 7));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 4, Side::Buy, 99, 3));
+    orderbook.CancelOrder(2);                                                                      // 从队列中间删除
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 5, Side::Buy, 101, 12)); // 吃掉订单 1 并部分成交订单 3
+
+    Orderbook expected;
+    expected.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 3, Side::Sell, 101, 5));
+    expected.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 4, Side::Buy, 99, 3));
+    ASSERT_EQ(orderbook.GetChecksum(), expected.GetChecksum());
+
+    orderbook.CancelOrder(3);
+    orderbook.CancelOrder(4);
+    ASSERT_EQ(orderbook.GetChecksum(), 0u);
+}
+
+// 异步写入器：缓冲区很小时也能按顺序完整写出所有数据（包括链接 fsync 的模式）
+TEST(AsyncFileWriterTests, WritesAllDataInOrder)
+{
+    for (bool syncEachWrite : { false, true })
+    {
+        const auto path = std::filesystem::temp_directory_path() / "Orderbook_AsyncFileWriter.bin";
+        std::string expected;
+
+        {
+            AsyncFileWriter writer{ path, AsyncFileWriterOptions{ 4 * 1024, 4, syncEachWrite } };
+            for (std::uint32_t i = 0; i < 20'000; ++i)
+            {
+                const auto line = std::to_string(i) + "\n";
+                writer.Write(line.data(), line.size());
+                expected += line;
+            }
+        }
+
+        std::ifstream file{ path, std::ios::binary };
+        const std::string actual{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{ } };
+        ASSERT_EQ(actual, expected);
+    }
+}
+
+// 成交记录磁带按顺序记录每笔成交
+TEST(TradeTapeTests, RecordsTrades)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_TradeTape.bin";
+
+    Orderbook orderbook;
+    {
+        TradeTapeWriter tape{ path };
+        tape.Append(orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Sell, 100, 5)), 1);
+        tape.Append(orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Sell, 101, 5)), 2);
+        tape.Append(orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 3, Side::Buy, 101, 8)), 3);
+    }
+
+    const auto records = ReadTradeTape(path);
+    ASSERT_EQ(records.size(), 2u);
+    ASSERT_EQ(records[0].askOrderId_, 1u);
+    ASSERT_EQ(records[0].quantity_, 5u);
+    ASSERT_EQ(records[1].bidOrderId_, 3u);
+    ASSERT_EQ(records[1].askOrderId_, 2u);
+    ASSERT_EQ(records[1].askPrice_, 101);
+    ASSERT_EQ(records[1].quantity_, 3u);
+    ASSERT_EQ(records[1].timestamp_, 3u);
+}
+
+// 列式导出：跨越多个行组的成交与价格级别变化可以按列读回，级别变化重建出的订单簿与原订单簿一致
+TEST(ColumnarExportTests, ExportsTradesAndLevelDeltas)
+{
+    const auto tradesPath = std::filesystem::temp_directory_path() / "Orderbook_Columnar.trades";
+    const auto levelsPath = std::filesystem::temp_directory_path() / "Orderbook_Columnar.levels";
+
+    Orderbook orderbook;
+    Trades expected;
+    {
+        ColumnarExporter exporter{ tradesPath, levelsPath, 7 };
+        orderbook.SetListener(&exporter);
+        for (OrderId orderId = 1; orderId <= 200; ++orderId)
+        {
+            exporter.SetTimestamp(orderId * 10);
+            const auto side = orderId % 2 == 0 ? Side::Buy : Side::Sell;
+            const auto price = static_cast<Price>(side == Side::Buy ? 95 + orderId % 7 : 98 + orderId % 5);
+            const auto trades = orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, side, price, static_cast<Quantity>(1 + orderId % 4)));
+            expected.insert(expected.end(), trades.begin(), trades.end());
+            if (orderId % 9 == 0)
+                orderbook.CancelOrder(orderId - 3);
+        }
+        orderbook.SetListener(nullptr);
+        exporter.Sync();
+        ASSERT_EQ(exporter.GetTrades().GetRowCount(), expected.size());
+    }
+    ASSERT_GT(expected.size(), 7u);
+
+    ColumnarReader trades{ tradesPath };
+    ASSERT_EQ(trades.GetSchema(), ColumnarSchema::Trades);
+    ASSERT_EQ(trades.GetRowCount(), expected.size());
+    ASSERT_EQ(trades.GetRowGroupCount(), (expected.size() + 6) / 7);
+    std::size_t row{ };
+    for (std::size_t group = 0; group < trades.GetRowGroupCount(); ++group)
+    {
+        const auto bidOrderIds = trades.GetColumn<OrderId>(group, TradeColumn::BidOrderId);
+        const auto askPrices = trades.GetColumn<Price>(group, TradeColumn::AskPrice);
+        const auto quantities = trades.GetColumn<Quantity>(group, TradeColumn::Quantity);
+        const auto timestamps = trades.GetColumn<std::uint64_t>(group, TradeColumn::Timestamp);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(quantities.data()) % ColumnarFormat::Alignment, 0u);
+        for (std::size_t index = 0; index < quantities.size(); ++index, ++row)
+        {
+            const auto& trade = expected[row];
+            ASSERT_EQ(bidOrderIds[index], trade.GetBidTrade().orderId_);
+            ASSERT_EQ(askPrices[index], trade.GetAskTrade().price_);
+            ASSERT_EQ(quantities[index], trade.GetBidTrade().quantity_);
+            ASSERT_EQ(timestamps[index], std::max(trade.GetBidTrade().orderId_, trade.GetAskTrade().orderId_) * 10);
+        }
+    }
+    ASSERT_THROW(trades.GetColumn<std::uint64_t>(0, TradeColumn::Quantity), std::logic_error);
+
+    ColumnarReader levels{ levelsPath };
+    ASSERT_EQ(levels.GetSchema(), ColumnarSchema::LevelDeltas);
+    std::map<Price, Quantity, std::greater<Price>> bids;
+    std::map<Price, Quantity> asks;
+    for (std::size_t group = 0; group < levels.GetRowGroupCount(); ++group)
+    {
+        const auto sides = levels.GetColumn<std::uint8_t>(group, LevelColumn::Side);
+        const auto prices = levels.GetColumn<Price>(group, LevelColumn::Price);
+        const auto quantities = levels.GetColumn<Quantity>(group, LevelColumn::Quantity);
+        const auto counts = levels.GetColumn<Quantity>(group, LevelColumn::Count);
+        for (std::size_t index = 0; index < sides.size(); ++index)
+        {
+            const auto apply = [&](auto& book)
+            {
+                if (counts[index] == 0)
+                    book.erase(prices[index]);
+                else
+                    book[prices[index]] = quantities[index];
+            };
+            if (static_cast<Side>(sides[index]) == Side::Buy)
+                apply(bids);
+            else
+                apply(asks);
+        }
+    }
+
+    const auto infos = orderbook.GetOrderInfos();
+    ASSERT_EQ(bids.size(), infos.GetBids().size());
+    ASSERT_EQ(asks.size(), infos.GetAsks().size());
+    auto bid = bids.begin();
+    for (const auto& level : infos.GetBids())
+    {
+        ASSERT_EQ(bid->first, level.price_);
+        ASSERT_EQ((bid++)->second, level.quantity_);
+    }
+
+    // 末尾不完整的行组被忽略
+    const auto size = std::filesystem::file_size(levelsPath);
+    std::filesystem::resize_file(levelsPath, size - 5);
+    ColumnarReader torn{ levelsPath };
+    ASSERT_EQ(torn.GetRowGroupCount(), levels.GetRowGroupCount() - 1);
+    ASSERT_GT(torn.GetTornBytes(), 0u);
+}
+
+// 市价单消息与非法消息
+TEST(BinaryProtocolTests, MarketOrderAndMalformedMessages)
+{
+    Orderbook orderbook;
+    char buffer[64];
+
+    auto size = EncodeAddOrder(buffer, 1, Side::Sell, OrderType::GoodTillCancel, 100, 10);
+    size += EncodeMarketOrder(buffer + size, 2, Side::Buy, 4);
+
+    std::size_t tradeCount{ };
+    ASSERT_EQ(DispatchBinaryMessages(orderbook, buffer, size, [&tradeCount](OrderId, const Trades& trades) { tradeCount += trades.size(); }).consumed_, size);
+    ASSERT_EQ(tradeCount, 1u);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetAsks().front().quantity_, 6u);
+
+    // 长度与类型不符的消息
+    size = EncodeCancelOrder(buffer, 1);
+    buffer[2] = static_cast<char>(MessageType::AddOrder);
+    auto result = DispatchBinaryMessages(orderbook, buffer, size);
+    ASSERT_NE(result.error_, nullptr);
+    ASSERT_EQ(result.consumed_, 0u);
+
+    // 只收到消息头时就能发现长度与类型不符，不等待声明的 60000 字节
+    const MessageHeader oversized{ 60'000, MessageType::AddOrder };
+    std::memcpy(buffer, &oversized, sizeof(oversized));
+    result = DispatchBinaryMessages(orderbook, buffer, sizeof(oversized));
+    ASSERT_NE(result.error_, nullptr);
+    ASSERT_EQ(result.consumed_, 0u);
+
+    // 非法的买卖方向
+    size = EncodeMarketOrder(buffer, 3, Side::Buy, 1);
+    buffer[offsetof(MarketOrderMessage, side_)] = 7;
+    result = DispatchBinaryMessages(orderbook, buffer, size);
+    ASSERT_NE(result.error_, nullptr);
+    ASSERT_EQ(result.consumed_, 0u);
+
+    // 合法消息之后的非法订单类型：之前的消息已经分发，consumed_ 停在非法消息处
+    const auto first = EncodeAddOrder(buffer, 4, Side::Buy, OrderType::GoodTillCancel, 90, 5);
+    size = first + EncodeAddOrder(buffer + first, 5, Side::Buy, OrderType::GoodTillCancel, 91, 5);
+    buffer[first + offsetof(AddOrderMessage, orderType_)] = 9;
+    result = DispatchBinaryMessages(orderbook, buffer, size);
+    ASSERT_NE(result.error_, nullptr);
+    ASSERT_EQ(result.consumed_, first);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetBids().size(), 1u);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetBids().front().price_, 90);
+}
+
+// 由字段（"|" 代替 SOH）生成一条带 BodyLength 和 CheckSum 的 FIX 消息
+static std::string MakeFixMessage(std::string body)
+{
+    std::replace(body.begin(), body.end(), '|', Fix::Separator);
+    auto message = std::string{ Fix::BeginString } + std::to_string(body.size()) + Fix::Separator + body;
+    unsigned checksum{ };
+    for (const char character : message)
+        checksum += static_cast<unsigned char>(character);
+    checksum %= 256;
+    return message + "10=" + static_cast<char>('0' + checksum / 100) + static_cast<char>('0' + checksum / 10 % 10) + static_cast<char>('0' + checksum % 10) + Fix::Separator;
+}
+
+// 只检查帧和会话的 FIX 消息处理器
+struct IgnoreFixMessages
+{
+    void OnNewOrderSingle(const FixOrderMessage&) { }
+    void OnOrderCancelRequest(const FixOrderMessage&) { }
+    void OnOrderCancelReplaceRequest(const FixOrderMessage&) { }
+};
+
+// FIX 订单录入经路由器执行；改单保持订单 ID，撤单与改单以 OrigClOrdID 标识订单
+TEST(FixProtocolTests, RoutesOrderEntryMessages)
+{
+    Orderbook orderbook;
+    OrderSessionRouter router{ orderbook };
+    FixSession session;
+
+    auto input = MakeFixMessage("35=A|49=CLIENT|56=GATEWAY|34=1|98=0|108=30|");   // Logon：只检查后跳过
+    input += MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=2|11=1|55=XYZ|54=1|40=2|44=100.00|38=10|59=1|");
+    input += MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=3|11=2|54=2|40=2|44=105|38=4|");
+    const auto partial = MakeFixMessage("35=G|49=CLIENT|56=GATEWAY|34=4|11=3|41=2|54=2|40=2|44=101|38=4|");
+    input += partial.substr(0, 20);
+
+    // 末尾不完整的消息留在缓冲区中
+    ASSERT_EQ(router.DecodeFix(1, input.data(), input.size(), session), input.size() - 20);
+    ASSERT_EQ(router.GetPendingCommands(), 2u);
+    ASSERT_EQ(session.remote_.View(), "CLIENT");
+    ASSERT_EQ(session.local_.View(), "GATEWAY");
+    router.Execute();
+
+    auto orderbookInfos = orderbook.GetOrderInfos();
+    ASSERT_EQ(orderbookInfos.GetBids().front().price_, 100);
+    ASSERT_EQ(orderbookInfos.GetAsks().front().price_, 105);
+
+    input = partial + MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=5|11=4|54=2|40=1|38=6|");   // 市价卖单
+    ASSERT_EQ(router.DecodeFix(1, input.data(), input.size(), session), input.size());
+    router.Execute();
+    orderbookInfos = orderbook.GetOrderInfos();
+    ASSERT_EQ(orderbookInfos.GetBids().front().quantity_, 4u);
+    ASSERT_EQ(orderbookInfos.GetAsks().front().price_, 101);
+
+    router.ClearReports();
+    input = MakeFixMessage("35=F|49=CLIENT|56=GATEWAY|34=6|11=5|41=2|54=2|");
+    ASSERT_EQ(router.DecodeFix(1, input.data(), input.size(), session), input.size());
+    router.Execute();
+    ASSERT_EQ(orderbook.Size(), 1u);
+    ASSERT_EQ(OrderId{ router.GetReports().back().report_.orderId_ }, 2u);
+    ASSERT_EQ(router.GetReports().back().report_.executionType_, ExecutionType::Cancelled);
+}
+
+// 取出发给某个会话的回报
+static std::vector<ExecutionReportMessage> GetSessionReports(const OrderSessionRouter& router, std::uint64_t sessionId)
+{
+    std::vector<ExecutionReportMessage> reports;
+    for (const auto& report : router.GetReports())
+        if (report.sessionId_ == sessionId)
+            reports.push_back(report.report_);
+    return reports;
+}
+
+// 撤单和改单的回报按订单簿实际的处理生成：同一批次中先成交的订单撤单失败，改单之前的成交按原数量计算剩余
+TEST(OrderSessionRouterTests, ReportsCancelAndModifyAfterExecution)
+{
+    Orderbook orderbook;
+    OrderSessionRouter router{ orderbook };
+    char buffer[128];
+
+    auto size = EncodeAddOrder(buffer, 1, Side::Sell, OrderType::GoodTillCancel, 100, 10);
+    size += EncodeAddOrder(buffer + size, 3, Side::Sell, OrderType::GoodTillCancel, 101, 10);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    router.Execute();
+    router.ClearReports();
+
+    // 会话 2 的买单先吃掉订单 1 和订单 3 的一部分，之后会话 1 才撤销订单 1、修改订单 3
+    size = EncodeAddOrder(buffer, 2, Side::Buy, OrderType::FillAndKill, 101, 14);
+    ASSERT_EQ(router.Decode(2, buffer, size).consumed_, size);
+    size = EncodeCancelOrder(buffer, 1);
+    size += EncodeModifyOrder(buffer + size, 3, Side::Sell, 102, 8);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    ASSERT_TRUE(GetSessionReports(router, 1).empty());   // 撤单和改单在执行后才回报
+    router.Execute();
+
+    const auto reports = GetSessionReports(router, 1);
+    ASSERT_EQ(reports.size(), 4u);
+    ASSERT_EQ(OrderId{ reports[0].orderId_ }, 1u);
+    ASSERT_EQ(reports[0].executionType_, ExecutionType::Filled);
+    ASSERT_EQ(reports[0].leavesQuantity_, 0u);
+    ASSERT_EQ(OrderId{ reports[1].orderId_ }, 3u);
+    ASSERT_EQ(reports[1].executionType_, ExecutionType::Filled);
+    ASSERT_EQ(reports[1].leavesQuantity_, 6u);
+    ASSERT_EQ(OrderId{ reports[2].orderId_ }, 1u);
+    ASSERT_EQ(reports[2].executionType_, ExecutionType::Rejected);   // 已全部成交，撤单失败
+    ASSERT_EQ(OrderId{ reports[3].orderId_ }, 3u);
+    ASSERT_EQ(reports[3].executionType_, ExecutionType::Accepted);
+    ASSERT_EQ(reports[3].leavesQuantity_, 8u);
+    ASSERT_EQ(orderbook.Size(), 1u);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetAsks().front().price_, 102);
+
+    // 改单后的订单仍由会话 1 持有，撤销时回报改单后的剩余数量
+    router.ClearReports();
+    size = EncodeCancelOrder(buffer, 3);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    router.Execute();
+    ASSERT_EQ(router.GetReports().size(), 1u);
+    ASSERT_EQ(router.GetReports()[0].report_.executionType_, ExecutionType::Cancelled);
+    ASSERT_EQ(router.GetReports()[0].report_.quantity_, 8u);
+    ASSERT_EQ(orderbook.Size(), 0u);
+}
+
+// 受理后没有挂到簿中的订单补发 Cancelled 回报，路由器不再跟踪它们
+TEST(OrderSessionRouterTests, ReportsOrdersDroppedByTheBook)
+{
+    Orderbook orderbook;
+    OrderSessionRouter router{ orderbook };
+    char buffer[64];
+
+    // 对手方为空的市价单被订单簿丢弃
+    auto size = EncodeMarketOrder(buffer, 1, Side::Buy, 10);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    router.Execute();
+    ASSERT_EQ(router.GetReports().size(), 2u);
+    ASSERT_EQ(router.GetReports()[0].report_.executionType_, ExecutionType::Accepted);
+    ASSERT_EQ(router.GetReports()[1].report_.executionType_, ExecutionType::Cancelled);
+    ASSERT_EQ(router.GetReports()[1].report_.quantity_, 10u);
+
+    // 状态已被删除：同一 ID 可以再次下单，撤销它则被拒绝
+    router.ClearReports();
+    size = EncodeCancelOrder(buffer, 1);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    ASSERT_EQ(router.GetReports().size(), 1u);
+    ASSERT_EQ(router.GetReports()[0].report_.executionType_, ExecutionType::Rejected);
+    router.ClearReports();
+    size = EncodeAddOrder(buffer, 1, Side::Buy, OrderType::GoodForDay, 100, 10);
+    ASSERT_EQ(router.Decode(1, buffer, size).consumed_, size);
+    router.Execute();
+    ASSERT_EQ(router.GetReports().size(), 1u);
+    ASSERT_EQ(router.GetReports()[0].report_.executionType_, ExecutionType::Accepted);
+
+    const OrderId orderIds[]{ 1, 2 };
+    Quantity quantities[2]{ };
+    orderbook.GetRemainingQuantities(orderIds, quantities);
+    ASSERT_EQ(quantities[0], 10u);
+    ASSERT_EQ(quantities[1], 0u);
+}
+
+// 校验和、字段格式、会话标识与序号错误
+TEST(FixProtocolTests, RejectsMalformedMessages)
+{
+    Orderbook orderbook;
+    OrderSessionRouter router{ orderbook };
+
+    const auto decode = [&router](std::string input, std::uint64_t sequence = 0)
+    {
+        FixSession session;
+        session.inboundSequence_ = sequence;
+        return router.DecodeFix(1, input.data(), input.size(), session);
+    };
+
+    auto input = MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=1|11=1|54=1|40=2|44=100|38=10|");
+    input[input.size() - 2] = input[input.size() - 2] == '0' ? '1' : '0';
+    ASSERT_THROW(decode(input), std::runtime_error);
+    ASSERT_THROW(decode("8=FIX.4.2\x01" "9=5\x01"), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=1|11=1|54=1|40=2|44=100.5|38=10|")), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=1|11=1|54=3|40=2|44=100|38=10|")), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=1|11=A1|54=1|40=2|44=100|38=10|")), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=D|49=CLIENT|56=GATEWAY|34=1|11=1|54=1|40=2|38=10|")), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=G|49=CLIENT|56=GATEWAY|34=1|11=2|41=1|54=1|40=1|38=10|")), std::runtime_error);
+    ASSERT_THROW(decode(MakeFixMessage("35=0|49=CLIENT|56=GATEWAY|34=5|"), 5), std::runtime_error);
+
+    FixSession session;
+    input = MakeFixMessage("35=0|49=CLIENT|56=GATEWAY|34=1|") + MakeFixMessage("35=0|49=OTHER|56=GATEWAY|34=2|");
+    ASSERT_THROW(router.DecodeFix(1, input.data(), input.size(), session), std::runtime_error);
+    ASSERT_EQ(router.GetPendingCommands(), 0u);
+}
+
+// 执行回报编码：帧与校验和可以被解码器接受，字段与二进制回报一致
+TEST(FixProtocolTests, EncodesExecutionReports)
+{
+    FixSession session;
+    const auto logon = MakeFixMessage("35=A|49=CLIENT|56=GATEWAY|34=1|");
+    DecodeFixMessages(logon.data(), logon.size(), session, IgnoreFixMessages{ });
+
+    char sendingTime[Fix::TimestampSize];
+    FormatFixTimestamp(sendingTime, std::chrono::sys_days{ std::chrono::year{ 2024 } / 3 / 7 } + std::chrono::hours{ 9 } + std::chrono::milliseconds{ 5'042 });
+    ASSERT_EQ(std::string_view(sendingTime, sizeof(sendingTime)), "20240307-09:00:05.042");
+
+    char buffer[2 * Fix::MaxExecutionReportSize];
+    const ExecutionReportMessage report{ { sizeof(ExecutionReportMessage), MessageType::ExecutionReport }, 42, ExecutionType::Filled, 101, 3, 7 };
+    auto size = EncodeFixExecutionReport(buffer, session, sendingTime, "XYZ", report, FixExecutionFields{ Side::Buy, 3, 101 });
+    size += EncodeFixExecutionReport(buffer + size, session, sendingTime, { }, ExecutionReportMessage{ report.header_, 42, ExecutionType::Cancelled, 101, 7, 0 }, FixExecutionFields{ Side::Sell, 3, 100.5 });
+    ASSERT_EQ(session.outboundSequence_, 2u);
+
+    const std::string text{ buffer, size };
+    ASSERT_NE(text.find("\x01" "35=8\x01" "49=GATEWAY\x01" "56=CLIENT\x01" "34=1\x01" "52=20240307-09:00:05.042\x01" "37=42\x01"), std::string::npos);
+    ASSERT_NE(text.find("150=F\x01" "39=1\x01" "55=XYZ\x01" "54=1\x01" "32=3\x01" "31=101\x01" "151=7\x01" "14=3\x01" "6=101\x01"), std::string::npos);
+    ASSERT_NE(text.find("150=4\x01" "39=4\x01" "54=2\x01" "32=7\x01"), std::string::npos);
+    ASSERT_NE(text.find("14=3\x01" "6=100.5\x01"), std::string::npos);
+
+    // 以对端的视角解码：双方标识互换
+    FixSession peer{ session.remote_, session.local_, true, 0, 0 };
+    ASSERT_EQ(DecodeFixMessages(buffer, size, peer, IgnoreFixMessages{ }), size);
+    ASSERT_EQ(peer.inboundSequence_, 2u);
+}
+
+// 把编码好的 FIX 消息拆成逐条消息的 tag -> value
+static std::vector<std::map<std::uint32_t, std::string>> SplitFixFields(std::string_view text)
+{
+    std::vector<std::map<std::uint32_t, std::string>> messages;
+    while (!text.empty())
+    {
+        const auto end = text.find(Fix::Separator);
+        const auto field = text.substr(0, end);
+        text.remove_prefix(end + 1);
+
+        const auto equals = field.find('=');
+        const auto tag = static_cast<std::uint32_t>(std::stoul(std::string{ field.substr(0, equals) }));
+        if (tag == 8)
+            messages.emplace_back();
+        messages.back()[tag] = field.substr(equals + 1);
+    }
+    return messages;
+}
+
+// 执行回报带有 FIX 4.4 必需的 Side、CumQty 和 AvgPx：累计成交跨越改单和多次成交，撤单回报保留累计值
+TEST(FixProtocolTests, ReportsSideAndCumulativeQuantity)
+{
+    Orderbook orderbook;
+    OrderSessionRouter router{ orderbook };
+    FixSession buyer, seller;
+    const auto execute = [&router](std::uint64_t sessionId, FixSession& session, const std::string& input)
+    {
+        ASSERT_EQ(router.DecodeFix(sessionId, input.data(), input.size(), session), input.size());
+        router.Execute();
+    };
+
+    execute(1, buyer, MakeFixMessage("35=D|49=BUYER|56=GATEWAY|34=1|11=1|54=1|40=2|44=100|38=10|59=1|"));
+    execute(2, seller, MakeFixMessage("35=D|49=SELLER|56=GATEWAY|34=1|11=2|54=2|40=2|44=100|38=4|59=1|"));
+    execute(1, buyer, MakeFixMessage("35=G|49=BUYER|56=GATEWAY|34=2|11=3|41=1|54=1|40=2|44=101|38=6|59=1|"));
+    execute(2, seller, MakeFixMessage("35=D|49=SELLER|56=GATEWAY|34=2|11=4|54=2|40=2|44=101|38=2|59=1|"));
+    execute(1, buyer, MakeFixMessage("35=F|49=BUYER|56=GATEWAY|34=3|11=5|41=1|54=1|"));
+
+    char sendingTime[Fix::TimestampSize];
+    FormatFixTimestamp(sendingTime, std::chrono::system_clock::now());
+    std::vector<char> buffer(router.GetReports().size() * Fix::MaxExecutionReportSize);
+    std::size_t size{ };
+    for (const auto& report : router.GetReports())
+        if (report.sessionId_ == 1)
+            size += EncodeFixExecutionReport(buffer.data() + size, buyer, sendingTime, { }, report.report_, report.fix_);
+
+    // 受理、成交、改单受理、成交、撤销剩余部分
+    const auto messages = SplitFixFields({ buffer.data(), size });
+    ASSERT_EQ(messages.size(), 5u);
+    for (const auto& fields : messages)
+        ASSERT_EQ(fields.at(Fix::Tags::Side), "1");
+    ASSERT_EQ(messages[0].at(Fix::Tags::CumQty), "0");
+    ASSERT_EQ(messages[0].at(Fix::Tags::AvgPx), "0");
+    ASSERT_EQ(messages[1].at(Fix::Tags::CumQty), "4");
+    ASSERT_EQ(messages[1].at(Fix::Tags::AvgPx), "100");
+    ASSERT_EQ(messages[2].at(Fix::Tags::CumQty), "4");
+    ASSERT_EQ(messages[2].at(Fix::Tags::LeavesQty), "6");
+    ASSERT_EQ(messages[3].at(Fix::Tags::CumQty), "6");
+    ASSERT_EQ(messages[3].at(Fix::Tags::AvgPx), "100.333333");
+    ASSERT_EQ(messages[3].at(Fix::Tags::LeavesQty), "4");
+    ASSERT_EQ(messages[4].at(Fix::Tags::ExecType), "4");
+    ASSERT_EQ(messages[4].at(Fix::Tags::CumQty), "6");
+    ASSERT_EQ(messages[4].at(Fix::Tags::AvgPx), "100.333333");
+
+    // 卖方的回报带卖出方向
+    for (const auto& report : router.GetReports())
+        if (report.sessionId_ == 2)
+            ASSERT_EQ(report.fix_.side_, Side::Sell);
+}
+
+// 流式解析较大的文件：跨批次、CRLF、空行、末尾没有换行符，结果与逐条调用一致
+TEST(OrderFileParserTests, StreamsLargeFileInChunks)
+{
+    const auto path = std::filesystem::temp_directory_path() / "orderbook_parser_test.txt";
+    const auto messages = MakeJournalMessages(20'000);
+    {
+        std::ofstream file{ path, std::ios::binary };
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            const auto& message = messages[i];
+            const char side = message.side_ == Side::Buy ? 'B' : 'S';
+            if (message.type_ == JournalMessageType::Add)
+                file << "A " << side << (message.orderType_ == OrderType::GoodTillCancel ? " GoodTillCancel " : " FillAndKill ")
+                     << message.price_ << ' ' << message.quantity_ << ' ' << message.orderId_;
+            else if (message.type_ == JournalMessageType::Modify)
+                file << "M " << message.orderId_ << ' ' << side << ' ' << message.price_ << ' ' << message.quantity_;
+            else
+                file << "C " << message.orderId_;
+
+            if (i + 1 == messages.size())
+                break;  // 最后一行没有换行符
+            file << (i % 3 == 0 ? "\r\n" : "\n");
+            if (i % 1'000 == 0)
+                file << '\n';
+        }
+    }
+
+    OrderFileParser parser{ path };
+    OrderbookCommands commands(7);
+    std::size_t index{ };
+    while (const auto count = parser.Parse(commands))
+    {
+        for (std::size_t i = 0; i < count; ++i, ++index)
+        {
+            ASSERT_LT(index, messages.size());
+            const auto& command = commands[i];
+            const auto& message = messages[index];
+            ASSERT_EQ(static_cast<int>(command.type_), static_cast<int>(message.type_));
+            ASSERT_EQ(command.orderId_, message.orderId_);
+            if (message.type_ != JournalMessageType::Cancel)
+            {
+                ASSERT_EQ(command.side_, message.side_);
+                ASSERT_EQ(command.price_, message.price_);
+                ASSERT_EQ(command.quantity_, message.quantity_);
+            }
+        }
+    }
+    ASSERT_EQ(index, messages.size());
+    ASSERT_FALSE(parser.GetResult().has_value());
+
+    // 批量回放与逐条调用得到相同的订单簿
+    Orderbook replayed, expected;
+    ASSERT_EQ(ReplayOrderFile(replayed, path, 64).commands_, messages.size());
+    for (const auto& message : messages)
+        ApplyJournalMessage(expected, message);
+    ASSERT_EQ(replayed.GetChecksum(), expected.GetChecksum());
+
+    std::filesystem::remove(path);
+}
+
+// 格式错误的行抛出异常
+TEST(OrderFileParserTests, RejectsMalformedLines)
+{
+    const auto path = std::filesystem::temp_directory_path() / "orderbook_parser_malformed.txt";
+    OrderbookCommands commands(4);
+
+    for (const char* line : { "A B GoodTillCancel 100 10", "A X GoodTillCancel 100 10 1", "A B Unknown 100 10 1",
+                              "C 1x", "M 1 B 100 99999999999", "C  1" })
+    {
+        std::ofstream{ path } << line << '\n';
+        OrderFileParser parser{ path };
+        ASSERT_THROW(parser.Parse(commands), std::logic_error) << line;
+    }
+
+    // 结果行之后不能再有命令
+    std::ofstream{ path } << "R 0 0 0\nC 1\n";
+    OrderFileParser parser{ path };
+    ASSERT_THROW(parser.Parse(commands), std::logic_error);
+
+    std::filesystem::remove(path);
+}
+
+#include <array>
+#include <map>
+#include <random>
+
+// 把编码好的逐笔委托消息写入录制文件
+void WriteMarketByOrderCapture(const std::filesystem::path& path, const std::vector<char>& data)
+{
+    std::ofstream file{ path, std::ios::binary };
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// 合成订单流：相同的种子生成相同的订单流，统计特征符合参数
+TEST(OrderFlowGeneratorTests, MatchesConfiguredDistribution)
+{
+    OrderFlowOptions options;
+    options.midMoveProbability_ = 0;
+    options.depth_ = 2'000;
+    OrderFlowGenerator generator{ options };
+    OrderFlowGenerator same{ options };
+    options.seed_ = 2;
+    OrderFlowGenerator other{ options };
+
+    // 在订单簿中执行订单流，跟踪每个挂单的数量和已成交数量，统计被完全成交的挂单
+    Orderbook orderbook;
+    Trades trades;
+    std::unordered_map<OrderId, std::pair<Quantity, Quantity>> resting;
+    std::size_t filled{ };
+
+    constexpr std::size_t Count = 300'000;
+    std::size_t differences{ }, touch{ }, passive{ };
+    std::uint64_t previous{ };
+    std::map<OrderType, std::size_t> types;
+    for (std::size_t index = 0; index < Count; ++index)
+    {
+        const auto command = generator.Next();
+        const auto copy = same.Next();
+        ASSERT_EQ(command.type_, copy.type_);
+        ASSERT_EQ(command.orderType_, copy.orderType_);
+        ASSERT_EQ(command.side_, copy.side_);
+        ASSERT_EQ(command.price_, copy.price_);
+        ASSERT_EQ(command.quantity_, copy.quantity_);
+        ASSERT_EQ(command.orderId_, copy.orderId_);
+        ASSERT_EQ(generator.GetTimestamp(), same.GetTimestamp());
+        differences += other.Next().orderId_ != command.orderId_;
+
+        ASSERT_GE(generator.GetTimestamp(), previous);
+        previous = generator.GetTimestamp();
+
+        if (command.type_ == OrderbookCommandType::Add)
+        {
+            ++types[command.orderType_];
+            const auto distance = std::abs(command.price_ - options.midPrice_);
+            const bool crossing = command.orderType_ == OrderType::Market || (command.side_ == Side::Buy) == (command.price_ > options.midPrice_);
+            if (!crossing)
+            {
+                ++passive;
+                touch += distance == 1;
+                resting[command.orderId_] = { command.quantity_, 0 };
+            }
+            if (command.orderType_ != OrderType::Market)
+            {
+                ASSERT_LE(distance, static_cast<Price>(options.maxTicks_));
+            }
+        }
+        else if (command.type_ == OrderbookCommandType::Modify && resting.contains(command.orderId_))
+            resting[command.orderId_] = { command.quantity_, 0 };
+
+        trades.clear();
+        orderbook.ProcessCommands(std::span{ &command, 1 }, trades);
+        for (const auto& trade : trades)
+        {
+            for (const auto& info : { trade.GetBidTrade(), trade.GetAskTrade() })
+            {
+                const auto found = resting.find(info.orderId_);
+                if (found != resting.end() && (found->second.second += info.quantity_) >= found->second.first)
+                {
+                    ++filled;
+                    resting.erase(found);
+                }
+            }
+        }
+    }
+    ASSERT_GT(differences, Count / 2);
+
+    // 距离 1 的比例为 1 - 2^-1.5
+    ASSERT_NEAR(static_cast<double>(touch) / passive, 1 - std::pow(2.0, -options.priceTailExponent_), 0.02);
+    // 约 1 - cancelRatio_ 的挂单被成交，其余被撤销
+    ASSERT_NEAR(static_cast<double>(filled) / passive, 1 - options.cancelRatio_, 0.03);
+    ASSERT_LT(orderbook.Size(), 2u * options.depth_);
+    const auto& counts = generator.GetCounts();
+    ASSERT_NEAR(static_cast<double>(counts.modifies_) / Count, options.modifyRatio_, 0.01);
+    ASSERT_GT(types[OrderType::Market], 0u);
+    ASSERT_GT(types[OrderType::GoodForDay], types[OrderType::FillOrKill]);
+
+    // 突发期的消息间隔远小于平静期，因此平均速率介于两者之间
+    const auto rate = Count / (generator.GetTimestamp() / 1e9);
+    ASSERT_GT(rate, options.calmRate_);
+    ASSERT_LT(rate, options.burstRate_);
+}
+
+// 合成订单流：中间价移动时撤单和改单仍指向簿中的订单，成交只来自主动单
+TEST(OrderFlowGeneratorTests, CancelsTargetLiveOrders)
+{
+    OrderFlowGenerator generator{ OrderFlowOptions{ .depth_ = 2'000, .midMoveProbability_ = 0.01 } };
+    Orderbook orderbook;
+    Trades trades;
+    OrderbookCommands commands(4'096);
+    OrderbookCommandResults results(commands.size());
+
+    std::size_t cancels{ }, liveCancels{ }, modifies{ }, liveModifies{ }, tradeCount{ };
+    for (std::size_t chunk = 0; chunk < 100; ++chunk)
+    {
+        generator.Generate(commands);
+        orderbook.ProcessCommands(commands, trades, results);
+        tradeCount += trades.size();
+        trades.clear();
+        for (std::size_t index = 0; index < commands.size(); ++index)
+        {
+            if (commands[index].type_ == OrderbookCommandType::Cancel)
+            {
+                ++cancels;
+                liveCancels += results[index].found_;
+            }
+            else if (commands[index].type_ == OrderbookCommandType::Modify)
+            {
+                ++modifies;
+                liveModifies += results[index].found_;
+            }
+        }
+    }
+
+    const auto& counts = generator.GetCounts();
+    ASSERT_NE(generator.GetMidPrice(), OrderFlowOptions{ }.midPrice_);
+    ASSERT_GT(static_cast<double>(liveCancels) / cancels, 0.9);
+    ASSERT_GT(static_cast<double>(liveModifies) / modifies, 0.9);
+    ASSERT_GT(counts.filled_, 0u);
+    ASSERT_LT(tradeCount, 3 * counts.aggressive_);
+}
+
+// 文本和二进制输出回放到订单簿的结果与直接提交命令一致
+TEST(OrderFlowGeneratorTests, TextAndBinaryOutputsReplayIdentically)
+{
+    const auto path = std::filesystem::temp_directory_path() / "Orderbook_OrderFlow.txt";
+    OrderFlowGenerator generator{ OrderFlowOptions{ .seed_ = 7, .depth_ = 500 } };
+    OrderbookCommands commands(50'000);
+    generator.Generate(commands);
+
+    Orderbook direct;
+    Trades trades;
+    direct.ProcessCommands(commands, trades);
+    ASSERT_GT(trades.size(), 0u);
+
+    std::vector<char> binary;
+    {
+        std::ofstream text{ path, std::ios::binary };
+        char buffer[std::max(OrderFlowMaxTextSize, OrderFlowMaxBinarySize)];
+        for (const auto& command : commands)
+        {
+            text.write(buffer, static_cast<std::streamsize>(FormatOrderFlowText(buffer, command)));
+            const auto size = EncodeOrderFlowBinary(buffer, command);
+            binary.insert(binary.end(), buffer, buffer + size);
+        }
+    }
+
+    Orderbook fromText;
+    ASSERT_EQ(ReplayOrderFile(fromText, path).commands_, commands.size());
+    ASSERT_EQ(fromText.GetChecksum(), direct.GetChecksum());
+
+    Orderbook fromBinary;
+    ASSERT_EQ(DispatchBinaryMessages(fromBinary, binary.data(), binary.size()).consumed_, binary.size());
+    ASSERT_EQ(fromBinary.GetChecksum(), direct.GetChecksum());
+    ASSERT_EQ(fromBinary.Size(), direct.Size());
+}
+
+// 延迟直方图：每个值落在上界不小于它的桶中，分位数的相对误差不超过 1/32
+TEST(LatencyHistogramTests, ReportsQuantilesWithinBucketPrecision)
+{
+    for (std::uint64_t ticks = 0; ticks < 100'000; ticks = ticks * 5 / 4 + 1)
+    {
+        const auto index = LatencyHistogram::BucketIndex(ticks);
+        ASSERT_LT(index, LatencyHistogram::BucketCount);
+        ASSERT_GE(LatencyHistogram::BucketUpperBound(index), ticks);
+        if (index > 0)
+        {
+            ASSERT_LT(LatencyHistogram::BucketUpperBound(index - 1), ticks);
+        }
+    }
+    ASSERT_EQ(LatencyHistogram::BucketIndex(~0ull), LatencyHistogram::BucketCount - 1);
+
+    auto histogram = std::make_unique<LatencyHistogram>();
+    ASSERT_EQ(histogram->GetQuantile(0.5), 0u);
+    for (std::uint64_t ticks = 1; ticks <= 10'000; ++ticks)
+        histogram->Record(ticks);
+
+    ASSERT_EQ(histogram->GetCount(), 10'000u);
+    ASSERT_NEAR(static_cast<double>(histogram->GetQuantile(0.5)), 5'000, 5'000 / 32.0);
+    ASSERT_NEAR(static_cast<double>(histogram->GetQuantile(0.99)), 9'900, 9'900 / 32.0);
+    ASSERT_EQ(histogram->GetQuantile(1), 10'000u);
+
+    const auto summary = histogram->Summarize();
+    ASSERT_EQ(summary.count_, 10'000u);
+    ASSERT_LE(summary.p50_, summary.p99_);
+    ASSERT_LE(summary.p99_, summary.p999_);
+    ASSERT_LE(summary.p999_, summary.max_);
+
+    histogram->Reset();
+    ASSERT_EQ(histogram->GetCount(), 0u);
+    ASSERT_EQ(histogram->Summarize().count_, 0u);
+}
+
+// 订单簿按操作类型分别记录延迟；未编译延迟统计时统计为空
+TEST(LatencyHistogramTests, OrderbookRecordsEachOperation)
+{
+    Orderbook orderbook;
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 99, 10));
+    orderbook.ModifyOrder(OrderModify{ 2, Side::Buy, 98, 10 });
+    orderbook.CancelOrder(2);
+
+    Trades trades;
+    const OrderbookCommand commands[]{
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Sell, 100, 5, 3 },
+        { OrderbookCommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, 1 },
+    };
+    orderbook.ProcessCommands(commands, trades);
+    ASSERT_EQ(trades.size(), 1u);
+
+    const auto add = orderbook.GetLatencyStats(OrderbookOperation::Add);
+    const auto cancel = orderbook.GetLatencyStats(OrderbookOperation::Cancel);
+    const auto modify = orderbook.GetLatencyStats(OrderbookOperation::Modify);
+    const auto match = orderbook.GetLatencyStats(OrderbookOperation::Match);
+    if (!Orderbook::LatencyStatsEnabled)
+    {
+        ASSERT_EQ(add.count_ + cancel.count_ + modify.count_ + match.count_, 0u);
+        return;
+    }
+
+    ASSERT_EQ(add.count_, 3u);
+    ASSERT_EQ(cancel.count_, 2u);
+    ASSERT_EQ(modify.count_, 1u);
+    // 只有卖单 3 与买单 1 交叉时发生撮合
+    ASSERT_EQ(match.count_, 1u);
+    ASSERT_GT(add.max_, 0);
+    ASSERT_LE(add.p50_, add.max_);
+}
+
+// 带统计的作用域锁：没有竞争时等待时间为 0，被另一个线程持有时记录实际的等待时间
+TEST(LockProfileTests, RecordsWaitAndHoldTime)
+{
+    std::mutex mutex;
+    auto histograms = std::make_unique<LockSiteHistograms>();
+    {
+        ProfiledLock lock{ mutex, *histograms };
+    }
+    ASSERT_EQ(histograms->wait_.GetCount(), 1u);
+    ASSERT_EQ(histograms->wait_.GetQuantile(1), 0u);
+
+    std::atomic<bool> locked{ false };
+    std::thread holder{ [&]
+    {
+        ProfiledLock lock{ mutex, *histograms };
+        locked.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    } };
+    while (!locked.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    {
+        ProfiledLock lock{ mutex, *histograms };
+    }
+    holder.join();
+
+    const auto wait = histograms->wait_.Summarize();
+    const auto hold = histograms->hold_.Summarize();
+    ASSERT_EQ(wait.count_, 3u);
+    ASSERT_EQ(hold.count_, 3u);
+    ASSERT_GT(wait.max_, 5e6);
+    ASSERT_GT(hold.max_, 15e6);
+}
+
+// 订单簿按调用点记录锁统计；未编译锁统计时统计为空
+TEST(LockProfileTests, OrderbookRecordsEachCallSite)
+{
+    Orderbook orderbook;
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 100, 10));
+    orderbook.CancelOrder(1);
+    ASSERT_EQ(orderbook.Size(), 1u);
+
+    const auto add = orderbook.GetLockStats(OrderbookLockSite::AddOrder);
+    const auto cancel = orderbook.GetLockStats(OrderbookLockSite::CancelOrder);
+    const auto size = orderbook.GetLockStats(OrderbookLockSite::Size);
+    const auto modify = orderbook.GetLockStats(OrderbookLockSite::ModifyOrder);
+    if (!Orderbook::LockStatsEnabled)
+    {
+        ASSERT_EQ(add.wait_.count_ + cancel.wait_.count_ + size.wait_.count_, 0u);
+        return;
+    }
+
+    ASSERT_EQ(add.wait_.count_, 2u);
+    ASSERT_EQ(add.hold_.count_, 2u);
+    ASSERT_EQ(cancel.hold_.count_, 1u);
+    ASSERT_EQ(size.hold_.count_, 1u);
+    ASSERT_EQ(modify.hold_.count_, 0u);
+}
+
+// 累计计数器：按订单类型统计新订单，统计被拒绝的 FOK / FAK、成交、价格级别的新建与删除以及峰值
+TEST(OrderbookStatsTests, CountsBookActivity)
+{
+    Orderbook orderbook;
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodForDay, 2, Side::Buy, 99, 10));
+    // 无法全部成交的 FOK 和无法成交的 FAK 被拒绝
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::FillOrKill, 3, Side::Sell, 98, 100));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::FillAndKill, 4, Side::Sell, 101, 5));
+    // 市价卖单按最差买价 99 挂出（新建卖方级别 99），吃掉订单 1 和订单 2 的一半
+    ASSERT_EQ(orderbook.AddOrder(std::make_shared<Order>(5, Side::Sell, 15)).size(), 2u);
+    orderbook.ModifyOrder(OrderModify{ 2, Side::Buy, 97, 5 });
+
+    Trades trades;
+    const OrderbookCommand commands[]{
+        { OrderbookCommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, 2 },
+        { OrderbookCommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 0, 0, 42 },
+    };
+    orderbook.ProcessCommands(commands, trades);
+    ASSERT_EQ(orderbook.Size(), 0u);
+
+    const auto stats = orderbook.GetStats();
+    ASSERT_EQ(stats.adds_[static_cast<std::size_t>(OrderType::GoodTillCancel)], 1u);
+    ASSERT_EQ(stats.adds_[static_cast<std::size_t>(OrderType::GoodForDay)], 1u);
+    ASSERT_EQ(stats.adds_[static_cast<std::size_t>(OrderType::FillOrKill)], 1u);
+    ASSERT_EQ(stats.adds_[static_cast<std::size_t>(OrderType::FillAndKill)], 1u);
+    ASSERT_EQ(stats.adds_[static_cast<std::size_t>(OrderType::Market)], 1u);
+    ASSERT_EQ(stats.cancels_, 2u);
+    ASSERT_EQ(stats.modifies_, 1u);
+    ASSERT_EQ(stats.rejectedFillOrKill_, 1u);
+    ASSERT_EQ(stats.rejectedFillAndKill_, 1u);
+    ASSERT_EQ(stats.trades_, 2u);
+    ASSERT_EQ(stats.matchedQuantity_, 15u);
+    // 买方 100、99、97 和卖方 99，全部已删除
+    ASSERT_EQ(stats.levelsCreated_, 4u);
+    ASSERT_EQ(stats.levelsDestroyed_, 4u);
+    ASSERT_EQ(stats.peakOrders_, 3u);
+    ASSERT_EQ(stats.peakLevels_, 3u);
+}
+
+// 分配计数：预热之后撤单、查询数量和校验和都不分配内存，新订单的分配能被统计到
+TEST(AllocationTrackingTests, SteadyStateCancelDoesNotAllocate)
+{
+    Orderbook orderbook;
+    Trades trades;
+    trades.reserve(16);
+    OrderbookCommands commands;
+    for (OrderId orderId = 1; orderId <= 200; ++orderId)
+        commands.push_back({ OrderbookCommandType::Add, OrderType::GoodTillCancel, orderId % 2 == 0 ? Side::Buy : Side::Sell, orderId % 2 == 0 ? Price{ 99 } : Price{ 101 }, 10, orderId });
+
+    const auto beforeAdds = GetThreadAllocationCounts();
+    orderbook.ProcessCommands(commands, trades);
+    const auto adds = GetThreadAllocationCounts() - beforeAdds;
+
+    const auto beforeCancels = GetThreadAllocationCounts();
+    {
+        // 未编译分配计数时不起作用；编译时任何分配都会中止进程
+        NoAllocationScope noAllocations;
+        for (OrderId orderId = 1; orderId <= 100; ++orderId)
+            orderbook.CancelOrder(orderId);
+        for (auto command = commands.begin() + 100; command != commands.begin() + 150; ++command)
+            command->type_ = OrderbookCommandType::Cancel;
+        orderbook.ProcessCommands(std::span{ commands.data() + 100, 50 }, trades);
+        static_cast<void>(orderbook.Size());
+        static_cast<void>(orderbook.GetChecksum());
+    }
+    const auto cancels = GetThreadAllocationCounts() - beforeCancels;
+    ASSERT_EQ(orderbook.Size(), 50u);
+    ASSERT_EQ(cancels.allocations_, 0u);
+
+    if (!AllocationTrackingEnabled)
+    {
+        ASSERT_EQ(adds.allocations_, 0u);
+        return;
+    }
+
+    // 每个新订单至少分配订单本身、队列节点和索引节点；撤单释放后两者和订单
+    ASSERT_GE(adds.allocations_, 3u * 200);
+    ASSERT_GE(cancels.deallocations_, 3u * 150);
+}
+
+// depth 限制每方返回的价格级别数，从最优价开始
+TEST(OrderbookTests, OrderInfosLimitedToDepth)
+{
+    Orderbook orderbook;
+    for (Price price = 95; price <= 99; ++price)
+        orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, static_cast<OrderId>(price), Side::Buy, price, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 200, Side::Sell, 102, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 201, Side::Sell, 101, 5));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 202, Side::Sell, 101, 5));
+
+    const auto top = orderbook.GetOrderInfos(1);
+    ASSERT_EQ(top.GetBids().size(), 1u);
+    ASSERT_EQ(top.GetAsks().size(), 1u);
+    ASSERT_EQ(top.GetBids()[0].price_, 99);
+    ASSERT_EQ(top.GetAsks()[0].price_, 101);
+    ASSERT_EQ(top.GetAsks()[0].quantity_, 10u);
+
+    const auto three = orderbook.GetOrderInfos(3);
+    ASSERT_EQ(three.GetBids().size(), 3u);
+    ASSERT_EQ(three.GetBids().back().price_, 97);
+    ASSERT_EQ(three.GetAsks().size(), 2u);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetBids().size(), 5u);
+    ASSERT_TRUE(orderbook.GetOrderInfos(0).GetBids().empty());
+}
+
+// 读取线程与写入线程并发访问同一订单簿
+TEST(OrderbookTests, ReadersRunConcurrentlyWithWriters)
+{
+    Orderbook orderbook;
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> writers;
+    for (OrderId writer = 0; writer < 2; ++writer)
+    {
+        writers.emplace_back([&orderbook, writer]
+        {
+            for (OrderId sequence = 1; sequence <= 2'000; ++sequence)
+            {
+                const auto orderId = (writer << 32) | sequence;
+                const auto side = sequence % 2 == 0 ? Side::Buy : Side::Sell;
+                orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, side, side == Side::Buy ? Price(90 + sequence % 8) : Price(110 - sequence % 8), 10));
+                if (sequence % 3 != 0)
+                    orderbook.CancelOrder(orderId);
+            }
+        });
+    }
+    std::thread reader([&orderbook, &done]
+    {
+        while (!done.load())
+        {
+            const auto infos = orderbook.GetOrderInfos();
+            ASSERT_LE(infos.GetBids().size(), 8u);
+            static_cast<void>(orderbook.GetOrderInfos(1));
+            static_cast<void>(orderbook.Size());
+        }
+    });
+    for (auto& writer : writers)
+        writer.join();
+    done = true;
+    reader.join();
+
+    // 每个写入线程留下 2000 / 3 个挂单
+    ASSERT_EQ(orderbook.Size(), 2u * 666);
+}
+
+// 按容器统计节点数：挂单、价格级别的节点随下单和撤单增减
+TEST(OrderbookMemoryTests, CountsNodesPerContainer)
+{
+    Orderbook orderbook;
+    const auto empty = orderbook.GetMemoryFootprint();
+    ASSERT_EQ(empty.orders_, 0u);
+    ASSERT_EQ(empty.levels_, 0u);
+    ASSERT_EQ(empty.GetBytesPerOrder(), 0);
+    ASSERT_EQ(empty.objectBytes_, sizeof(Orderbook));
+
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 3, Side::Sell, 105, 10));
+    const auto footprint = orderbook.GetMemoryFootprint();
+    ASSERT_EQ(footprint.orders_, 3u);
+    ASSERT_EQ(footprint.levels_, 2u);
+    for (const auto container : { OrderbookContainer::Orders, OrderbookContainer::Queues, OrderbookContainer::OrderIndex })
+        ASSERT_EQ(footprint.Get(container).nodes_, 3u);
+    ASSERT_EQ(footprint.Get(OrderbookContainer::LevelMaps).nodes_, 2u);
+    ASSERT_EQ(footprint.Get(OrderbookContainer::LevelData).nodes_, 2u);
+
+    // 节点至少包含其保存的值
+    ASSERT_GT(footprint.Get(OrderbookContainer::Orders).nodeBytes_, sizeof(Order));
+    ASSERT_GT(footprint.Get(OrderbookContainer::Queues).nodeBytes_, sizeof(OrderPointer));
+    ASSERT_GT(footprint.Get(OrderbookContainer::LevelMaps).nodeBytes_, sizeof(Price) + sizeof(OrderPointers));
+    ASSERT_EQ(footprint.GetTotalBytes(), footprint.objectBytes_ + footprint.GetOrderBytes() + footprint.GetLevelBytes());
+    ASSERT_GT(footprint.GetBytesPerOrder(), static_cast<double>(sizeof(Order)));
+
+    // 撤单后节点随之释放
+    orderbook.CancelOrder(3);
+    const auto afterCancel = orderbook.GetMemoryFootprint();
+    ASSERT_EQ(afterCancel.orders_, 2u);
+    ASSERT_EQ(afterCancel.levels_, 1u);
+    ASSERT_EQ(afterCancel.Get(OrderbookContainer::LevelData).nodes_, 1u);
+}
+
+// 探测到的节点大小与实际的分配一致：在已有价格上追加挂单时分配的字节数等于队列节点、索引节点和订单本身之和
+TEST(OrderbookMemoryTests, NodeSizesMatchAllocations)
+{
+    Orderbook orderbook;
+    Trades trades;
+    trades.reserve(16);
+    OrderbookCommands commands;
+    for (OrderId orderId = 1; orderId <= 4; ++orderId)
+        commands.push_back({ OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Buy, 100, 10, orderId });
+    orderbook.ProcessCommands(std::span{ commands.data(), 1 }, trades);
+
+    const auto before = orderbook.GetMemoryFootprint();
+    const auto beforeCounts = GetThreadAllocationCounts();
+    orderbook.ProcessCommands(std::span{ commands.data() + 1, 3 }, trades);
+    const auto counts = GetThreadAllocationCounts() - beforeCounts;
+    const auto after = orderbook.GetMemoryFootprint();
+
+    if (!AllocationTrackingEnabled)
+    {
+        ASSERT_EQ(counts.bytes_, 0u);
+        return;
+    }
+
+    // 索引扩容时旧的桶数组被释放，分配的字节数包括整个新桶数组
+    const auto& index = after.Get(OrderbookContainer::OrderIndex);
+    const auto rehashBytes = index.bucketBytes_ != before.Get(OrderbookContainer::OrderIndex).bucketBytes_ ? index.bucketBytes_ : 0;
+    const auto perOrder = after.Get(OrderbookContainer::Orders).nodeBytes_ + after.Get(OrderbookContainer::Queues).nodeBytes_ + index.nodeBytes_;
+    ASSERT_EQ(counts.bytes_, 3 * perOrder + rehashBytes);
+}
+
+// 逐笔委托回放不撮合：交叉的价格可以同时挂着，成交和改单只改变对应的挂单
+TEST(MarketByOrderFeedTests, AppliesMessagesWithoutMatching)
+{
+    const auto path = std::filesystem::temp_directory_path() / "orderbook_mbo_apply.bin";
+    std::vector<char> data(1'024);
+    std::size_t size{ };
+    size += EncodeMarketByOrderAdd(data.data() + size, 1, Side::Buy, 100, 10);
+    size += EncodeMarketByOrderAdd(data.data() + size, 2, Side::Buy, 100, 5);
+    size += EncodeMarketByOrderAdd(data.data() + size, 3, Side::Sell, 99, 7);      // 与买单交叉，不成交
+    size += EncodeMarketByOrderExecute(data.data() + size, 3, 2);
+    size += EncodeMarketByOrderReplace(data.data() + size, 1, 100, 4);            // 减量，保留队列位置
+    size += EncodeMarketByOrderReplace(data.data() + size, 2, 100, 9);            // 增量，排到队尾
+    size += EncodeMarketByOrderAdd(data.data() + size, 4, Side::Sell, 101, 3);
+    size += EncodeMarketByOrderExecute(data.data() + size, 4, 3);                 // 全部成交
+    size += EncodeMarketByOrderAdd(data.data() + size, 5, Side::Sell, 102, 1);
+    size += EncodeMarketByOrderReplace(data.data() + size, 5, 103, 1);            // 改价
+    size += EncodeMarketByOrderAdd(data.data() + size, 6, Side::Sell, 104, 1);
+    size += EncodeMarketByOrderCancel(data.data() + size, 6);
+    size += EncodeMarketByOrderCancel(data.data() + size, 42);                    // 不存在的订单被忽略
+    data.resize(size);
+    WriteMarketByOrderCapture(path, data);
+
+    Orderbook orderbook{ OrderbookMode::Passive };
+    const auto replay = ReplayMarketByOrderFile(orderbook, path, 3);
+    ASSERT_EQ(replay.messages_, 13u);
+    ASSERT_EQ(replay.skipped_, 0u);
+    ASSERT_EQ(replay.bytes_, size);
+    ASSERT_EQ(orderbook.Size(), 4u);
+
+    const auto infos = orderbook.GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), 1u);
+    ASSERT_EQ(infos.GetBids()[0].quantity_, 13u);
+    ASSERT_EQ(infos.GetAsks().size(), 2u);
+    ASSERT_EQ(infos.GetAsks()[0].price_, 99);
+    ASSERT_EQ(infos.GetAsks()[0].quantity_, 5u);
+    ASSERT_EQ(infos.GetAsks()[1].price_, 103);
+
+    // 校验和包含队列顺序：订单 1 仍在订单 2 之前
+    const std::array<OrderbookCommand, 4> expected{ {
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Buy, 100, 4, 1 },
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Buy, 100, 9, 2 },
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Sell, 99, 5, 3 },
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Sell, 103, 1, 5 },
+    } };
+    Orderbook rebuilt{ OrderbookMode::Passive };
+    ASSERT_EQ(rebuilt.ApplyCommands(expected), 0u);
+    ASSERT_EQ(orderbook.GetChecksum(), rebuilt.GetChecksum());
+
+    // 超过剩余数量的成交被跳过，订单簿不变
+    const OrderbookCommand overfill{ OrderbookCommandType::Execute, OrderType::GoodTillCancel, Side::Buy, 0, 10, 1 };
+    ASSERT_EQ(orderbook.ApplyCommands({ &overfill, 1 }), 1u);
+    ASSERT_EQ(orderbook.GetChecksum(), rebuilt.GetChecksum());
+
+    std::filesystem::remove(path);
+}
+
+// 被动模式：新订单与对手方交叉时也不成交，成交和改单由外部应用
+TEST(OrderbookPassiveTests, MirrorsExternalBookWithoutMatching)
+{
+    Orderbook orderbook{ OrderbookMode::Passive };
+    ASSERT_EQ(orderbook.GetMode(), OrderbookMode::Passive);
+
+    ASSERT_TRUE(orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 101, 10)).empty());
+    ASSERT_TRUE(orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Sell, 100, 6)).empty());
+    ASSERT_TRUE(orderbook.AddOrder(std::make_shared<Order>(OrderType::FillOrKill, 3, Side::Sell, 99, 50)).empty());
+    ASSERT_TRUE(orderbook.AddOrder(std::make_shared<Order>(4, Side::Buy, 5)).empty());     // 市价订单被忽略
+    ASSERT_EQ(orderbook.Size(), 3u);
+
+    // 外部成交：部分成交保留数量，全部成交删除挂单
+    orderbook.ApplyExecution(1, 4);
+    orderbook.ApplyExecution(3, 50);
+    orderbook.ApplyExecution(42, 1);    // 不存在的订单被忽略
+    ASSERT_THROW(orderbook.ApplyExecution(2, 7), std::logic_error);
+    ASSERT_EQ(orderbook.Size(), 2u);
+
+    // 外部改单与修改订单都不会撮合
+    orderbook.ApplyReplace(2, 98, 6);
+    ASSERT_TRUE(orderbook.ModifyOrder(OrderModify{ 1, Side::Buy, 102, 6 }).empty());
+
+    const auto infos = orderbook.GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), 1u);
+    ASSERT_EQ(infos.GetBids()[0].price_, 102);
+    ASSERT_EQ(infos.GetBids()[0].quantity_, 6u);
+    ASSERT_EQ(infos.GetAsks().size(), 1u);
+    ASSERT_EQ(infos.GetAsks()[0].price_, 98);
+
+    // 改为 0 等同于删除
+    orderbook.ApplyReplace(2, 98, 0);
+    ASSERT_EQ(orderbook.Size(), 1u);
+}
+
+// 价格和数量都不变的外部改单不改变订单簿，也不产生价格级别事件
+TEST(OrderbookPassiveTests, IgnoresUnchangedReplace)
+{
+    struct CountingListener : OrderbookListener
+    {
+        void OnLevelChanged(Side, Price, Quantity, Quantity) override { ++levelEvents_; }
+        void OnTrade(const Trade&) override { }
+        std::size_t levelEvents_{ };
+    } listener;
+
+    Orderbook orderbook{ OrderbookMode::Passive };
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 10));
+    orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, 2, Side::Buy, 100, 5));
+    orderbook.SetListener(&listener);
+    const auto checksum = orderbook.GetChecksum();
+
+    orderbook.ApplyReplace(1, 100, 10);
+    const OrderbookCommands commands{ { OrderbookCommandType::Replace, OrderType::GoodTillCancel, Side::Buy, 100, 5, 2 } };
+    ASSERT_EQ(orderbook.ApplyCommands(commands), 0u);
+
+    ASSERT_EQ(listener.levelEvents_, 0u);
+    ASSERT_EQ(orderbook.GetChecksum(), checksum);
+    ASSERT_EQ(orderbook.GetOrderInfos().GetBids()[0].quantity_, 15u);
+    orderbook.SetListener(nullptr);
+}
+
+// 被动模式下逐条调用与批量应用得到相同的订单簿
+TEST(OrderbookPassiveTests, MatchesBatchedApplication)
+{
+    std::mt19937_64 random{ 11 };
+    Orderbook passive{ OrderbookMode::Passive }, batched{ OrderbookMode::Passive };
+    OrderbookCommands commands;
+    for (OrderId orderId = 1; orderId <= 2'000; ++orderId)
+    {
+        const auto side = random() % 2 == 0 ? Side::Buy : Side::Sell;
+        const auto price = static_cast<Price>(95 + random() % 11);
+        passive.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, side, price, 10));
+        commands.push_back({ OrderbookCommandType::Add, OrderType::GoodTillCancel, side, price, 10, orderId });
+
+        const OrderId target = 1 + random() % orderId;
+        if (orderId % 3 == 0)
+        {
+            passive.ApplyExecution(target, 1);
+            commands.push_back({ OrderbookCommandType::Execute, OrderType::GoodTillCancel, side, 0, 1, target });
+        }
+        else if (orderId % 3 == 1)
+        {
+            passive.ApplyReplace(target, price, 5);
+            commands.push_back({ OrderbookCommandType::Replace, OrderType::GoodTillCancel, side, price, 5, target });
+        }
+    }
+    ASSERT_EQ(batched.ApplyCommands(commands), 0u);
+    ASSERT_EQ(passive.Size(), batched.Size());
+    ASSERT_EQ(passive.GetChecksum(), batched.GetChecksum());
+}
+
+// 外部变化只能应用到被动模式的订单簿；批量应用跳过市价订单和超量成交，其余照常应用
+TEST(OrderbookPassiveTests, RejectsMatchingBookAndSkipsInvalidCommands)
+{
+    const std::array<OrderbookCommand, 5> commands{ {
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Buy, 100, 10, 1 },
+        { OrderbookCommandType::Add, OrderType::Market, Side::Sell, 0, 5, 2 },
+        { OrderbookCommandType::Execute, OrderType::GoodTillCancel, Side::Buy, 0, 11, 1 },
+        { OrderbookCommandType::Add, OrderType::GoodTillCancel, Side::Sell, 101, 3, 3 },
+        { OrderbookCommandType::Execute, OrderType::GoodTillCancel, Side::Buy, 0, 4, 1 },
+    } };
+
+    Orderbook matching;
+    ASSERT_THROW(matching.ApplyCommands(commands), std::logic_error);
+    ASSERT_THROW(matching.ApplyExecution(1, 1), std::logic_error);
+    ASSERT_THROW(matching.ApplyReplace(1, 100, 1), std::logic_error);
+    ASSERT_EQ(matching.Size(), 0u);
+
+    Orderbook orderbook{ OrderbookMode::Passive };
+    ASSERT_EQ(orderbook.ApplyCommands(commands), 2u);
+    ASSERT_EQ(orderbook.Size(), 2u);
+
+    const auto infos = orderbook.GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), 1u);
+    ASSERT_EQ(infos.GetBids()[0].quantity_, 6u);
+    ASSERT_EQ(infos.GetAsks().size(), 1u);
+    ASSERT_EQ(infos.GetAsks()[0].price_, 101);
+}
+
+// 大文件分批回放的结果与逐条维护的挂单集合一致
+TEST(MarketByOrderFeedTests, RebuildsLargeCapture)
+{
+    const auto path = std::filesystem::temp_directory_path() / "orderbook_mbo_large.bin";
+    struct Resting { Side side_; Price price_; Quantity quantity_; };
+    std::map<OrderId, Resting> resting;
+
+    std::mt19937_64 random{ 7 };
+    std::vector<char> data;
+    char message[sizeof(MarketByOrderAdd)];
+    OrderId nextOrderId{ };
+    for (std::size_t i = 0; i < 100'000; ++i)
+    {
+        std::size_t size{ };
+        const auto choice = random() % 8;
+        if (resting.empty() || choice < 3)
+        {
+            const auto side = random() % 2 == 0 ? Side::Buy : Side::Sell;
+            const Resting order{ side, static_cast<Price>(95 + random() % 11), static_cast<Quantity>(1 + random() % 50) };
+            resting[++nextOrderId] = order;
+            size = EncodeMarketByOrderAdd(message, nextOrderId, order.side_, order.price_, order.quantity_);
+        }
+        else
+        {
+            auto entry = resting.lower_bound(1 + random() % nextOrderId);
+            if (entry == resting.end())
+                entry = resting.begin();
+            auto& [orderId, order] = *entry;
+            if (choice < 5)
+            {
+                const auto quantity = static_cast<Quantity>(1 + random() % order.quantity_);
+                size = EncodeMarketByOrderExecute(message, orderId, quantity);
+                order.quantity_ -= quantity;
+            }
+            else if (choice < 7)
+            {
+                order.price_ = static_cast<Price>(95 + random() % 11);
+                order.quantity_ = static_cast<Quantity>(1 + random() % 50);
+                size = EncodeMarketByOrderReplace(message, orderId, order.price_, order.quantity_);
+            }
+            else
+            {
+                size = EncodeMarketByOrderCancel(message, orderId);
+                order.quantity_ = 0;
+            }
+            if (order.quantity_ == 0)
+                resting.erase(entry);
+        }
+        data.insert(data.end(), message, message + size);
+    }
+    WriteMarketByOrderCapture(path, data);
+
+    MarketByOrderReader reader{ path };
+    ASSERT_TRUE(reader.IsMemoryMapped());
+
+    Orderbook orderbook{ OrderbookMode::Passive };
+    ASSERT_EQ(ReplayMarketByOrderFile(orderbook, path, 1'000).messages_, 100'000u);
+    ASSERT_EQ(orderbook.Size(), resting.size());
+
+    std::map<Price, Quantity, std::greater<Price>> bids;
+    std::map<Price, Quantity> asks;
+    for (const auto& [_, order] : resting)
+        (order.side_ == Side::Buy ? bids[order.price_] : asks[order.price_]) += order.quantity_;
+
+    const auto infos = orderbook.GetOrderInfos();
+    ASSERT_EQ(infos.GetBids().size(), bids.size());
+    ASSERT_EQ(infos.GetAsks().size(), asks.size());
+    auto bid = bids.begin();
+    for (const auto& level : infos.GetBids())
+    {
+        ASSERT_EQ(level.price_, bid->first);
+        ASSERT_EQ(level.quantity_, (bid++)->second);
+    }
+    auto ask = asks.begin();
+    for (const auto& level : infos.GetAsks())
+    {
+        ASSERT_EQ(level.price_, ask->first);
+        ASSERT_EQ(level.quantity_, (ask++)->second);
+    }
+
+    std::filesystem::remove(path);
+}
+
+// 截断或格式错误的录制文件抛出异常
+TEST(MarketByOrderFeedTests, RejectsMalformedCaptures)
+{
+    const auto path = std::filesystem::temp_directory_path() / "orderbook_mbo_malformed.bin";
+    OrderbookCommands commands(4);
+    std::vector<char> data(64);
+
+    // 末尾的消息被截断
+    auto size = EncodeMarketByOrderAdd(data.data(), 1, Side::Buy, 100, 10);
+    size += EncodeMarketByOrderCancel(data.data() + size, 1) - 1;
+    WriteMarketByOrderCapture(path, { data.begin(), data.begin() + size });
+    {
+        MarketByOrderReader reader{ path };
+        ASSERT_THROW(reader.Read(commands), std::runtime_error);
+    }
+
+    // 长度与类型不符
+    size = EncodeMarketByOrderCancel(data.data(), 1);
+    data[2] = static_cast<char>(MarketByOrderMessageType::Replace);
+    WriteMarketByOrderCapture(path, { data.begin(), data.begin() + size });
+    {
+        MarketByOrderReader reader{ path };
+        ASSERT_THROW(reader.Read(commands), std::runtime_error);
+    }
+
+    // 非法的买卖方向
+    size = EncodeMarketByOrderAdd(data.data(), 1, Side::Buy, 100, 10);
+    data[offsetof(MarketByOrderAdd, side_)] = 5;
+    WriteMarketByOrderCapture(path, { data.begin(), data.begin() + size });
+    {
+        MarketByOrderReader reader{ path };
+        ASSERT_THROW(reader.Read(commands), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// 连接到本机网关的测试客户端，读取带超时，避免网关出错时测试挂起
+static int ConnectToGateway(std::uint16_t port)
+{
+    const int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{ };
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EXPECT_EQ(connect(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+
+    const timeval timeout{ 5, 0 };
+    setsockopt(descriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return descriptor;
+}
+
+// 读取恰好 count 条执行回报
+static std::vector<ExecutionReportMessage> ReadReports(int descriptor, std::size_t count)
+{
+    std::vector<char> buffer(count * sizeof(ExecutionReportMessage));
+    std::size_t size{ };
+    while (size < buffer.size())
+    {
+        const auto received = read(descriptor, buffer.data() + size, buffer.size() - size);
+        if (received <= 0)
+            break;
+        size += static_cast<std::size_t>(received);
+    }
+
+    std::vector<ExecutionReportMessage> reports;
+    DecodeExecutionReports(buffer.data(), size, [&reports](const ExecutionReportMessage& report) { reports.push_back(report); });
+    return reports;
+}
+
+// 两个会话的订单在网关中撮合，双方各自收到受理和成交回报；其他会话不能撤销不属于自己的订单
+TEST(OrderGatewayTests, RoutesReportsToOwningSessions)
+{
+    Orderbook orderbook;
+    OrderGateway gateway{ orderbook };
+    std::atomic<bool> stop{ false };
+    std::thread worker{ [&] { gateway.Run(stop); } };
+
+    const int buyer = ConnectToGateway(gateway.GetPort());
+    const int seller = ConnectToGateway(gateway.GetPort());
+
+    // 买方一次发出两条消息，第二条拆成两次写入
+    char buffer[64];
+    auto size = EncodeAddOrder(buffer, 1, Side::Buy, OrderType::GoodTillCancel, 100, 10);
+    size += EncodeAddOrder(buffer + size, 2, Side::Buy, OrderType::GoodTillCancel, 99, 5);
+    ASSERT_EQ(write(buyer, buffer, size - 4), static_cast<ssize_t>(size - 4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(write(buyer, buffer + size - 4, 4), 4);
+    auto reports = ReadReports(buyer, 2);
+    ASSERT_EQ(reports.size(), 2u);
+    ASSERT_EQ(reports[0].executionType_, ExecutionType::Accepted);
+    ASSERT_EQ(OrderId{ reports[1].orderId_ }, 2u);
+
+    // 卖方撤销买方的订单被拒绝，随后的卖单部分成交第一笔买单
+    size = EncodeCancelOrder(buffer, 1);
+    size += EncodeAddOrder(buffer + size, 3, Side::Sell, OrderType::FillAndKill, 100, 15);
+    ASSERT_EQ(write(seller, buffer, size), static_cast<ssize_t>(size));
+
+    reports = ReadReports(seller, 4);
+    ASSERT_EQ(reports.size(), 4u);
+    ASSERT_EQ(reports[0].executionType_, ExecutionType::Rejected);
+    ASSERT_EQ(reports[1].executionType_, ExecutionType::Accepted);
+    ASSERT_EQ(reports[2].executionType_, ExecutionType::Filled);
+    ASSERT_EQ(reports[2].quantity_, 10u);
+    ASSERT_EQ(reports[2].leavesQuantity_, 5u);
+    ASSERT_EQ(reports[3].executionType_, ExecutionType::Cancelled);  // FillAndKill 剩余部分
+    ASSERT_EQ(reports[3].quantity_, 5u);
+
+    reports = ReadReports(buyer, 1);
+    ASSERT_EQ(reports.size(), 1u);
+    ASSERT_EQ(OrderId{ reports[0].orderId_ }, 1u);
+    ASSERT_EQ(reports[0].executionType_, ExecutionType::Filled);
+    ASSERT_EQ(reports[0].leavesQuantity_, 0u);
+
+    // 买方撤销自己剩余的订单
+    size = EncodeCancelOrder(buffer, 2);
+    ASSERT_EQ(write(buyer, buffer, size), static_cast<ssize_t>(size));
+    reports = ReadReports(buyer, 1);
+    ASSERT_EQ(reports.size(), 1u);
+    ASSERT_EQ(reports[0].executionType_, ExecutionType::Cancelled);
+
+    close(buyer);
+    close(seller);
+    stop.store(true, std::memory_order_release);
+    worker.join();
+
+    ASSERT_EQ(orderbook.Size(), 0u);
+    const auto stats = gateway.GetStats();
+    ASSERT_EQ(stats.messages_, 5u);
+    ASSERT_EQ(stats.reports_, 8u);
+}
+
+// 设置发送间隔后，多轮产生的回报累积起来用一次 sendmsg 发出；待发送数据达到大小阈值时立即发送
+TEST(OrderGatewayTests, BatchesReportsUntilFlushThreshold)
+{
+    Orderbook orderbook;
+    OrderGatewayOptions options;
+    options.flushInterval_ = std::chrono::milliseconds(200);
+    options.flushBytes_ = 4 * sizeof(ExecutionReportMessage);
+    OrderGateway gateway{ orderbook, options };
+    std::atomic<bool> stop{ false };
+    std::thread worker{ [&] { gateway.Run(stop); } };
+
+    const int client = ConnectToGateway(gateway.GetPort());
+    char buffer[64];
+    const auto start = std::chrono::steady_clock::now();
+    for (OrderId orderId = 1; orderId <= 3; ++orderId)
+    {
+        const auto size = EncodeAddOrder(buffer, orderId, Side::Buy, OrderType::GoodTillCancel, 100, 10);
+        ASSERT_EQ(write(client, buffer, size), static_cast<ssize_t>(size));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // 三条受理回报在发送期限到达时一起发出
+    auto reports = ReadReports(client, 3);
+    ASSERT_EQ(reports.size(), 3u);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+    // 一笔成交产生受理和两条成交回报，加上之前的一条受理达到大小阈值，不必等待发送期限
+    auto size = EncodeAddOrder(buffer, 4, Side::Buy, OrderType::GoodTillCancel, 99, 10);
+    ASSERT_EQ(write(client, buffer, size), static_cast<ssize_t>(size));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto sent = std::chrono::steady_clock::now();
+    size = EncodeAddOrder(buffer, 5, Side::Sell, OrderType::GoodTillCancel, 100, 10);
+    ASSERT_EQ(write(client, buffer, size), static_cast<ssize_t>(size));
+    reports = ReadReports(client, 4);
+    ASSERT_EQ(reports.size(), 4u);
+    ASSERT_LT(std::chrono::steady_clock::now() - sent, std::chrono::milliseconds(150));
+
+    close(client);
+    stop.store(true, std::memory_order_release);
+    worker.join();
+
+    // 五个批次的七条回报只用了两次 sendmsg
+    const auto stats = gateway.GetStats();
+    ASSERT_EQ(stats.batches_, 5u);
+    ASSERT_EQ(stats.reports_, 7u);
+    ASSERT_EQ(stats.writes_, 2u);
+}
+
+// 比接收缓冲区还长的消息是协议错误：会话被关闭并计数，而不是当作对端正常关闭
+TEST(OrderGatewayTests, ClosesSessionOnMessageLargerThanBuffer)
+{
+    Orderbook orderbook;
+    OrderGatewayOptions options;
+    options.protocol_ = OrderGatewayProtocol::Fix;
+    options.readBufferSize_ = 128;
+    OrderGateway gateway{ orderbook, options };
+    std::atomic<bool> stop{ false };
+    std::thread worker{ [&] { gateway.Run(stop); } };
+
+    const int client = ConnectToGateway(gateway.GetPort());
+    const auto message = std::string{ "8=FIX.4.4\x01" "9=1000\x01" "58=" } + std::string(200, 'x');
+    ASSERT_EQ(write(client, message.data(), message.size()), static_cast<ssize_t>(message.size()));
+    // 网关关闭时接收缓冲区中还有未读的数据，对端可能收到 RST
+    char buffer[16];
+    const auto received = read(client, buffer, sizeof(buffer));
+    ASSERT_TRUE(received == 0 || (received < 0 && errno == ECONNRESET));
+
+    close(client);
+    stop.store(true, std::memory_order_release);
+    worker.join();
+
+    ASSERT_EQ(gateway.GetStats().protocolErrors_, 1u);
+    ASSERT_EQ(gateway.GetStats().sessions_, 0u);
+    ASSERT_EQ(gateway.GetLastProtocolError(), "Message is larger than the gateway receive buffer.");
+}
+#endif
+
+#ifndef _WIN32
+#include <sys/wait.h>
+
+// 两个共享内存客户端的订单撮合，回报送到各自的回报队列；断开的客户端槽位被回收并以新的代数重新分配
+TEST(SharedMemoryChannelTests, RoutesOrdersAndReports)
+{
+    const auto name = "/orderbook_test_" + std::to_string(getpid());
+    Orderbook orderbook;
+    SharedMemoryOrderServer server{ orderbook, name, 2 };
+
+    std::vector<ExecutionReportMessage> buyerReports, sellerReports;
+    auto collect = [](std::vector<ExecutionReportMessage>& reports)
+    {
+        return [&reports](const ExecutionReportMessage& report) { reports.push_back(report); };
+    };
+
+    SharedMemoryOrderClient buyer{ name };
+    {
+        SharedMemoryOrderClient seller{ name };
+        ASSERT_THROW(SharedMemoryOrderClient{ name }, std::runtime_error);  // 槽位已用完
+
+        ASSERT_TRUE(buyer.AddOrder(1, Side::Buy, OrderType::GoodTillCancel, 100, 10));
+        ASSERT_TRUE(seller.CancelOrder(1));
+        ASSERT_TRUE(seller.AddOrder(2, Side::Sell, OrderType::GoodTillCancel, 100, 4));
+        ASSERT_EQ(server.Poll(), 3u);
+
+        buyer.PollReports(collect(buyerReports));
+        seller.PollReports(collect(sellerReports));
+        ASSERT_EQ(buyerReports.size(), 2u);
+        ASSERT_EQ(buyerReports[0].executionType_, ExecutionType::Accepted);
+        ASSERT_EQ(buyerReports[1].executionType_, ExecutionType::Filled);
+        ASSERT_EQ(buyerReports[1].leavesQuantity_, 6u);
+        ASSERT_EQ(sellerReports.size(), 3u);
+        ASSERT_EQ(sellerReports[0].executionType_, ExecutionType::Rejected);
+        ASSERT_EQ(sellerReports[2].executionType_, ExecutionType::Filled);
+
+        // 断开前写入的订单仍然会被处理
+        ASSERT_TRUE(seller.AddOrder(3, Side::Sell, OrderType::GoodTillCancel, 105, 1));
+    }
+    server.Poll();
+    ASSERT_EQ(server.GetStats().clients_, 1u);
+    ASSERT_EQ(orderbook.Size(), 2u);
+
+    // 槽位回收后可以被新的客户端使用，旧客户端订单的回报不会送给新客户端
+    SharedMemoryOrderClient other{ name };
+    server.Poll();
+    ASSERT_TRUE(buyer.AddOrder(4, Side::Buy, OrderType::GoodTillCancel, 105, 1));
+    server.Poll();
+    std::vector<ExecutionReportMessage> otherReports;
+    ASSERT_EQ(other.PollReports(collect(otherReports)), 0u);
+    ASSERT_EQ(server.GetStats().clients_, 2u);
+}
+
+// 回报队列已满时回报暂存在服务端，客户端读取后按顺序补发
+TEST(SharedMemoryChannelTests, BacklogsReportsWhenRingIsFull)
+{
+    const auto name = "/orderbook_backlog_" + std::to_string(getpid());
+    Orderbook orderbook;
+    SharedMemoryOrderServer server{ orderbook, name, 1 };
+    SharedMemoryOrderClient client{ name };
+
+    const std::size_t total = SharedMemoryFormat::RingCapacity + 1'000;
+    OrderId orderId{ };
+    for (std::size_t round = 0; round < 2; ++round)
+    {
+        for (std::size_t i = 0; i < total / 2; ++i)
+        {
+            ++orderId;
+            ASSERT_TRUE(client.AddOrder(orderId, Side::Buy, OrderType::GoodTillCancel, 100, 1));
+        }
+        server.Poll();
+    }
+    ASSERT_EQ(server.GetStats().backlog_, total - SharedMemoryFormat::RingCapacity);
+
+    OrderId expected{ };
+    std::size_t received{ };
+    while (received < total)
+    {
+        const auto count = client.PollReports([&expected](const ExecutionReportMessage& report)
+        {
+            ASSERT_EQ(OrderId{ report.orderId_ }, ++expected);
+        });
+        if (count == 0)
+            server.Poll();
+        received += count;
+    }
+    ASSERT_EQ(server.GetStats().backlog_, 0u);
+}
+
+// 因协议错误被断开的客户端在析构前一直占用槽位，之后的下单失败，不会写入下一个客户端的队列
+TEST(SharedMemoryChannelTests, RejectedClientKeepsSlotUntilClosed)
+{
+    const auto name = "/orderbook_reject_" + std::to_string(getpid());
+    Orderbook orderbook;
+    SharedMemoryOrderServer server{ orderbook, name, 1 };
+
+    {
+        SharedMemoryOrderClient client{ name };
+        ASSERT_TRUE(client.AddOrder(1, Side::Buy, OrderType::GoodTillCancel, 100, 10));
+        char message[SharedMemoryFormat::SlotSize];
+        const auto size = EncodeCancelOrder(message, 1);
+        message[offsetof(MessageHeader, type_)] = static_cast<char>(0x7F);
+        ASSERT_TRUE(client.Send(message, size));
+        server.Poll();
+        ASSERT_EQ(orderbook.Size(), 1u);
+        ASSERT_EQ(server.GetStats().clients_, 0u);
+
+        ASSERT_FALSE(client.IsConnected());
+        ASSERT_FALSE(client.CancelOrder(1));
+        server.Poll();
+        ASSERT_THROW(SharedMemoryOrderClient{ name }, std::runtime_error);  // 槽位尚未回收
+    }
+
+    server.Poll();
+    SharedMemoryOrderClient next{ name };
+    server.Poll();
+    ASSERT_TRUE(next.IsConnected());
+    ASSERT_TRUE(next.AddOrder(2, Side::Sell, OrderType::GoodTillCancel, 110, 10));
+    ASSERT_EQ(server.Poll(), 1u);
+    ASSERT_EQ(orderbook.Size(), 2u);
+    ASSERT_EQ(server.GetStats().clients_, 1u);
+}
+
+// 占用槽位之后、连接之前崩溃的客户端：服务端按槽位中的进程号发现并回收槽位
+TEST(SharedMemoryChannelTests, ReclaimsSlotClaimedByCrashedClient)
+{
+    const auto name = "/orderbook_claim_" + std::to_string(getpid());
+    Orderbook orderbook;
+    SharedMemoryOrderServer server{ orderbook, name, 1 };
+
+    // 已经退出的子进程的进程号
+    const auto child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+        _exit(0);
+    ASSERT_EQ(waitpid(child, nullptr, 0), child);
+
+    // 模拟客户端完成占用 CAS 后立即崩溃
+    auto segment = SharedMemorySegment::Open(name);
+    auto expected = SharedMemoryClientOwner::Pack(SharedMemoryClientState::Free, 0);
+    ASSERT_TRUE(GetSharedMemoryClientSlot(segment.GetAddress(), 0).owner_.compare_exchange_strong(expected,
+        SharedMemoryClientOwner::Pack(SharedMemoryClientState::Claimed, static_cast<std::int32_t>(child))));
+    ASSERT_THROW(SharedMemoryOrderClient{ name }, std::runtime_error);
+
+    // 服务端定期检查客户端进程是否还存在
+    for (int poll = 0; poll < 5'000; ++poll)
+        server.Poll();
+    SharedMemoryOrderClient client{ name };
+    server.Poll();
+    ASSERT_TRUE(client.IsConnected());
+    ASSERT_EQ(server.GetStats().clients_, 1u);
+}
+
+// 读者用事件维护的订单簿级别
+struct MarketDataBook
+{
+    std::map<Price, Quantity, std::greater<Price>> bids_;
+    std::map<Price, Quantity, std::less<Price>> asks_;
+    std::size_t trades_{ };
+
+    void Reset(const MarketDataSnapshot& snapshot)
+    {
+        bids_.clear();
+        asks_.clear();
+        for (const auto& level : snapshot.bids_)
+            bids_[level.price_] = level.quantity_;
+        for (const auto& level : snapshot.asks_)
+            asks_[level.price_] = level.quantity_;
+    }
+
+    void Apply(const MarketDataEvent& event)
+    {
+        if (event.type_ == MarketDataEventType::Trade)
+        {
+            ++trades_;
+            return;
+        }
+        auto apply = [&event](auto& levels)
+        {
+            if (event.count_ == 0)
+                levels.erase(event.price_);
+            else
+                levels[event.price_] = event.quantity_;
+        };
+        if (event.side_ == Side::Buy)
+            apply(bids_);
+        else
+            apply(asks_);
+    }
+
+    // 读完所有已发布的事件，遇到覆盖时返回 false
+    bool Drain(MarketDataSubscriber& subscriber)
+    {
+        MarketDataEvent event{ };
+        while (true)
+        {
+            const auto result = subscriber.Read(event);
+            if (result == MarketDataReadResult::NoData)
+                return true;
+            if (result == MarketDataReadResult::Overrun)
+                return false;
+            Apply(event);
+        }
+    }
+
+    void ExpectEquals(const Orderbook& orderbook) const
+    {
+        const auto infos = orderbook.GetOrderInfos();
+        ASSERT_EQ(bids_.size(), infos.GetBids().size());
+        ASSERT_EQ(asks_.size(), infos.GetAsks().size());
+        auto bid = bids_.begin();
+        for (const auto& level : infos.GetBids())
+        {
+            ASSERT_EQ(bid->first, level.price_);
+            ASSERT_EQ(bid->second, level.quantity_);
+            ++bid;
+        }
+        auto ask = asks_.begin();
+        for (const auto& level : infos.GetAsks())
+        {
+            ASSERT_EQ(ask->first, level.price_);
+            ASSERT_EQ(ask->second, level.quantity_);
+            ++ask;
+        }
+    }
+};
+
+// 向订单簿随机下单、撤单，价格范围互相交叉以产生成交，返回成交数
+std::size_t GenerateMarketActivity(Orderbook& orderbook, std::size_t count, std::uint64_t seed)
+{
+    std::mt19937_64 random{ seed };
+    std::size_t trades{ };
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const OrderId orderId = seed * 1'000'000 + i + 1;
+        if (i % 5 == 4)
+        {
+            orderbook.CancelOrder(orderId - 3);
+            continue;
+        }
+        const auto side = random() % 2 == 0 ? Side::Buy : Side::Sell;
+        const auto price = static_cast<Price>(side == Side::Buy ? 95 + random() % 8 : 98 + random() % 8);
+        trades += orderbook.AddOrder(std::make_shared<Order>(OrderType::GoodTillCancel, orderId, side, price, static_cast<Quantity>(1 + random() % 20))).size();
+    }
+    return trades;
+}
+
+// 多个读者各自从行情广播重建出与订单簿一致的级别和成交
+TEST(MarketDataFeedTests, SubscribersRebuildBook)
+{
+    const auto name = "/orderbook_md_" + std::to_string(getpid());
+    Orderbook orderbook;
+    MarketDataPublisher publisher{ name, 1'024, 16, 64 };
+    orderbook.SetListener(&publisher);
+
+    MarketDataSubscriber early{ name };
+    MarketDataBook earlyBook;
+    earlyBook.Reset(early.Resync());
+
+    auto trades = GenerateMarketActivity(orderbook, 100, 1);
+
+    // 中途加入的读者从快照开始
+    publisher.PublishSnapshot();
+    MarketDataSubscriber late{ name };
+    MarketDataBook lateBook;
+    lateBook.Reset(late.Resync());
+    ASSERT_EQ(late.GetNextSequence(), publisher.GetSequence() + 1);
+    lateBook.ExpectEquals(orderbook);
+
+    ASSERT_TRUE(earlyBook.Drain(early));
+    trades += GenerateMarketActivity(orderbook, 300, 2);
+    ASSERT_TRUE(earlyBook.Drain(early));
+    ASSERT_TRUE(lateBook.Drain(late));
+
+    ASSERT_GT(trades, 0u);
+    ASSERT_EQ(earlyBook.trades_, trades);
+    earlyBook.ExpectEquals(orderbook);
+    lateBook.ExpectEquals(orderbook);
+    ASSERT_EQ(early.GetNextSequence(), publisher.GetSequence() + 1);
+
+    orderbook.SetListener(nullptr);
+    ASSERT_THROW(MarketDataPublisher(name + "_bad", 1'000), std::logic_error);
+}
+
+// 读者落后超过一圈时发现覆盖，从快照重新同步后继续跟上
+TEST(MarketDataFeedTests, OverrunResyncsFromSnapshot)
+{
+    const auto name = "/orderbook_md_overrun_" + std::to_string(getpid());
+    Orderbook orderbook;
+    MarketDataPublisher publisher{ name, 32, 1'024, 8 };
+    orderbook.SetListener(&publisher);
+
+    MarketDataSubscriber subscriber{ name };
+    MarketDataBook book;
+    book.Reset(subscriber.Resync());
+
+    GenerateMarketActivity(orderbook, 200, 3);
+    ASSERT_FALSE(book.Drain(subscriber));
+
+    book.Reset(subscriber.Resync());
+    ASSERT_GT(subscriber.GetNextSequence(), 1u);
+    ASSERT_TRUE(book.Drain(subscriber));
+    book.ExpectEquals(orderbook);
+
+    orderbook.SetListener(nullptr);
+}
+#endif
@@ -0,0 +1,160 @@
+//
+// FlowGenerator.cpp
+//
+// 合成订单流工具：按 OrderFlowGenerator 的模型生成订单流，写成文本或二进制文件，或者在进程内直接驱动订单簿
+//
+// 用法：
+//   OrderbookFlowGen text <messages> <output> [seed]      A / M / C 文本格式，可由 OrderFileParser 回放
+//   OrderbookFlowGen binary <messages> <output> [seed]    二进制订单录入消息（BinaryProtocol.h）
+//   OrderbookFlowGen run <messages> [seed]                 生成后按批提交给订单簿，分别统计生成和撮合的吞吐量；
+//                                                          以 ORDERBOOK_LATENCY_STATS 编译时还输出各类操作的延迟分位数
+//
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Orderbook.h"
+#include "OrderFlowGenerator.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t ChunkSize = 4'096;             // 每批生成的消息数
+    constexpr std::size_t OutputBufferSize = 1 << 20;    // 输出缓冲区大小
+
+    int Usage()
+    {
+        std::cerr << "Usage: OrderbookFlowGen text <messages> <output> [seed]\n"
+                     "       OrderbookFlowGen binary <messages> <output> [seed]\n"
+                     "       OrderbookFlowGen run <messages> [seed]" << std::endl;
+        return 1;
+    }
+
+    void Print(const OrderFlowGenerator& generator)
+    {
+        const auto& counts = generator.GetCounts();
+        std::cout << "passive=" << counts.passive_
+                  << " aggressive=" << counts.aggressive_
+                  << " cancels=" << counts.cancels_
+                  << " modifies=" << counts.modifies_
+                  << " filled=" << counts.filled_
+                  << " simulatedSeconds=" << generator.GetTimestamp() / 1e9 << std::endl;
+    }
+
+    // 订单簿内部各类操作的延迟（需要以 ORDERBOOK_LATENCY_STATS 编译）
+    void PrintLatency(const Orderbook& orderbook)
+    {
+        constexpr std::string_view Names[]{ "add", "cancel", "modify", "match" };
+        for (std::size_t index = 0; index < OrderbookOperationCount; ++index)
+        {
+            const auto stats = orderbook.GetLatencyStats(static_cast<OrderbookOperation>(index));
+            std::cout << Names[index] << ": count=" << stats.count_
+                      << " mean=" << stats.mean_ << "ns p50=" << stats.p50_ << "ns p99=" << stats.p99_
+                      << "ns p99.9=" << stats.p999_ << "ns max=" << stats.max_ << "ns" << std::endl;
+        }
+    }
+
+    // 按批生成并格式化，缓冲区快满时写出
+    template<typename Encode>
+    void WriteFlow(OrderFlowGenerator& generator, std::uint64_t messages, const std::string& path, std::size_t maxSize, Encode encode)
+    {
+        std::ofstream file{ path, std::ios::binary };
+        if (!file)
+            throw std::runtime_error("Unable to open output file.");
+
+        const auto buffer = std::make_unique<char[]>(OutputBufferSize);
+        std::size_t size{ };
+        OrderbookCommands commands(ChunkSize);
+        while (messages > 0)
+        {
+            const auto count = generator.Generate(std::span{ commands.data(), std::min<std::uint64_t>(messages, ChunkSize) });
+            for (std::size_t index = 0; index < count; ++index)
+            {
+                if (OutputBufferSize - size < maxSize)
+                {
+                    file.write(buffer.get(), static_cast<std::streamsize>(size));
+                    size = 0;
+                }
+                size += encode(buffer.get() + size, commands[index]);
+            }
+            messages -= count;
+        }
+        file.write(buffer.get(), static_cast<std::streamsize>(size));
+        if (!file)
+            throw std::runtime_error("Unable to write output file.");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+        return Usage();
+
+    const std::string_view command{ argv[1] };
+    const auto messages = std::stoull(argv[2]);
+
+    try
+    {
+        if ((command == "text" || command == "binary") && (argc == 4 || argc == 5))
+        {
+            OrderFlowGenerator generator{ OrderFlowOptions{ .seed_ = argc == 5 ? std::stoull(argv[4]) : 1 } };
+            const auto start = Clock::now();
+            if (command == "text")
+                WriteFlow(generator, messages, argv[3], OrderFlowMaxTextSize, FormatOrderFlowText);
+            else
+                WriteFlow(generator, messages, argv[3], OrderFlowMaxBinarySize, EncodeOrderFlowBinary);
+            const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::cout << "messages=" << messages << " seconds=" << seconds << " messages/s=" << static_cast<std::uint64_t>(messages / seconds) << '\n';
+            Print(generator);
+        }
+        else if (command == "run" && (argc == 3 || argc == 4))
+        {
+            OrderFlowGenerator generator{ OrderFlowOptions{ .seed_ = argc == 4 ? std::stoull(argv[3]) : 1 } };
+            Orderbook orderbook;
+            OrderbookCommands commands(ChunkSize);
+            Trades trades;
+            Clock::duration generating{ }, matching{ };
+            std::uint64_t tradeCount{ };
+
+            for (auto remaining = messages; remaining > 0;)
+            {
+                const auto start = Clock::now();
+                const auto count = generator.Generate(std::span{ commands.data(), std::min<std::uint64_t>(remaining, ChunkSize) });
+                const auto generated = Clock::now();
+                orderbook.ProcessCommands(std::span{ commands.data(), count }, trades);
+                matching += Clock::now() - generated;
+                generating += generated - start;
+
+                tradeCount += trades.size();
+                trades.clear();
+                remaining -= count;
+            }
+
+            const auto generateSeconds = std::chrono::duration<double>(generating).count();
+            const auto matchSeconds = std::chrono::duration<double>(matching).count();
+            std::cout << "messages=" << messages
+                      << " generate/s=" << static_cast<std::uint64_t>(messages / generateSeconds)
+                      << " orderbook/s=" << static_cast<std::uint64_t>(messages / matchSeconds)
+                      << " trades=" << tradeCount
+                      << " orders=" << orderbook.Size() << '\n';
+            Print(generator);
+            if constexpr (Orderbook::LatencyStatsEnabled)
+                PrintLatency(orderbook);
+        }
+        else
+            return Usage();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+//
+// Gateway.cpp
+//
+// 订单网关进程：在 TCP 上接受二进制或 FIX 4.4 订单录入会话，把订单批量提交到订单簿，并每秒报告统计信息
+//
+// 用法：
+//   OrderbookGateway [port] [address] [binary | fix] [symbol]    默认监听 127.0.0.1:9100，二进制协议
+//
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Orderbook.h"
+#include "OrderGateway.h"
+
+namespace
+{
+    std::atomic<bool> stop{ false };
+
+    void OnSignal(int)
+    {
+        stop.store(true, std::memory_order_release);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 5 || (argc > 3 && std::string{ argv[3] } != "binary" && std::string{ argv[3] } != "fix"))
+    {
+        std::cerr << "Usage: OrderbookGateway [port] [address] [binary | fix] [symbol]" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    OrderGatewayOptions options;
+    options.port_ = static_cast<std::uint16_t>(argc > 1 ? std::stoi(argv[1]) : 9100);
+    if (argc > 2)
+        options.address_ = argv[2];
+    if (argc > 3 && std::string{ argv[3] } == "fix")
+        options.protocol_ = OrderGatewayProtocol::Fix;
+    if (argc > 4)
+        options.symbol_ = argv[4];
+
+    Orderbook orderbook;
+    OrderGateway gateway{ orderbook, options };
+    std::cout << "listening on " << options.address_ << ':' << gateway.GetPort() << std::endl;
+
+    std::thread worker{ [&gateway] { gateway.Run(stop); } };
+
+    OrderGatewayStats previous{ };
+    while (!stop.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        const auto stats = gateway.GetStats();
+        const auto reads = stats.reads_ - previous.reads_;
+        const auto writes = stats.writes_ - previous.writes_;
+        std::cout << "sessions=" << stats.sessions_
+                  << " messages/s=" << stats.messages_ - previous.messages_
+                  << " messagesPerRead=" << (reads > 0 ? static_cast<double>(stats.messages_ - previous.messages_) / reads : 0.0)
+                  << " batches/s=" << stats.batches_ - previous.batches_
+                  << " reportsPerWrite=" << (writes > 0 ? static_cast<double>(stats.reports_ - previous.reports_) / writes : 0.0)
+                  << " protocolErrors=" << stats.protocolErrors_
+                  << " orders=" << orderbook.Size() << std::endl;
+        if (stats.protocolErrors_ > previous.protocolErrors_)
+            std::cout << "lastProtocolError=" << gateway.GetLastProtocolError() << std::endl;
+        previous = stats;
+    }
+
+    worker.join();
+    return 0;
+}
@@ -0,0 +1,161 @@
+//
+// JournalTool.cpp
+//
+// 日志运维工具：查看日志状态、崩溃后截掉不完整的末尾、从任意序号开始导出消息用于回放或审计
+//
+// 用法：
+//   OrderbookJournal info <journal>
+//   OrderbookJournal recover <journal>
+//   OrderbookJournal dump <journal> <sequence> [count]
+//   OrderbookJournal export <journal> <prefix> [rowGroupSize]
+//
+// dump 的每一行为 "<序号> <时间戳> <动作>"，动作部分与 OrderbookTest/TestFiles 中的文本格式一致。
+// export 把整个日志重放进订单簿，将成交和价格级别变化以列式格式写入 <prefix>.trades 和 <prefix>.levels，
+// 事件的时间戳为产生它的日志消息的时间戳。
+//
+
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "ColumnarExport.h"
+#include "Journal.h"
+#include "Orderbook.h"
+
+namespace
+{
+    std::string_view ToString(Side side)
+    {
+        return side == Side::Buy ? "B" : "S";
+    }
+
+    void Print(std::uint64_t sequence, const JournalMessage& message)
+    {
+        std::cout << sequence << ' ' << message.timestamp_ << ' ';
+        switch (message.type_)
+        {
+            case JournalMessageType::Add:
+                std::cout << "A " << ToString(message.side_) << ' ' << ToString(message.orderType_) << ' '
+                          << message.price_ << ' ' << message.quantity_ << ' ' << message.orderId_ << '\n';
+                break;
+            case JournalMessageType::Modify:
+                std::cout << "M " << message.orderId_ << ' ' << ToString(message.side_) << ' '
+                          << message.price_ << ' ' << message.quantity_ << '\n';
+                break;
+            case JournalMessageType::Cancel:
+                std::cout << "C " << message.orderId_ << '\n';
+                break;
+            case JournalMessageType::Prune:
+                std::cout << "P\n";
+                break;
+        }
+    }
+
+    void Print(const JournalRecovery& recovery)
+    {
+        std::cout << "lastSequence=" << recovery.lastSequence_
+                  << " validBytes=" << recovery.validBytes_
+                  << " tornBytes=" << recovery.tornBytes_
+                  << " blocksRead=" << recovery.blocksRead_ << std::endl;
+    }
+
+    std::uint64_t ToNumber(std::string_view str)
+    {
+        std::uint64_t value{ };
+        const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+        if (error != std::errc{ } || end != str.data() + str.size())
+            throw std::invalid_argument("Invalid number: " + std::string{ str });
+        return value;
+    }
+
+    int Usage()
+    {
+        std::cerr << "Usage: OrderbookJournal info <journal>\n"
+                     "       OrderbookJournal recover <journal>\n"
+                     "       OrderbookJournal dump <journal> <sequence> [count]\n"
+                     "       OrderbookJournal export <journal> <prefix> [rowGroupSize]" << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+        return Usage();
+
+    const std::string_view command{ argv[1] };
+    const std::filesystem::path path{ argv[2] };
+
+    try
+    {
+        if (command == "info" && argc == 3)
+        {
+            JournalReader reader{ path };
+            std::cout << "blocks=" << reader.GetIndex().size() << ' ';
+            Print(RecoverJournal(path));
+        }
+        else if (command == "recover" && argc == 3)
+        {
+            Print(TruncateJournal(path));
+        }
+        else if (command == "dump" && (argc == 4 || argc == 5))
+        {
+            const auto sequence = ToNumber(argv[3]);
+            auto remaining = argc == 5 ? ToNumber(argv[4]) : UINT64_MAX;
+
+            JournalReader reader{ path };
+            if (!reader.Seek(sequence))
+            {
+                std::cerr << "Sequence " << sequence << " is not in the journal." << std::endl;
+                return 1;
+            }
+
+            JournalMessages messages;
+            while (remaining > 0 && reader.ReadBlock(messages) > 0)
+            {
+                auto current = reader.GetNextSequence() - messages.size();
+                for (const auto& message : messages)
+                {
+                    if (remaining == 0)
+                        break;
+                    Print(current++, message);
+                    --remaining;
+                }
+            }
+        }
+        else if (command == "export" && (argc == 4 || argc == 5))
+        {
+            const std::string prefix{ argv[3] };
+            ColumnarExporter exporter{ prefix + ".trades", prefix + ".levels", argc == 5 ? ToNumber(argv[4]) : std::size_t{ 1 } << 16 };
+            Orderbook orderbook;
+            orderbook.SetListener(&exporter);
+
+            JournalReader reader{ path };
+            JournalMessages messages;
+            while (reader.ReadBlock(messages) > 0)
+            {
+                for (const auto& message : messages)
+                {
+                    exporter.SetTimestamp(message.timestamp_);
+                    ApplyJournalMessage(orderbook, message);
+                }
+            }
+
+            orderbook.SetListener(nullptr);
+            exporter.Sync();
+            std::cout << "messages=" << reader.GetNextSequence() - 1
+                      << " trades=" << exporter.GetTrades().GetRowCount()
+                      << " levelDeltas=" << exporter.GetLevels().GetRowCount() << std::endl;
+        }
+        else
+            return Usage();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
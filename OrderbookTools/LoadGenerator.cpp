@@ -0,0 +1,201 @@
+//
+// LoadGenerator.cpp
+//
+// 压测客户端：通过一个会话以固定窗口流水线发送订单，统计吞吐量和往返延迟
+//
+// 会话可以是 TCP 网关（OrderbookGateway）的连接，也可以是共享内存服务端（OrderbookShmServer）的客户端槽位，
+// 便于在同一台机器上比较两种传输方式。
+// 每条请求（添加或撤单）都会收到一条受理回报（Accepted / Rejected / Cancelled），
+// 回报按请求顺序返回，因此延迟为请求发出到对应受理回报到达的时间。成交回报单独计数。
+//
+// 用法：
+//   OrderbookLoadGen <port | /shm-name> [messages] [window] [address]    默认 1000000 条消息、窗口 256、127.0.0.1
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "BinaryProtocol.h"
+#include "SharedMemoryOrderClient.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t Percentile(const std::vector<std::uint64_t>& sorted, double percentile)
+    {
+        if (sorted.empty())
+            return 0;
+        return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(percentile * sorted.size()))];
+    }
+
+    int ConnectTcp(const std::string& host, std::uint16_t port)
+    {
+        const int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{ };
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (descriptor < 0 || inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 ||
+            connect(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+            return -1;
+
+        const int noDelay = 1;
+        setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return descriptor;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 5)
+    {
+        std::cerr << "Usage: OrderbookLoadGen <port | /shm-name> [messages] [window] [address]" << std::endl;
+        return 1;
+    }
+
+    const std::string target{ argv[1] };
+    const std::size_t total = argc > 2 ? std::stoull(argv[2]) : 1'000'000;
+    const std::size_t window = argc > 3 ? std::stoull(argv[3]) : 256;
+    const std::string host = argc > 4 ? argv[4] : "127.0.0.1";
+
+    // 以 / 开头的目标是共享内存段名，否则是 TCP 端口
+    int descriptor{ -1 };
+    std::unique_ptr<SharedMemoryOrderClient> channel;
+    if (target.starts_with('/'))
+        channel = std::make_unique<SharedMemoryOrderClient>(target);
+    else if ((descriptor = ConnectTcp(host, static_cast<std::uint16_t>(std::stoi(target)))) < 0)
+    {
+        std::cerr << "Unable to connect to " << host << ':' << target << std::endl;
+        return 1;
+    }
+
+    // 订单 ID 以进程号区分，多个压测客户端可以同时连接同一个服务端
+    const OrderId baseId = static_cast<OrderId>(getpid()) << 32;
+    std::mt19937_64 random{ 42 };
+
+    std::vector<char> output(window * sizeof(AddOrderMessage));
+    std::vector<char> input(1 << 20);
+    std::size_t inputSize{ };
+
+    std::deque<Clock::time_point> inFlight;      // 尚未收到受理回报的请求的发送时间
+    std::vector<std::uint64_t> latencies;        // 往返延迟（纳秒）
+    latencies.reserve(total);
+    std::size_t sent{ }, fills{ }, rejects{ };
+
+    Clock::time_point arrived;
+    const auto onReport = [&](const ExecutionReportMessage& report)
+    {
+        if (report.executionType_ == ExecutionType::Filled)
+        {
+            ++fills;
+            return;
+        }
+        if (report.executionType_ == ExecutionType::Rejected)
+            ++rejects;
+        latencies.push_back(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(arrived - inFlight.front()).count()));
+        inFlight.pop_front();
+    };
+
+    const auto start = Clock::now();
+    while (latencies.size() < total)
+    {
+        // 补满发送窗口
+        std::size_t size{ };
+        const auto now = Clock::now();
+        while (sent < total && inFlight.size() < window)
+        {
+            const OrderId orderId = baseId + sent + 1;
+            const auto offset = size;
+            if (sent % 4 == 3)
+                size += EncodeCancelOrder(output.data() + size, orderId - 2);  // 撤销两条之前的订单（可能已成交，会被拒绝）
+            else
+            {
+                const auto side = random() % 2 == 0 ? Side::Buy : Side::Sell;
+                const auto price = static_cast<Price>(side == Side::Buy ? 95 + random() % 8 : 98 + random() % 8);
+                size += EncodeAddOrder(output.data() + size, orderId, side, OrderType::GoodTillCancel, price, static_cast<Quantity>(1 + random() % 100));
+            }
+            inFlight.push_back(now);
+            ++sent;
+
+            // 共享内存：逐条写入订单队列，窗口不超过队列容量时不会失败
+            if (channel && !channel->Send(output.data() + offset, size - offset))
+            {
+                std::cerr << (channel->IsConnected() ? "Order ring is full; use a smaller window." : "Server closed the channel.") << std::endl;
+                return 1;
+            }
+        }
+
+        if (channel)
+        {
+            // 轮询回报；没有回报时让出 CPU，服务端与客户端共用一个核时也能推进
+            std::size_t received{ };
+            while (true)
+            {
+                arrived = Clock::now();
+                if ((received = channel->PollReports(onReport)) > 0)
+                    break;
+                if (!channel->IsConnected())
+                {
+                    std::cerr << "Server closed the channel." << std::endl;
+                    return 1;
+                }
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        // TCP：一次 write 发出整个窗口，再读取回报
+        for (std::size_t written{ }; written < size;)
+        {
+            const auto result = write(descriptor, output.data() + written, size - written);
+            if (result <= 0)
+            {
+                std::cerr << "Gateway connection failed." << std::endl;
+                return 1;
+            }
+            written += static_cast<std::size_t>(result);
+        }
+
+        const auto received = read(descriptor, input.data() + inputSize, input.size() - inputSize);
+        if (received <= 0)
+        {
+            std::cerr << "Gateway closed the connection." << std::endl;
+            return 1;
+        }
+        inputSize += static_cast<std::size_t>(received);
+
+        arrived = Clock::now();
+        const auto consumed = DecodeExecutionReports(input.data(), inputSize, onReport);
+        std::memmove(input.data(), input.data() + consumed, inputSize - consumed);
+        inputSize -= consumed;
+    }
+    const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (descriptor >= 0)
+        close(descriptor);
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "messages=" << latencies.size()
+              << " seconds=" << seconds
+              << " messages/s=" << static_cast<std::uint64_t>(latencies.size() / seconds)
+              << " fills=" << fills
+              << " rejects=" << rejects << '\n'
+              << "latencyUs p50=" << Percentile(latencies, 0.50) / 1'000.0
+              << " p99=" << Percentile(latencies, 0.99) / 1'000.0
+              << " p99.9=" << Percentile(latencies, 0.999) / 1'000.0
+              << " max=" << Percentile(latencies, 1.0) / 1'000.0 << std::endl;
+    return 0;
+}
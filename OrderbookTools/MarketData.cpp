@@ -0,0 +1,109 @@
+//
+// MarketData.cpp
+//
+// 行情订阅进程：以只读方式映射 OrderbookShmServer 广播的行情段，维护本地的级别并每秒打印一次最佳价格和统计
+//
+// 可以同时运行任意多个订阅进程，写者不知道它们的存在；订阅进程落后超过一圈时从快照重新同步。
+//
+// 用法：
+//   OrderbookMarketData [name]    默认段名 /orderbook-md
+//
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "MarketDataFeed.h"
+
+namespace
+{
+    std::atomic<bool> stop{ false };
+
+    void OnSignal(int)
+    {
+        stop.store(true, std::memory_order_release);
+    }
+
+    // 级别事件携带变化后的完整状态，直接覆盖本地的级别
+    template<typename Levels>
+    void ApplyLevel(Levels& levels, const MarketDataEvent& event)
+    {
+        if (event.count_ == 0)
+            levels.erase(event.price_);
+        else
+            levels[event.price_] = event.quantity_;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2)
+    {
+        std::cerr << "Usage: OrderbookMarketData [name]" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    MarketDataSubscriber subscriber{ argc > 1 ? argv[1] : "/orderbook-md" };
+
+    std::map<Price, Quantity, std::greater<Price>> bids;
+    std::map<Price, Quantity, std::less<Price>> asks;
+    const auto resync = [&]
+    {
+        const auto snapshot = subscriber.Resync();
+        bids.clear();
+        asks.clear();
+        for (const auto& level : snapshot.bids_)
+            bids[level.price_] = level.quantity_;
+        for (const auto& level : snapshot.asks_)
+            asks[level.price_] = level.quantity_;
+    };
+    resync();
+
+    std::uint64_t events{ }, trades{ }, overruns{ };
+    auto report = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    MarketDataEvent event{ };
+    while (!stop.load(std::memory_order_acquire))
+    {
+        const auto result = subscriber.Read(event);
+        if (result == MarketDataReadResult::Overrun)
+        {
+            ++overruns;
+            resync();
+            continue;
+        }
+
+        if (result == MarketDataReadResult::Event)
+        {
+            ++events;
+            if (event.type_ == MarketDataEventType::Trade)
+                ++trades;
+            else if (event.side_ == Side::Buy)
+                ApplyLevel(bids, event);
+            else
+                ApplyLevel(asks, event);
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() >= report)
+        {
+            std::cout << "sequence=" << subscriber.GetNextSequence() - 1
+                      << " events/s=" << events
+                      << " trades/s=" << trades
+                      << " overruns=" << overruns
+                      << " bid=" << (bids.empty() ? 0 : bids.begin()->first) << 'x' << (bids.empty() ? 0 : bids.begin()->second)
+                      << " ask=" << (asks.empty() ? 0 : asks.begin()->first) << 'x' << (asks.empty() ? 0 : asks.begin()->second) << std::endl;
+            events = trades = 0;
+            report += std::chrono::seconds(1);
+        }
+        std::this_thread::yield();
+    }
+    return 0;
+}
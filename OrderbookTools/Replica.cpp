@@ -0,0 +1,73 @@
+//
+// Replica.cpp
+//
+// 热备副本进程：跟随主节点的日志，持续维护一份订单簿镜像并每秒报告滞后情况
+//
+// 用法：
+//   OrderbookReplica <journal>    跟随日志文件（或命名管道）
+//   OrderbookReplica -            跟随标准输入（管道或重定向的 Unix 套接字）
+//
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include "Orderbook.h"
+#include "OrderbookReplica.h"
+
+namespace
+{
+    std::atomic<bool> stop{ false };
+
+    void OnSignal(int)
+    {
+        stop.store(true, std::memory_order_release);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: OrderbookReplica <journal | ->" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    // 当日有效订单只在回放到日志中的清理消息时撤销
+    Orderbook orderbook{ OrderbookMode::Matching, OrderbookPruning::Command };
+    std::unique_ptr<OrderbookReplica> replica;
+    const std::string_view source{ argv[1] };
+#ifndef _WIN32
+    if (source == "-")
+        replica = std::make_unique<OrderbookReplica>(orderbook, 0);
+    else
+#endif
+        replica = std::make_unique<OrderbookReplica>(orderbook, std::filesystem::path{ source });
+
+    std::thread applier{ [&replica] { replica->Run(stop); } };
+
+    while (!stop.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        const auto status = replica->GetStatus();
+        const auto now = JournalTimestamp();
+        const auto lagMicroseconds = status.lastTimestamp_ != 0 && now > status.lastTimestamp_
+            ? (now - status.lastTimestamp_) / 1'000 : 0;
+        std::cout << "applied=" << status.appliedSequence_
+                  << " bytesBehind=" << status.bytesBehind_
+                  << " lastMessageAgeUs=" << lagMicroseconds
+                  << " checksum=" << std::hex << status.checksum_ << std::dec
+                  << " orders=" << orderbook.Size() << std::endl;
+    }
+
+    applier.join();
+    return 0;
+}
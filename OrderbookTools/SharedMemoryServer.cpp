@@ -0,0 +1,74 @@
+//
+// SharedMemoryServer.cpp
+//
+// 共享内存订单录入服务端进程：同机客户端通过 /dev/shm 下的命名段下单，写线程直接轮询各客户端的队列
+// 行情（级别变化和成交）同时广播到名为 <name>-md 的段，可以用 OrderbookMarketData 订阅
+//
+// 用法：
+//   OrderbookShmServer [name] [clients]    默认段名 /orderbook，16 个客户端槽位
+//
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "MarketDataFeed.h"
+#include "Orderbook.h"
+#include "SharedMemoryOrderServer.h"
+
+namespace
+{
+    std::atomic<bool> stop{ false };
+
+    void OnSignal(int)
+    {
+        stop.store(true, std::memory_order_release);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 3)
+    {
+        std::cerr << "Usage: OrderbookShmServer [name] [clients]" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    const std::string name = argc > 1 ? argv[1] : "/orderbook";
+    const auto clients = static_cast<std::uint32_t>(argc > 2 ? std::stoul(argv[2]) : 16);
+
+    Orderbook orderbook;
+    MarketDataPublisher publisher{ name + "-md" };
+    orderbook.SetListener(&publisher);
+    SharedMemoryOrderServer server{ orderbook, name, clients };
+    std::cout << "serving " << name << " with " << clients << " client slots, market data on " << name << "-md" << std::endl;
+
+    std::thread writer{ [&server] { server.Run(stop); } };
+
+    SharedMemoryServerStats previous{ };
+    while (!stop.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        const auto stats = server.GetStats();
+        const auto batches = stats.batches_ - previous.batches_;
+        std::cout << "clients=" << stats.clients_
+                  << " messages/s=" << stats.messages_ - previous.messages_
+                  << " messagesPerBatch=" << (batches > 0 ? static_cast<double>(stats.messages_ - previous.messages_) / batches : 0.0)
+                  << " reports/s=" << stats.reports_ - previous.reports_
+                  << " backlog=" << stats.backlog_
+                  << " orders=" << orderbook.Size()
+                  << " marketData=" << publisher.GetSequence() << std::endl;
+        previous = stats;
+    }
+
+    writer.join();
+    orderbook.SetListener(nullptr);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "SharedMemoryChannel.h"
+
+#ifndef _WIN32
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SharedMemorySegment SharedMemorySegment::Create(const std::string& name, std::size_t size)
+{
+    shm_unlink(name.c_str());
+    const int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0)
+        throw std::runtime_error("Unable to create shared memory segment.");
+
+    if (ftruncate(descriptor, static_cast<off_t>(size)) < 0)
+    {
+        close(descriptor);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Unable to size shared memory segment.");
+    }
+
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Unable to map shared memory segment.");
+    }
+
+    return SharedMemorySegment{ name, address, size, true };
+}
+
+SharedMemorySegment SharedMemorySegment::Open(const std::string& name, bool readOnly)
+{
+    const int descriptor = shm_open(name.c_str(), readOnly ? O_RDONLY : O_RDWR, 0);
+    if (descriptor < 0)
+        throw std::runtime_error("Unable to open shared memory segment.");
+
+    struct stat status{ };
+    if (fstat(descriptor, &status) < 0 || status.st_size <= 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("Shared memory segment is empty.");
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+    void* address = mmap(nullptr, size, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED)
+        throw std::runtime_error("Unable to map shared memory segment.");
+
+    return SharedMemorySegment{ name, address, size, false };
+}
+
+SharedMemorySegment::SharedMemorySegment(std::string name, void* address, std::size_t size, bool owner)
+    : name_{ std::move(name) }
+    , address_{ address }
+    , size_{ size }
+    , owner_{ owner }
+{ }
+
+SharedMemorySegment::SharedMemorySegment(SharedMemorySegment&& other) noexcept
+    : name_{ std::move(other.name_) }
+    , address_{ std::exchange(other.address_, nullptr) }
+    , size_{ std::exchange(other.size_, 0) }
+    , owner_{ std::exchange(other.owner_, false) }
+{ }
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+    if (address_ != nullptr)
+        munmap(address_, size_);
+    if (owner_)
+        shm_unlink(name_.c_str());
+}
+
+#endif
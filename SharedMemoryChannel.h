@@ -0,0 +1,185 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 共享内存通道的布局常量
+//
+// 段的开头是 SharedMemoryHeader，之后是 clientCapacity_ 个 SharedMemoryClientSlot。
+// 每个客户端槽位包含两个单生产者单消费者环形队列：orders_ 由客户端写、服务端读，reports_ 方向相反。
+// 每个队列槽位存放一条完整的二进制消息（见 BinaryProtocol.h），消息长度取自消息头。
+struct SharedMemoryFormat
+{
+    static constexpr std::uint32_t Magic = 0x4D53424F;        // "OBSM"
+    static constexpr std::uint32_t Version = 3;
+    static constexpr std::size_t CacheLineSize = 64;
+    static constexpr std::size_t SlotSize = 32;               // 能容纳任意一种订单消息或执行回报
+    static constexpr std::size_t RingCapacity = 4'096;        // 每个队列的槽位数，必须是 2 的幂
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory rings need lock-free 64-bit atomics.");
+static_assert((SharedMemoryFormat::RingCapacity & (SharedMemoryFormat::RingCapacity - 1)) == 0);
+
+struct SharedMemorySlot
+{
+    char data_[SharedMemoryFormat::SlotSize];
+};
+
+// 共享内存中的环形队列：只包含两个下标和槽位，各进程缓存的对方下标保存在本地的端点对象中
+struct SharedMemoryRing
+{
+    alignas(SharedMemoryFormat::CacheLineSize) std::atomic<std::uint64_t> head_;   // 消费者下标
+    alignas(SharedMemoryFormat::CacheLineSize) std::atomic<std::uint64_t> tail_;   // 生产者下标
+    alignas(SharedMemoryFormat::CacheLineSize) SharedMemorySlot slots_[SharedMemoryFormat::RingCapacity];
+};
+
+// 客户端槽位的状态
+enum class SharedMemoryClientState : std::uint32_t
+{
+    Free,       // 空闲，可以被客户端占用
+    Claimed,    // 客户端正在初始化
+    Connected,  // 客户端已连接
+    Closed,     // 客户端已断开，等待服务端回收
+    Rejected,   // 服务端因协议错误断开了客户端，客户端标记为 Closed 后才回收，以免仍在运行的客户端写入下一个客户端的队列
+};
+
+// 槽位的所有者：低 32 位是 SharedMemoryClientState，高 32 位是客户端进程号（空闲时为 0）
+//
+// 状态和进程号放在同一个原子变量中，客户端占用槽位的 CAS 同时写入进程号：
+// 客户端在占用之后、连接之前崩溃时，服务端同样可以按进程号发现并回收槽位。
+struct SharedMemoryClientOwner
+{
+    SharedMemoryClientState state_;
+    std::int32_t pid_;
+
+    static constexpr std::uint64_t Pack(SharedMemoryClientState state, std::int32_t pid)
+    {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(pid)) << 32 | static_cast<std::uint32_t>(state);
+    }
+    static constexpr SharedMemoryClientOwner Unpack(std::uint64_t owner)
+    {
+        return { static_cast<SharedMemoryClientState>(owner & 0xFFFFFFFF), static_cast<std::int32_t>(owner >> 32) };
+    }
+};
+
+struct SharedMemoryClientSlot
+{
+    alignas(SharedMemoryFormat::CacheLineSize) std::atomic<std::uint64_t> owner_;   // 见 SharedMemoryClientOwner
+    std::atomic<std::uint32_t> generation_;   // 服务端每次回收槽位时递增，用于区分先后占用同一槽位的客户端
+    SharedMemoryRing orders_;                 // 客户端 -> 服务端：订单消息
+    SharedMemoryRing reports_;                // 服务端 -> 客户端：执行回报
+};
+
+struct SharedMemoryHeader
+{
+    std::uint32_t magic_;
+    std::uint32_t version_;
+    std::uint32_t clientCapacity_;
+    std::atomic<std::uint32_t> ready_;        // 服务端初始化完成后置为 1
+};
+
+// 客户端槽位区在段中的偏移（头部向上对齐到槽位的对齐要求）
+constexpr std::size_t SharedMemorySlotsOffset =
+    (sizeof(SharedMemoryHeader) + alignof(SharedMemoryClientSlot) - 1) / alignof(SharedMemoryClientSlot) * alignof(SharedMemoryClientSlot);
+
+// 段中第 index 个客户端槽位
+inline SharedMemoryClientSlot& GetSharedMemoryClientSlot(void* segment, std::size_t index)
+{
+    return reinterpret_cast<SharedMemoryClientSlot*>(static_cast<char*>(segment) + SharedMemorySlotsOffset)[index];
+}
+
+// 容纳 clientCapacity 个客户端所需的段大小
+constexpr std::size_t GetSharedMemorySegmentSize(std::size_t clientCapacity)
+{
+    return SharedMemorySlotsOffset + clientCapacity * sizeof(SharedMemoryClientSlot);
+}
+
+// 环形队列的生产者端
+class SharedMemoryProducer
+{
+public:
+    SharedMemoryProducer() = default;
+    explicit SharedMemoryProducer(SharedMemoryRing& ring)
+        : ring_{ &ring }
+        , cachedHead_{ ring.head_.load(std::memory_order_acquire) }
+    { }
+
+    // 写入一条消息并立即发布，队列已满时返回 false
+    bool TryPush(const char* message, std::size_t size)
+    {
+        const auto tail = ring_->tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ >= SharedMemoryFormat::RingCapacity)
+        {
+            cachedHead_ = ring_->head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ >= SharedMemoryFormat::RingCapacity)
+                return false;
+        }
+
+        std::memcpy(ring_->slots_[tail & (SharedMemoryFormat::RingCapacity - 1)].data_, message, size);
+        ring_->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    SharedMemoryRing* ring_{ };
+    std::uint64_t cachedHead_{ };
+};
+
+// 环形队列的消费者端
+class SharedMemoryConsumer
+{
+public:
+    SharedMemoryConsumer() = default;
+    explicit SharedMemoryConsumer(SharedMemoryRing& ring)
+        : ring_{ &ring }
+    { }
+
+    // 依次把当前所有已发布的槽位交给 onSlot（就地读取，不拷贝），最后一次性释放这些槽位，返回处理的条数
+    template<typename OnSlot>
+    std::size_t PopAll(OnSlot&& onSlot)
+    {
+        const auto head = ring_->head_.load(std::memory_order_relaxed);
+        const auto tail = ring_->tail_.load(std::memory_order_acquire);
+        for (auto index = head; index != tail; ++index)
+            onSlot(ring_->slots_[index & (SharedMemoryFormat::RingCapacity - 1)].data_);
+
+        if (tail != head)
+            ring_->head_.store(tail, std::memory_order_release);
+        return static_cast<std::size_t>(tail - head);
+    }
+
+private:
+    SharedMemoryRing* ring_{ };
+};
+
+// POSIX 共享内存段（/dev/shm 下的命名对象）的映射
+class SharedMemorySegment
+{
+public:
+    // 创建新的段（同名的旧段会被替换），创建者析构时删除该名称
+    static SharedMemorySegment Create(const std::string& name, std::size_t size);
+    // 打开已存在的段；只读打开时映射也是只读的，打开者不会写入段中的任何位置
+    static SharedMemorySegment Open(const std::string& name, bool readOnly = false);
+
+    SharedMemorySegment(SharedMemorySegment&& other) noexcept;
+    SharedMemorySegment(const SharedMemorySegment&) = delete;
+    void operator=(const SharedMemorySegment&) = delete;
+    ~SharedMemorySegment();
+
+    void* GetAddress() const { return address_; }
+    std::size_t GetSize() const { return size_; }
+
+private:
+    SharedMemorySegment(std::string name, void* address, std::size_t size, bool owner);
+
+    std::string name_;
+    void* address_{ };
+    std::size_t size_{ };
+    bool owner_{ false };
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "SharedMemoryOrderClient.h"
+
+#ifndef _WIN32
+
+#include <stdexcept>
+
+#include <unistd.h>
+
+SharedMemoryOrderClient::SharedMemoryOrderClient(const std::string& name)
+    : segment_{ SharedMemorySegment::Open(name) }
+    , pid_{ static_cast<std::int32_t>(getpid()) }
+{
+    const auto& header = *static_cast<const SharedMemoryHeader*>(segment_.GetAddress());
+    if (header.magic_ != SharedMemoryFormat::Magic || header.version_ != SharedMemoryFormat::Version ||
+        header.ready_.load(std::memory_order_acquire) != 1 ||
+        segment_.GetSize() < GetSharedMemorySegmentSize(header.clientCapacity_))
+        throw std::runtime_error("Shared memory segment is not an order channel.");
+
+    // 占用第一个空闲槽位：同一次 CAS 标记为初始化中并写入进程号，初始化队列端点后再标记为已连接
+    for (std::uint32_t index = 0; index < header.clientCapacity_ && slot_ == nullptr; ++index)
+    {
+        auto& slot = GetSharedMemoryClientSlot(segment_.GetAddress(), index);
+        auto expected = SharedMemoryClientOwner::Pack(SharedMemoryClientState::Free, 0);
+        if (slot.owner_.compare_exchange_strong(expected, SharedMemoryClientOwner::Pack(SharedMemoryClientState::Claimed, pid_), std::memory_order_acquire))
+            slot_ = &slot;
+    }
+    if (slot_ == nullptr)
+        throw std::runtime_error("Order channel has no free client slot.");
+
+    orders_ = SharedMemoryProducer{ slot_->orders_ };
+    reports_ = SharedMemoryConsumer{ slot_->reports_ };
+    slot_->owner_.store(SharedMemoryClientOwner::Pack(SharedMemoryClientState::Connected, pid_), std::memory_order_release);
+}
+
+SharedMemoryOrderClient::~SharedMemoryOrderClient()
+{
+    // 服务端可能已经因协议错误断开了客户端（Rejected），此时槽位仍属于本客户端，同样标记为 Closed 交给服务端回收
+    auto expected = SharedMemoryClientOwner::Pack(SharedMemoryClientState::Connected, pid_);
+    if (!slot_->owner_.compare_exchange_strong(expected, SharedMemoryClientOwner::Pack(SharedMemoryClientState::Closed, pid_), std::memory_order_release) &&
+        expected == SharedMemoryClientOwner::Pack(SharedMemoryClientState::Rejected, pid_))
+        slot_->owner_.store(SharedMemoryClientOwner::Pack(SharedMemoryClientState::Closed, pid_), std::memory_order_release);
+}
+
+bool SharedMemoryOrderClient::AddOrder(OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity)
+{
+    char message[SharedMemoryFormat::SlotSize];
+    return Push(message, EncodeAddOrder(message, orderId, side, orderType, price, quantity));
+}
+
+bool SharedMemoryOrderClient::MarketOrder(OrderId orderId, Side side, Quantity quantity)
+{
+    char message[SharedMemoryFormat::SlotSize];
+    return Push(message, EncodeMarketOrder(message, orderId, side, quantity));
+}
+
+bool SharedMemoryOrderClient::CancelOrder(OrderId orderId)
+{
+    char message[SharedMemoryFormat::SlotSize];
+    return Push(message, EncodeCancelOrder(message, orderId));
+}
+
+bool SharedMemoryOrderClient::ModifyOrder(OrderId orderId, Side side, Price price, Quantity quantity)
+{
+    char message[SharedMemoryFormat::SlotSize];
+    return Push(message, EncodeModifyOrder(message, orderId, side, price, quantity));
+}
+
+bool SharedMemoryOrderClient::Send(const char* message, std::size_t size)
+{
+    if (size > SharedMemoryFormat::SlotSize)
+        throw std::logic_error("Message does not fit in a shared memory slot.");
+    return Push(message, size);
+}
+
+bool SharedMemoryOrderClient::IsConnected() const
+{
+    return SharedMemoryClientOwner::Unpack(slot_->owner_.load(std::memory_order_acquire)).state_ == SharedMemoryClientState::Connected;
+}
+
+// 服务端断开客户端后不会回收槽位，直到客户端标记为 Closed，因此检查状态之后写入队列不会影响其他客户端
+bool SharedMemoryOrderClient::Push(const char* message, std::size_t size)
+{
+    return IsConnected() && orders_.TryPush(message, size);
+}
+
+#endif
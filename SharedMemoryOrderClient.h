@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <string>
+
+#include "SharedMemoryChannel.h"   // 包含共享内存段布局与环形队列
+#include "BinaryProtocol.h"        // 包含二进制订单录入协议与执行回报
+
+// 共享内存订单录入客户端
+//
+// 连接时在服务端创建的段中占用一个空闲的客户端槽位，之后的下单和回报读取都只是读写共享内存，没有系统调用。
+// 下单函数在订单队列已满或已被服务端断开时返回 false，由调用方决定重试或放弃；析构时断开连接，槽位由服务端回收。
+class SharedMemoryOrderClient
+{
+public:
+    // 连接到名为 name 的服务端段，没有空闲槽位时抛出异常
+    explicit SharedMemoryOrderClient(const std::string& name);
+    SharedMemoryOrderClient(const SharedMemoryOrderClient&) = delete;
+    void operator=(const SharedMemoryOrderClient&) = delete;
+    ~SharedMemoryOrderClient();
+
+    bool AddOrder(OrderId orderId, Side side, OrderType orderType, Price price, Quantity quantity);
+    bool MarketOrder(OrderId orderId, Side side, Quantity quantity);
+    bool CancelOrder(OrderId orderId);
+    bool ModifyOrder(OrderId orderId, Side side, Price price, Quantity quantity);
+    // 发送一条已编码的二进制消息，长度不能超过一个槽位
+    bool Send(const char* message, std::size_t size);
+    // 服务端是否仍接受该客户端的订单；因协议错误被断开后返回 false，之后的下单都会失败
+    bool IsConnected() const;
+
+    // 把所有已到达的执行回报交给 onReport，返回回报条数
+    template<typename OnReport>
+    std::size_t PollReports(OnReport&& onReport)
+    {
+        return reports_.PopAll([&onReport](const char* slot)
+        {
+            DecodeExecutionReports(slot, sizeof(ExecutionReportMessage), onReport);
+        });
+    }
+
+private:
+    bool Push(const char* message, std::size_t size);
+
+    SharedMemorySegment segment_;
+    SharedMemoryClientSlot* slot_{ };
+    std::int32_t pid_;                        // 本进程号，与状态一起写入槽位的所有者
+    SharedMemoryProducer orders_;
+    SharedMemoryConsumer reports_;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "SharedMemoryOrderServer.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <signal.h>
+
+namespace
+{
+    constexpr std::uint64_t LivenessInterval = 4'096;   // 每隔多少轮检查一次客户端进程是否还存在
+}
+
+SharedMemoryOrderServer::SharedMemoryOrderServer(Orderbook& orderbook, const std::string& name, std::uint32_t clientCapacity)
+    : segment_{ SharedMemorySegment::Create(name, GetSharedMemorySegmentSize(clientCapacity)) }
+    , router_{ orderbook }
+    , clients_(clientCapacity)
+{
+    // 在新建（已清零）的段上构造共享对象，最后才发布 ready_
+    auto* header = new (segment_.GetAddress()) SharedMemoryHeader{ SharedMemoryFormat::Magic, SharedMemoryFormat::Version, clientCapacity, 0 };
+    for (std::uint32_t index = 0; index < clientCapacity; ++index)
+        new (&GetSharedMemoryClientSlot(segment_.GetAddress(), index)) SharedMemoryClientSlot{ };
+    header->ready_.store(1, std::memory_order_release);
+}
+
+std::size_t SharedMemoryOrderServer::Poll()
+{
+    const auto firstMessage = router_.GetMessageCount();
+    UpdateClients(++polls_ % LivenessInterval == 0);
+
+    // 读取所有客户端的订单，合成一批
+    for (std::size_t index = 0; index < clients_.size(); ++index)
+    {
+        auto& client = clients_[index];
+        if (!client.connected_)
+            continue;
+
+        FlushBacklog(client);
+        DrainOrders(index);
+    }
+
+    const auto received = router_.GetMessageCount() - firstMessage;
+    messages_.store(router_.GetMessageCount(), std::memory_order_relaxed);
+
+    if (router_.Execute() > 0)
+        batches_.fetch_add(1, std::memory_order_relaxed);
+
+    // 回报写入所属客户端的回报队列，会话已经不存在的回报被丢弃
+    for (const auto& report : router_.GetReports())
+    {
+        auto& client = clients_[report.sessionId_ & 0xFFFFFFFF];
+        if (client.connected_ && client.sessionId_ == report.sessionId_)
+            Deliver(client, report.report_);
+    }
+    router_.ClearReports();
+
+    return received;
+}
+
+void SharedMemoryOrderServer::Run(const std::atomic<bool>& stop)
+{
+    // 有消息时连续处理；空闲时先让出 CPU，长时间空闲再短暂休眠
+    std::size_t idle{ };
+    while (!stop.load(std::memory_order_acquire))
+    {
+        if (Poll() > 0)
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < 1'000)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+SharedMemoryServerStats SharedMemoryOrderServer::GetStats() const
+{
+    return SharedMemoryServerStats{
+        clientCount_.load(std::memory_order_relaxed),
+        messages_.load(std::memory_order_relaxed),
+        batches_.load(std::memory_order_relaxed),
+        reports_.load(std::memory_order_relaxed),
+        backlog_.load(std::memory_order_relaxed) };
+}
+
+// 接入新连接的客户端，回收已断开的客户端
+void SharedMemoryOrderServer::UpdateClients(bool checkLiveness)
+{
+    for (std::size_t index = 0; index < clients_.size(); ++index)
+    {
+        auto& slot = GetSharedMemoryClientSlot(segment_.GetAddress(), index);
+        auto& client = clients_[index];
+        const auto [state, pid] = SharedMemoryClientOwner::Unpack(slot.owner_.load(std::memory_order_acquire));
+
+        if (!client.connected_ && state == SharedMemoryClientState::Connected)
+        {
+            client.connected_ = true;
+            client.sessionId_ = static_cast<std::uint64_t>(slot.generation_.load(std::memory_order_relaxed)) << 32 | index;
+            client.orders_ = SharedMemoryConsumer{ slot.orders_ };
+            client.reports_ = SharedMemoryProducer{ slot.reports_ };
+            clientCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (client.connected_ && state == SharedMemoryClientState::Closed)
+        {
+            // 客户端断开前写入的订单仍然有效，先读出再回收（读出时遇到协议错误则已经回收）
+            DrainOrders(index);
+            if (client.connected_)
+                Release(index);
+        }
+        else if (client.rejected_ && state == SharedMemoryClientState::Closed)
+        {
+            Release(index);
+        }
+        else if ((client.connected_ || client.rejected_ || state == SharedMemoryClientState::Claimed) && checkLiveness)
+        {
+            // 已经崩溃的客户端，包括占用槽位之后、连接之前崩溃的客户端
+            if (pid > 0 && kill(pid, 0) < 0 && errno == ESRCH)
+                Release(index);
+        }
+    }
+}
+
+// 读出客户端订单队列中的所有消息并加入当前批次
+void SharedMemoryOrderServer::DrainOrders(std::size_t index)
+{
+    auto& client = clients_[index];
+    if (!client.connected_)
+        return;
+
+    try
+    {
+        client.orders_.PopAll([this, &client](const char* slot)
+        {
+            std::uint16_t length;
+            std::memcpy(&length, slot, sizeof(length));
+            if (length > SharedMemoryFormat::SlotSize)
+                throw std::runtime_error("Malformed shared memory message.");
+            const auto result = router_.Decode(client.sessionId_, slot, length);
+            if (result.error_ != nullptr || result.consumed_ != length)
+                throw std::runtime_error("Malformed shared memory message.");
+        });
+    }
+    catch (const std::runtime_error&)
+    {
+        Reject(index);  // 协议错误：断开该客户端
+    }
+}
+
+// 因协议错误断开客户端：不再读取其队列，但客户端可能仍在写入，等它标记为 Closed（或进程退出）后才回收槽位
+void SharedMemoryOrderServer::Reject(std::size_t index)
+{
+    auto& slot = GetSharedMemoryClientSlot(segment_.GetAddress(), index);
+    auto expected = slot.owner_.load(std::memory_order_acquire);
+    const auto pid = SharedMemoryClientOwner::Unpack(expected).pid_;
+    if (SharedMemoryClientOwner::Unpack(expected).state_ != SharedMemoryClientState::Connected ||
+        !slot.owner_.compare_exchange_strong(expected, SharedMemoryClientOwner::Pack(SharedMemoryClientState::Rejected, pid), std::memory_order_acq_rel))
+    {
+        Release(index);  // 客户端已经断开，可以立即回收
+        return;
+    }
+
+    auto& client = clients_[index];
+    clientCount_.fetch_sub(1, std::memory_order_relaxed);
+    backlog_.fetch_sub(client.backlog_.size(), std::memory_order_relaxed);
+    client = Client{ };
+    client.rejected_ = true;
+}
+
+// 回收槽位：清空两个队列并递增代数后才重新标记为空闲；只在客户端已经不会再访问槽位时调用
+void SharedMemoryOrderServer::Release(std::size_t index)
+{
+    auto& slot = GetSharedMemoryClientSlot(segment_.GetAddress(), index);
+    auto& client = clients_[index];
+    if (client.connected_)
+        clientCount_.fetch_sub(1, std::memory_order_relaxed);
+
+    backlog_.fetch_sub(client.backlog_.size(), std::memory_order_relaxed);
+    client = Client{ };
+
+    slot.orders_.head_.store(0, std::memory_order_relaxed);
+    slot.orders_.tail_.store(0, std::memory_order_relaxed);
+    slot.reports_.head_.store(0, std::memory_order_relaxed);
+    slot.reports_.tail_.store(0, std::memory_order_relaxed);
+    slot.generation_.fetch_add(1, std::memory_order_relaxed);
+    slot.owner_.store(SharedMemoryClientOwner::Pack(SharedMemoryClientState::Free, 0), std::memory_order_release);
+}
+
+void SharedMemoryOrderServer::Deliver(Client& client, const ExecutionReportMessage& report)
+{
+    // 必须先发送暂存的回报以保持顺序
+    if (client.backlog_.empty() && client.reports_.TryPush(reinterpret_cast<const char*>(&report), sizeof(report)))
+    {
+        reports_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    client.backlog_.push_back(report);
+    backlog_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedMemoryOrderServer::FlushBacklog(Client& client)
+{
+    while (!client.backlog_.empty() && client.reports_.TryPush(reinterpret_cast<const char*>(&client.backlog_.front()), sizeof(ExecutionReportMessage)))
+    {
+        client.backlog_.pop_front();
+        backlog_.fetch_sub(1, std::memory_order_relaxed);
+        reports_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#endif
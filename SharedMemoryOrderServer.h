@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "SharedMemoryChannel.h"   // 包含共享内存段布局与环形队列
+#include "OrderSessionRouter.h"    // 包含会话订单路由
+
+// 共享内存通道服务端的统计信息
+struct SharedMemoryServerStats
+{
+    std::uint64_t clients_;      // 当前连接的客户端数
+    std::uint64_t messages_;     // 收到的订单消息数
+    std::uint64_t batches_;      // 提交给订单簿的批次数
+    std::uint64_t reports_;      // 发出的执行回报数
+    std::uint64_t backlog_;      // 因回报队列已满而暂存在服务端的回报数
+};
+
+// 共享内存订单录入服务端
+//
+// 创建 /dev/shm 下的命名段，为每个客户端提供一对环形队列（订单入、回报出）。
+// 订单簿的写线程直接调用 Poll 轮询所有已连接客户端的订单队列，不经过任何系统调用：
+// 一轮中所有客户端的消息合成一批提交给订单簿，回报直接写入各客户端的回报队列。
+// 回报队列已满时回报暂存在服务端，下一轮优先发送，写线程从不阻塞在慢客户端上。
+// 客户端断开（或进程退出）后服务端回收其槽位，该客户端的挂单保留在订单簿中。
+class SharedMemoryOrderServer
+{
+public:
+    SharedMemoryOrderServer(Orderbook& orderbook, const std::string& name, std::uint32_t clientCapacity = 16);
+    SharedMemoryOrderServer(const SharedMemoryOrderServer&) = delete;
+    void operator=(const SharedMemoryOrderServer&) = delete;
+
+    // 处理一轮所有客户端的订单，返回处理的订单消息数；不会阻塞
+    std::size_t Poll();
+    // 持续轮询，直到 stop 被置为 true
+    void Run(const std::atomic<bool>& stop);
+
+    // 获取统计信息，可以在其他线程调用
+    SharedMemoryServerStats GetStats() const;
+
+private:
+    // 服务端本地的客户端状态
+    struct Client
+    {
+        bool connected_{ false };
+        bool rejected_{ false };                        // 因协议错误断开，等待客户端标记为 Closed
+        std::uint64_t sessionId_{ };                    // 槽位下标 | 代数 << 32
+        SharedMemoryConsumer orders_;
+        SharedMemoryProducer reports_;
+        std::deque<ExecutionReportMessage> backlog_;    // 尚未放入回报队列的回报
+    };
+
+    void UpdateClients(bool checkLiveness);
+    void DrainOrders(std::size_t index);
+    void Reject(std::size_t index);
+    void Release(std::size_t index);
+    void Deliver(Client& client, const ExecutionReportMessage& report);
+    void FlushBacklog(Client& client);
+
+    SharedMemorySegment segment_;
+    OrderSessionRouter router_;
+    std::vector<Client> clients_;
+    std::uint64_t polls_{ };
+
+    std::atomic<std::uint64_t> clientCount_{ };
+    std::atomic<std::uint64_t> messages_{ };
+    std::atomic<std::uint64_t> batches_{ };
+    std::atomic<std::uint64_t> reports_{ };
+    std::atomic<std::uint64_t> backlog_{ };
+};
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// 单生产者单消费者无锁环形队列
+//
+// 生产者和消费者各自只写自己的下标，并缓存对方的下标以减少跨核读取；
+// 两个下标放在不同的缓存行上，避免伪共享。容量会向上取整为 2 的幂。
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    void operator=(const SpscQueue&) = delete;
+
+    // 生产者调用：队列已满时返回 false
+    bool TryPush(const T& value)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_)
+        {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_)
+                return false;
+        }
+
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：队列为空时返回 false
+    bool TryPop(T& value)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_)
+        {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_)
+                return false;
+        }
+
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列中的元素个数（仅为近似值，适用于统计）
+    std::size_t Size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t Capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr std::size_t CacheLineSize = 64;
+
+    std::vector<T> slots_;
+    std::size_t mask_{ };
+
+    alignas(CacheLineSize) std::atomic<std::size_t> head_{ };  // 消费者下标
+    std::size_t cachedTail_{ };                                // 消费者缓存的生产者下标
+    alignas(CacheLineSize) std::atomic<std::size_t> tail_{ };  // 生产者下标
+    std::size_t cachedHead_{ };                                // 生产者缓存的消费者下标
+};
@@ -0,0 +1,46 @@
+#include "TradeTape.h"
+
+#include <fstream>
+
+#include "Journal.h" // 包含定长整数的编码函数
+
+TradeTapeWriter::TradeTapeWriter(const std::filesystem::path& path, AsyncFileWriterOptions options)
+    : file_{ path, options }
+{ }
+
+void TradeTapeWriter::Append(const Trades& trades, std::uint64_t timestamp)
+{
+    // 每条记录单独写入，保证记录不会跨越两个缓冲区
+    for (const auto& trade : trades)
+    {
+        char record[RecordSize];
+        PutFixed(record + 0, trade.GetBidTrade().orderId_);
+        PutFixed(record + 8, trade.GetAskTrade().orderId_);
+        PutFixed(record + 16, trade.GetBidTrade().price_);
+        PutFixed(record + 20, trade.GetAskTrade().price_);
+        PutFixed(record + 24, trade.GetBidTrade().quantity_);
+        PutFixed(record + 28, timestamp);
+        file_.Write(record, RecordSize);
+    }
+}
+
+TradeTapeRecords ReadTradeTape(const std::filesystem::path& path)
+{
+    TradeTapeRecords records;
+
+    std::ifstream file{ path, std::ios::binary };
+    char record[TradeTapeWriter::RecordSize];
+    while (file.read(record, sizeof(record)))
+    {
+        TradeTapeRecord value{ };
+        value.bidOrderId_ = GetFixed<OrderId>(record + 0);
+        value.askOrderId_ = GetFixed<OrderId>(record + 8);
+        value.bidPrice_ = GetFixed<Price>(record + 16);
+        value.askPrice_ = GetFixed<Price>(record + 20);
+        value.quantity_ = GetFixed<Quantity>(record + 24);
+        value.timestamp_ = GetFixed<std::uint64_t>(record + 28);
+        records.push_back(value);
+    }
+
+    return records;
+}
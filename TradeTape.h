@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "Trade.h"            // 包含 Trade / Trades 的定义
+#include "AsyncFileWriter.h"  // 包含异步文件写入器
+
+// 成交记录磁带中的一条定长记录
+struct TradeTapeRecord
+{
+    OrderId bidOrderId_;        // 买单 ID
+    OrderId askOrderId_;        // 卖单 ID
+    Price bidPrice_;            // 买单价格
+    Price askPrice_;            // 卖单价格
+    Quantity quantity_;         // 成交数量
+    std::uint64_t timestamp_;   // 成交时间戳（纳秒）
+};
+
+using TradeTapeRecords = std::vector<TradeTapeRecord>;
+
+// 成交记录磁带写入器：把每笔成交编码为定长小端记录，通过 AsyncFileWriter 异步写入
+class TradeTapeWriter
+{
+public:
+    static constexpr std::size_t RecordSize = 8 + 8 + 4 + 4 + 4 + 8;
+
+    explicit TradeTapeWriter(const std::filesystem::path& path, AsyncFileWriterOptions options = { });
+
+    // 追加一批成交，使用同一个时间戳
+    void Append(const Trades& trades, std::uint64_t timestamp);
+    // 把已编码的数据交给 I/O 线程，不等待写入完成
+    void Flush() { file_.Flush(); }
+    // 等待所有数据写入完成
+    void Sync() { file_.Sync(); }
+
+private:
+    AsyncFileWriter file_;
+};
+
+// 读取整个成交记录磁带（用于审计和测试）
+TradeTapeRecords ReadTradeTape(const std::filesystem::path& path);